@@ -1,16 +1,39 @@
 #!/bin/bash
 
 # Script to compare Sequential, OpenMP, and MPI implementations
-# Usage: ./compare_all.sh <graph_file> [source_node] [openmp_threads] [mpi_processes]
+# Usage: ./compare_all.sh <graph_file> [source_node] [openmp_threads] [mpi_processes|RANKSxTHREADS]
+# A "2x4" style MPI configuration runs the hybrid MPI+OpenMP build with 2 ranks of 4 threads each.
+# Every run prints a one-line summary (reachable nodes, max distance, checksum) instead of all
+# distances, and correctness is checked by comparing the summaries.
 
 GRAPH_FILE=$1
 SOURCE_NODE=${2:-0}
 OMP_THREADS=${3:-4}
-MPI_PROCS=${4:-4}
+MPI_CONFIG=${4:-4}
 
 if [ -z "$GRAPH_FILE" ]; then
-    echo "Usage: $0 <graph_file> [source_node] [openmp_threads] [mpi_processes]"
+    echo "Usage: $0 <graph_file> [source_node] [openmp_threads] [mpi_processes|RANKSxTHREADS]"
     echo "Example: $0 test_graph_small.txt 0 4 4"
+    echo "Example: $0 test_graph_small.txt 0 4 2x4"
+    exit 1
+fi
+
+if [[ "$MPI_CONFIG" =~ ^([0-9]+)x([0-9]+)$ ]]; then
+    MPI_PROCS=${BASH_REMATCH[1]}
+    MPI_THREADS=${BASH_REMATCH[2]}
+    MPI_BINARY="../build/dijkstra_mpi_hybrid"
+    MPI_ARGS="--threads $MPI_THREADS"
+    MPI_LABEL="$MPI_PROCS processes x $MPI_THREADS threads"
+    MPI_MAKE="make hybrid"
+elif [[ "$MPI_CONFIG" =~ ^[0-9]+$ ]]; then
+    MPI_PROCS=$MPI_CONFIG
+    MPI_THREADS=1
+    MPI_BINARY="../build/dijkstra_mpi"
+    MPI_ARGS=""
+    MPI_LABEL="$MPI_PROCS processes"
+    MPI_MAKE="make mpi"
+else
+    echo "Error: MPI configuration must be a process count or RANKSxTHREADS (e.g. 2x4)"
     exit 1
 fi
 
@@ -25,7 +48,7 @@ echo "=========================================="
 echo "Graph file: $GRAPH_FILE"
 echo "Source node: $SOURCE_NODE"
 echo "OpenMP threads: $OMP_THREADS"
-echo "MPI processes: $MPI_PROCS"
+echo "MPI configuration: $MPI_LABEL"
 echo ""
 
 # Get graph info
@@ -38,11 +61,11 @@ fi
 # Sequential
 echo "1. Sequential Dijkstra:"
 if [ -f "../build/dijkstra_sequential" ]; then
-    ../build/dijkstra_sequential "$GRAPH_FILE" "$SOURCE_NODE" > seq_temp.out 2>&1
+    ../build/dijkstra_sequential --format summary "$GRAPH_FILE" "$SOURCE_NODE" > seq_temp.out 2>&1
     TIME_SEQ=$(grep "execution time" seq_temp.out | grep -oE "[0-9]+\.[0-9]+")
     echo "   Time: ${TIME_SEQ} seconds"
-    grep "^Node" seq_temp.out | head -5
-    echo "   ..."
+    SUMMARY_SEQ=$(grep "^Summary" seq_temp.out)
+    echo "   $SUMMARY_SEQ"
 else
     echo "   Error: dijkstra_sequential not found"
     TIME_SEQ="N/A"
@@ -52,7 +75,7 @@ echo ""
 # OpenMP
 echo "2. OpenMP Dijkstra ($OMP_THREADS threads):"
 if [ -f "../build/dijkstra_openmp" ]; then
-    ../build/dijkstra_openmp "$GRAPH_FILE" "$SOURCE_NODE" "$OMP_THREADS" > omp_temp.out 2>&1
+    ../build/dijkstra_openmp --format summary "$GRAPH_FILE" "$SOURCE_NODE" "$OMP_THREADS" > omp_temp.out 2>&1
     TIME_OMP=$(grep "execution time" omp_temp.out | grep -oE "[0-9]+\.[0-9]+")
     echo "   Time: ${TIME_OMP} seconds"
     if [ "$TIME_SEQ" != "N/A" ] && [ -n "$TIME_SEQ" ] && [ -n "$TIME_OMP" ]; then
@@ -61,19 +84,15 @@ if [ -f "../build/dijkstra_openmp" ]; then
         echo "   Speedup: ${SPEEDUP_OMP}x"
         echo "   Efficiency: ${EFF_OMP}%"
     fi
-    grep "^Node" omp_temp.out | head -5
-    echo "   ..."
+    grep "^Summary" omp_temp.out | sed "s/^/   /"
     
     # Verify correctness
     if [ -f seq_temp.out ]; then
-        grep "^Node" seq_temp.out | sort > seq_dist.txt
-        grep "^Node" omp_temp.out | sort > omp_dist.txt
-        if diff -q seq_dist.txt omp_dist.txt > /dev/null; then
+        if [ -n "$SUMMARY_SEQ" ] && [ "$SUMMARY_SEQ" = "$(grep "^Summary" omp_temp.out)" ]; then
             echo "   Correctness: PASSED"
         else
             echo "   Correctness: FAILED"
         fi
-        rm -f seq_dist.txt omp_dist.txt
     fi
 else
     echo "   Error: dijkstra_openmp not found"
@@ -82,38 +101,34 @@ fi
 echo ""
 
 # MPI
-echo "3. MPI Dijkstra ($MPI_PROCS processes):"
-if [ -f "../build/dijkstra_mpi" ]; then
+echo "3. MPI Dijkstra ($MPI_LABEL):"
+if [ -f "$MPI_BINARY" ]; then
     if command -v mpirun &> /dev/null; then
-        mpirun -np "$MPI_PROCS" ../build/dijkstra_mpi "$GRAPH_FILE" "$SOURCE_NODE" > mpi_temp.out 2>&1
+        mpirun -np "$MPI_PROCS" "$MPI_BINARY" $MPI_ARGS --format summary "$GRAPH_FILE" "$SOURCE_NODE" > mpi_temp.out 2>&1
         TIME_MPI=$(grep "execution time" mpi_temp.out | grep -oE "[0-9]+\.[0-9]+")
         echo "   Time: ${TIME_MPI} seconds"
         if [ "$TIME_SEQ" != "N/A" ] && [ -n "$TIME_SEQ" ] && [ -n "$TIME_MPI" ]; then
             SPEEDUP_MPI=$(echo "scale=4; $TIME_SEQ / $TIME_MPI" | bc)
-            EFF_MPI=$(echo "scale=2; $SPEEDUP_MPI / $MPI_PROCS * 100" | bc)
+            EFF_MPI=$(echo "scale=2; $SPEEDUP_MPI / ($MPI_PROCS * $MPI_THREADS) * 100" | bc)
             echo "   Speedup: ${SPEEDUP_MPI}x"
             echo "   Efficiency: ${EFF_MPI}%"
         fi
-        grep "^Node" mpi_temp.out | head -5
-        echo "   ..."
+        grep "^Summary" mpi_temp.out | sed "s/^/   /"
         
         # Verify correctness
         if [ -f seq_temp.out ]; then
-            grep "^Node" seq_temp.out | sort > seq_dist.txt
-            grep "^Node" mpi_temp.out | sort > mpi_dist.txt
-            if diff -q seq_dist.txt mpi_dist.txt > /dev/null; then
+            if [ -n "$SUMMARY_SEQ" ] && [ "$SUMMARY_SEQ" = "$(grep "^Summary" mpi_temp.out)" ]; then
                 echo "   Correctness: PASSED"
             else
                 echo "   Correctness: FAILED"
             fi
-            rm -f seq_dist.txt mpi_dist.txt
         fi
     else
         echo "   Error: mpirun not found. Install MPI (mpich or openmpi)"
         TIME_MPI="N/A"
     fi
 else
-    echo "   Error: dijkstra_mpi not found. Compile with: make mpi"
+    echo "   Error: $(basename "$MPI_BINARY") not found. Compile with: $MPI_MAKE"
     TIME_MPI="N/A"
 fi
 echo ""
@@ -122,11 +137,11 @@ echo ""
 echo "=========================================="
 echo "Summary"
 echo "=========================================="
-printf "%-20s %15s\n" "Implementation" "Time (seconds)"
-echo "----------------------------------------"
-printf "%-20s %15s\n" "Sequential" "${TIME_SEQ:-N/A}"
-printf "%-20s %15s\n" "OpenMP ($OMP_THREADS threads)" "${TIME_OMP:-N/A}"
-printf "%-20s %15s\n" "MPI ($MPI_PROCS processes)" "${TIME_MPI:-N/A}"
+printf "%-32s %15s\n" "Implementation" "Time (seconds)"
+echo "------------------------------------------------"
+printf "%-32s %15s\n" "Sequential" "${TIME_SEQ:-N/A}"
+printf "%-32s %15s\n" "OpenMP ($OMP_THREADS threads)" "${TIME_OMP:-N/A}"
+printf "%-32s %15s\n" "MPI ($MPI_LABEL)" "${TIME_MPI:-N/A}"
 echo ""
 
 # Cleanup
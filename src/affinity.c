@@ -0,0 +1,249 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sched.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <omp.h>
+#include "affinity.h"
+
+// Node ids at or above this are counted with the last one in reports
+#define MAX_NUMA_NODES 64
+// Pages sampled by print_memory_placement
+#define PLACEMENT_SAMPLES 4096
+
+bool parse_thread_binding(const char *name, ThreadBinding *binding) {
+    if (strcmp(name, "none") == 0) {
+        *binding = BIND_NONE;
+    } else if (strcmp(name, "close") == 0) {
+        *binding = BIND_CLOSE;
+    } else if (strcmp(name, "spread") == 0) {
+        *binding = BIND_SPREAD;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* thread_binding_name(ThreadBinding binding) {
+    switch (binding) {
+        case BIND_CLOSE:
+            return "close";
+        case BIND_SPREAD:
+            return "spread";
+        case BIND_NONE:
+        default:
+            return "none";
+    }
+}
+
+// NUMA node of cpu from the nodeN entry in its sysfs directory; 0 when
+// the kernel does not expose one (single-node or non-NUMA systems)
+static int cpu_numa_node(int cpu) {
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+    DIR *dir = opendir(path);
+    if (!dir) {
+        return 0;
+    }
+    int node = 0;
+    for (;;) {
+        struct dirent *entry = readdir(dir);
+        if (!entry) {
+            break;
+        }
+        if (strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
+            node = atoi(entry->d_name + 4);
+            break;
+        }
+    }
+    closedir(dir);
+    return node < MAX_NUMA_NODES ? node : MAX_NUMA_NODES - 1;
+}
+
+typedef struct {
+    int cpu;
+    int node;
+} CpuSlot;
+
+static int compare_cpu_slots(const void *a, const void *b) {
+    const CpuSlot *x = (const CpuSlot*)a;
+    const CpuSlot *y = (const CpuSlot*)b;
+    if (x->node != y->node) {
+        return x->node - y->node;
+    }
+    return x->cpu - y->cpu;
+}
+
+// The CPUs this process may run on, in the order threads are assigned to
+// them: grouped by NUMA node for close, one per node in turn for spread.
+// Returns a malloc'd array of *count CPU ids, or NULL on error.
+static int* binding_order(ThreadBinding binding, int *count) {
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        perror("Error reading CPU affinity");
+        return NULL;
+    }
+    int num_cpus = CPU_COUNT(&allowed);
+    CpuSlot *slots = (CpuSlot*)malloc((size_t)(num_cpus > 0 ? num_cpus : 1) * sizeof(CpuSlot));
+    int *order = (int*)malloc((size_t)(num_cpus > 0 ? num_cpus : 1) * sizeof(int));
+    if (!slots || !order || num_cpus == 0) {
+        perror("Error allocating CPU list");
+        free(slots);
+        free(order);
+        return NULL;
+    }
+    int n = 0;
+    for (int cpu = 0; cpu < CPU_SETSIZE && n < num_cpus; cpu++) {
+        if (CPU_ISSET(cpu, &allowed)) {
+            slots[n].cpu = cpu;
+            slots[n].node = cpu_numa_node(cpu);
+            n++;
+        }
+    }
+    qsort(slots, (size_t)n, sizeof(CpuSlot), compare_cpu_slots);
+
+    if (binding == BIND_SPREAD) {
+        // Round r takes the r-th CPU of every node that still has one
+        int *node_start = (int*)calloc(MAX_NUMA_NODES + 1, sizeof(int));
+        if (!node_start) {
+            perror("Error allocating CPU list");
+            free(slots);
+            free(order);
+            return NULL;
+        }
+        for (int i = 0; i < n; i++) {
+            node_start[slots[i].node + 1]++;
+        }
+        for (int k = 0; k < MAX_NUMA_NODES; k++) {
+            node_start[k + 1] += node_start[k];
+        }
+        int filled = 0;
+        for (int round = 0; filled < n; round++) {
+            for (int k = 0; k < MAX_NUMA_NODES; k++) {
+                if (node_start[k] + round < node_start[k + 1]) {
+                    order[filled++] = slots[node_start[k] + round].cpu;
+                }
+            }
+        }
+        free(node_start);
+    } else {
+        for (int i = 0; i < n; i++) {
+            order[i] = slots[i].cpu;
+        }
+    }
+    free(slots);
+    *count = n;
+    return order;
+}
+
+static bool runtime_binds_threads(void) {
+    return omp_get_proc_bind() != omp_proc_bind_false;
+}
+
+bool bind_threads(ThreadBinding binding, int num_threads) {
+    if (binding == BIND_NONE || runtime_binds_threads()) {
+        return true;
+    }
+    int num_cpus = 0;
+    int *order = binding_order(binding, &num_cpus);
+    if (!order) {
+        return false;
+    }
+    // sched_setaffinity on thread id 0 pins the calling thread only
+    bool ok = true;
+    #pragma omp parallel num_threads(num_threads) reduction(&&:ok)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(order[omp_get_thread_num() % num_cpus], &set);
+        ok = sched_setaffinity(0, sizeof(set), &set) == 0;
+    }
+    free(order);
+    if (!ok) {
+        perror("Error pinning threads");
+    }
+    return ok;
+}
+
+void print_thread_placement(FILE *out, ThreadBinding binding, int num_threads) {
+    int *cpus = (int*)malloc((size_t)num_threads * sizeof(int));
+    if (!cpus) {
+        perror("Error allocating placement report");
+        return;
+    }
+    #pragma omp parallel num_threads(num_threads)
+    cpus[omp_get_thread_num()] = sched_getcpu();
+
+    int per_node[MAX_NUMA_NODES] = {0};
+    const char *policy = runtime_binds_threads() ? "OMP_PROC_BIND" : thread_binding_name(binding);
+    fprintf(out, "Thread placement (%s%s):", policy, binding == BIND_NONE && !runtime_binds_threads()
+            ? ", unpinned threads may migrate" : "");
+    for (int t = 0; t < num_threads; t++) {
+        int node = cpus[t] >= 0 ? cpu_numa_node(cpus[t]) : 0;
+        per_node[node]++;
+        fprintf(out, " %d:cpu%d/node%d", t, cpus[t], node);
+    }
+    fprintf(out, "\nThreads per NUMA node:");
+    for (int k = 0; k < MAX_NUMA_NODES; k++) {
+        if (per_node[k] > 0) {
+            fprintf(out, " node%d %d", k, per_node[k]);
+        }
+    }
+    fputc('\n', out);
+    free(cpus);
+}
+
+void print_memory_placement(FILE *out, const char *name, const void *data, size_t bytes) {
+#ifdef SYS_move_pages
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    size_t num_pages = (bytes + page_size - 1) / page_size;
+    if (num_pages == 0) {
+        return;
+    }
+    size_t samples = num_pages < PLACEMENT_SAMPLES ? num_pages : PLACEMENT_SAMPLES;
+    void **pages = (void**)malloc(samples * sizeof(void*));
+    int *status = (int*)malloc(samples * sizeof(int));
+    if (!pages || !status) {
+        perror("Error allocating placement report");
+        free(pages);
+        free(status);
+        return;
+    }
+    // Evenly spaced pages; move_pages with no target nodes only reports
+    uintptr_t first = (uintptr_t)data & ~(uintptr_t)(page_size - 1);
+    for (size_t i = 0; i < samples; i++) {
+        pages[i] = (void*)(first + (i * num_pages / samples) * page_size);
+    }
+    long result = syscall(SYS_move_pages, 0, (unsigned long)samples, pages, NULL, status, 0);
+    int per_node[MAX_NUMA_NODES] = {0};
+    size_t unplaced = 0;
+    for (size_t i = 0; i < samples; i++) {
+        if (result != 0 || status[i] < 0) {
+            unplaced++;
+        } else {
+            per_node[status[i] < MAX_NUMA_NODES ? status[i] : MAX_NUMA_NODES - 1]++;
+        }
+    }
+    fprintf(out, "Pages of %s by NUMA node:", name);
+    for (int k = 0; k < MAX_NUMA_NODES; k++) {
+        if (per_node[k] > 0) {
+            fprintf(out, " node%d %.1f%%", k, 100.0 * per_node[k] / (double)samples);
+        }
+    }
+    if (unplaced > 0) {
+        fprintf(out, " unknown %.1f%%", 100.0 * (double)unplaced / (double)samples);
+    }
+    fputc('\n', out);
+    free(pages);
+    free(status);
+#else
+    (void)out;
+    (void)name;
+    (void)data;
+    (void)bytes;
+#endif
+}
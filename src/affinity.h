@@ -0,0 +1,34 @@
+#ifndef AFFINITY_H
+#define AFFINITY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// Thread pinning and NUMA placement reports (affinity.c, Linux)
+typedef enum {
+    BIND_NONE,      // leave threads to the scheduler
+    BIND_CLOSE,     // thread t on the t-th allowed CPU, filling one NUMA node before the next
+    BIND_SPREAD     // threads dealt round-robin over the NUMA nodes
+} ThreadBinding;
+
+// Map "none" / "close" / "spread" to a binding; returns false for unknown names
+bool parse_thread_binding(const char *name, ThreadBinding *binding);
+const char* thread_binding_name(ThreadBinding binding);
+
+// Pin the threads of num_threads-wide parallel regions to CPUs of the
+// process's affinity mask. OpenMP runtimes reuse their pooled threads, so
+// the pinning holds for the later regions of the engines; call it before
+// the data the threads will use is first touched. Does nothing when the
+// runtime already binds threads (OMP_PROC_BIND / OMP_PLACES set). Returns
+// false if the affinity could not be set.
+bool bind_threads(ThreadBinding binding, int num_threads);
+
+// Print the CPU and NUMA node each of num_threads threads runs on
+void print_thread_placement(FILE *out, ThreadBinding binding, int num_threads);
+
+// Print the share of the pages of data[0, bytes) resident on each NUMA
+// node (sampled, at most 4096 pages)
+void print_memory_placement(FILE *out, const char *name, const void *data, size_t bytes);
+
+#endif
@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <omp.h>
+#include "sssp.h"
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--selection farthest|avoid] [--engine auto|scan|heap|dial|radix] [--threads <n>] <input_file> <num_landmarks> <output_file>\n", prog);
+    fprintf(stderr, "Picks landmarks and writes their distance tables for A* (ALT) queries\n");
+    fprintf(stderr, "Example: %s --selection avoid weighted_graph.bin 16 weighted_graph.landmarks\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    LandmarkSelection selection = LANDMARKS_FARTHEST;
+    SequentialEngine engine = ENGINE_AUTO;
+    int num_threads = 0;
+
+    static const struct option long_options[] = {
+        {"selection", required_argument, NULL, 's'},
+        {"engine", required_argument, NULL, 'e'},
+        {"threads", required_argument, NULL, 't'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "s:e:t:", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 's':
+                if (!parse_landmark_selection(optarg, &selection)) {
+                    fprintf(stderr, "Error: Unknown landmark selection '%s'\n", optarg);
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'e':
+                if (!parse_sequential_engine(optarg, &engine)) {
+                    fprintf(stderr, "Error: Unknown engine '%s'\n", optarg);
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 't':
+                num_threads = atoi(optarg);
+                if (num_threads <= 0) {
+                    fprintf(stderr, "Error: Number of threads must be positive\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (argc - optind != 3) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const char *input = argv[optind];
+    int num_landmarks = atoi(argv[optind + 1]);
+    const char *output = argv[optind + 2];
+    if (num_landmarks <= 0) {
+        fprintf(stderr, "Error: Number of landmarks must be positive\n");
+        return EXIT_FAILURE;
+    }
+    if (num_threads <= 0) {
+        num_threads = omp_get_max_threads();
+    }
+
+    double start = omp_get_wtime();
+    Graph *graph = read_graph_from_file(input);
+    if (!graph) {
+        return EXIT_FAILURE;
+    }
+    double load_time = omp_get_wtime() - start;
+
+    start = omp_get_wtime();
+    LandmarkTable *table = compute_landmarks(graph, num_landmarks, selection, engine, num_threads);
+    double prep_time = omp_get_wtime() - start;
+    if (!table) {
+        free_graph(graph);
+        return EXIT_FAILURE;
+    }
+
+    start = omp_get_wtime();
+    int status = write_landmarks_binary(table, graph, output);
+    double write_time = omp_get_wtime() - start;
+
+    if (status == 0) {
+        printf("Wrote %d landmarks (%s) for %s to %s\n", table->num_landmarks,
+               landmark_selection_name(selection), input, output);
+        printf("Landmarks:");
+        for (int l = 0; l < table->num_landmarks; l++) {
+            printf(" %d", table->landmarks[l]);
+        }
+        printf("\n");
+        printf("Load time: %.6f seconds, preprocessing time: %.6f seconds (%d threads, %s), write time: %.6f seconds\n",
+               load_time, prep_time, num_threads,
+               sequential_engine_name(resolve_sequential_engine(engine, graph)), write_time);
+    }
+
+    free_landmarks(table);
+    free_graph(graph);
+    return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <omp.h>
+#include "sssp.h"
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--core-degree <d>] [--threads <n>] <input_file> <output_file>\n", prog);
+    fprintf(stderr, "Builds a contraction hierarchy for fast point-to-point queries. Contraction\n");
+    fprintf(stderr, "stops once the remaining nodes average more than d edges (default %d, 0 for no limit)\n",
+            CH_DEFAULT_CORE_DEGREE);
+    fprintf(stderr, "Example: %s weighted_graph.bin weighted_graph.ch\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    int core_degree = CH_DEFAULT_CORE_DEGREE;
+    int num_threads = 0;
+
+    static const struct option long_options[] = {
+        {"core-degree", required_argument, NULL, 'c'},
+        {"threads", required_argument, NULL, 't'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "c:t:", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'c':
+                core_degree = atoi(optarg);
+                if (core_degree < 0) {
+                    fprintf(stderr, "Error: Core degree must not be negative\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 't':
+                num_threads = atoi(optarg);
+                if (num_threads <= 0) {
+                    fprintf(stderr, "Error: Number of threads must be positive\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (argc - optind != 2) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const char *input = argv[optind];
+    const char *output = argv[optind + 1];
+    if (num_threads <= 0) {
+        num_threads = omp_get_max_threads();
+    }
+
+    double start = omp_get_wtime();
+    Graph *graph = read_graph_from_file(input);
+    if (!graph) {
+        return EXIT_FAILURE;
+    }
+    double load_time = omp_get_wtime() - start;
+
+    ContractionStats stats;
+    start = omp_get_wtime();
+    ContractionHierarchy *ch = contract_graph(graph, core_degree, num_threads, &stats);
+    double prep_time = omp_get_wtime() - start;
+    if (!ch) {
+        free_graph(graph);
+        return EXIT_FAILURE;
+    }
+
+    start = omp_get_wtime();
+    int status = write_hierarchy_binary(ch, output);
+    double write_time = omp_get_wtime() - start;
+
+    if (status == 0) {
+        printf("Wrote contraction hierarchy for %s to %s\n", input, output);
+        printf("Nodes: %d, upward edges: %d, shortcuts: %lld, rounds: %d, core nodes: %d, witness nodes settled: %lld\n",
+               ch->up->num_nodes, ch->up->offsets[ch->up->num_nodes], stats.num_shortcuts, stats.num_rounds,
+               stats.core_nodes, stats.witness_settled);
+        printf("Load time: %.6f seconds, preprocessing time: %.6f seconds (%d threads), write time: %.6f seconds\n",
+               load_time, prep_time, num_threads, write_time);
+    }
+
+    free_hierarchy(ch);
+    free_graph(graph);
+    return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
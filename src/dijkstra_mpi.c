@@ -1,91 +1,92 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <limits.h>
 #include <stdbool.h>
+#include <string.h>
 #include <time.h>
+#include <getopt.h>
 #include <mpi.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "dist_graph.h"
+#include "pqueue.h"
+#include "sssp.h"
+#include "instrument.h"
 
-#define INF INT_MAX
 #define TAG_MIN_NODE 1
 #define TAG_MIN_DIST 2
 #define TAG_DISTANCES 3
 #define TAG_CONTINUE 4
 
-typedef struct {
-    int dest;
-    int weight;
-} Edge;
+// Local scans shorter than this stay on one thread in the hybrid build
+#define PARALLEL_SCAN_MIN 4096
 
-typedef struct {
-    int num_nodes;
-    int num_edges;
-    Edge **adj_list;  
-    int *adj_size;   
-} Graph;
+typedef enum {
+    MPI_MODE_GATHER,    // gather local minima on rank 0, broadcast remote relaxations
+    MPI_MODE_SPARSE,    // MINLOC allreduce, remote relaxations scattered to their owners
+    MPI_MODE_DELTA      // distributed delta-stepping, batched Alltoallv exchange
+} MpiMode;
 
-Graph* create_graph(int num_nodes, int num_edges) {
-    Graph *graph = (Graph*)malloc(sizeof(Graph));
-    graph->num_nodes = num_nodes;
-    graph->num_edges = num_edges;
-    graph->adj_list = (Edge**)malloc(num_nodes * sizeof(Edge*));
-    graph->adj_size = (int*)calloc(num_nodes, sizeof(int));
-    
-    for (int i = 0; i < num_nodes; i++) {
-        graph->adj_list[i] = (Edge*)malloc(sizeof(Edge));
+// Smallest unvisited local distance, ties to the lowest node; the scan is
+// split across the rank's OpenMP threads in the hybrid build
+static void local_minimum(const DistGraph *graph, const bool *visited, const int *local_dist,
+                          int *min_dist, int *min_node) {
+    int best_dist = INF;
+    int best_node = -1;
+    #pragma omp parallel num_threads(graph->num_threads) if(graph->local_nodes >= PARALLEL_SCAN_MIN)
+    {
+        int thread_dist = INF;
+        int thread_node = -1;
+        INSTR_PHASE_BEGIN(scan_start);
+        #pragma omp for nowait
+        for (int i = 0; i < graph->local_nodes; i++) {
+            if (!visited[i] && local_dist[i] < thread_dist) {
+                thread_dist = local_dist[i];
+                thread_node = graph->first_node + i;
+            }
+        }
+        INSTR_PHASE_END(INSTR_SELECT, scan_start);
+        #pragma omp critical
+        {
+            if (thread_node != -1 &&
+                (thread_dist < best_dist || (thread_dist == best_dist && thread_node < best_node))) {
+                best_dist = thread_dist;
+                best_node = thread_node;
+            }
+        }
     }
-    
-    return graph;
-}
-
-void add_edge(Graph *graph, int u, int v, int weight) {
-    int u_size = graph->adj_size[u];
-    int v_size = graph->adj_size[v];
-    
-    graph->adj_list[u] = (Edge*)realloc(graph->adj_list[u], (u_size + 1) * sizeof(Edge));
-    graph->adj_list[u][u_size].dest = v;
-    graph->adj_list[u][u_size].weight = weight;
-    graph->adj_size[u]++;
-    
-    graph->adj_list[v] = (Edge*)realloc(graph->adj_list[v], (v_size + 1) * sizeof(Edge));
-    graph->adj_list[v][v_size].dest = u;
-    graph->adj_list[v][v_size].weight = weight;
-    graph->adj_size[v]++;
+    *min_dist = best_dist;
+    *min_node = best_node;
 }
 
-void free_graph(Graph *graph) {
-    for (int i = 0; i < graph->num_nodes; i++) {
-        free(graph->adj_list[i]);
+// Parallel Dijkstra's algorithm using MPI over a partitioned graph.
+// Each rank holds distances and visited flags only for the nodes it owns;
+// the owner of the selected node relaxes its edges and routes the
+// relaxations of remote targets to the other ranks. With shared distances,
+// targets owned by ranks on the same host are updated in place instead.
+void dijkstra_mpi(const DistGraph *graph, const SharedDistances *shared, int source, int *local_dist) {
+    int rank = graph->rank;
+    int size = graph->size;
+    int first = graph->first_node;
+    bool *visited = (bool*)calloc(graph->local_nodes > 0 ? graph->local_nodes : 1, sizeof(bool));
+    // (target, distance) pairs for the selected node's remote neighbors
+    int *updates = (int*)malloc((2 * (size_t)graph->max_degree + 2) * sizeof(int));
+    if (!visited || !updates) {
+        perror("Error allocating MPI state");
+        MPI_Abort(graph->comm, EXIT_FAILURE);
     }
-    free(graph->adj_list);
-    free(graph->adj_size);
-    free(graph);
-}
-
-// Parallel Dijkstra's algorithm using MPI
-void dijkstra_mpi(Graph *graph, int source, int *distances, int rank, int size) {
-    bool *visited = (bool*)calloc(graph->num_nodes, sizeof(bool));
     
-    for (int i = 0; i < graph->num_nodes; i++) {
-        distances[i] = INF;
+    for (int i = 0; i < graph->local_nodes; i++) {
+        local_dist[i] = INF;
+    }
+    if (dist_graph_owns(graph, source)) {
+        local_dist[source - first] = 0;
     }
-    distances[source] = 0;
-    
-    MPI_Bcast(distances, graph->num_nodes, MPI_INT, 0, MPI_COMM_WORLD);
     
     for (int count = 0; count < graph->num_nodes; count++) {
-        int local_min_dist = INF;
-        int local_min_node = -1;
-        
-        int nodes_per_proc = graph->num_nodes / size;
-        int start_node = rank * nodes_per_proc;
-        int end_node = (rank == size - 1) ? graph->num_nodes : (rank + 1) * nodes_per_proc;
-        
-        for (int v = start_node; v < end_node; v++) {
-            if (!visited[v] && distances[v] < local_min_dist) {
-                local_min_dist = distances[v];
-                local_min_node = v;
-            }
-        }
+        shared_distances_sync(shared);
+        int local_min_dist, local_min_node;
+        local_minimum(graph, visited, local_dist, &local_min_dist, &local_min_node);
         
         int *all_min_dists = NULL;
         int *all_min_nodes = NULL;
@@ -95,8 +96,11 @@ void dijkstra_mpi(Graph *graph, int source, int *distances, int rank, int size)
             all_min_nodes = (int*)malloc(size * sizeof(int));
         }
         
-        MPI_Gather(&local_min_dist, 1, MPI_INT, all_min_dists, 1, MPI_INT, 0, MPI_COMM_WORLD);
-        MPI_Gather(&local_min_node, 1, MPI_INT, all_min_nodes, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        // Instrumented bytes count what this rank sends plus what it receives
+        INSTR_MPI(INSTR_MPI_GATHER, (rank == 0 ? (size_t)size + 1 : 1) * sizeof(int),
+                  MPI_Gather(&local_min_dist, 1, MPI_INT, all_min_dists, 1, MPI_INT, 0, graph->comm));
+        INSTR_MPI(INSTR_MPI_GATHER, (rank == 0 ? (size_t)size + 1 : 1) * sizeof(int),
+                  MPI_Gather(&local_min_node, 1, MPI_INT, all_min_nodes, 1, MPI_INT, 0, graph->comm));
         
         int min_dist = INF;
         int min_node = -1;
@@ -112,156 +116,804 @@ void dijkstra_mpi(Graph *graph, int source, int *distances, int rank, int size)
             free(all_min_nodes);
         }
         
-        MPI_Bcast(&min_dist, 1, MPI_INT, 0, MPI_COMM_WORLD);
-        MPI_Bcast(&min_node, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        INSTR_MPI(INSTR_MPI_BCAST, sizeof(int), MPI_Bcast(&min_dist, 1, MPI_INT, 0, graph->comm));
+        INSTR_MPI(INSTR_MPI_BCAST, sizeof(int), MPI_Bcast(&min_node, 1, MPI_INT, 0, graph->comm));
         
         if (min_dist == INF || min_node == -1) {
             break;
         }
         
-        visited[min_node] = true;
+        // Only the owner has the node's adjacency; local targets are relaxed
+        // in place and remote ones are collected for their owners
+        int owner = dist_graph_owner(graph, min_node);
+        int num_updates = 0;
+        INSTR_PHASE_BEGIN(relax_start);
+        if (rank == owner) {
+            int u = min_node - first;
+            visited[u] = true;
+            INSTR_COUNT(INSTR_SETTLED, 1);
+            INSTR_COUNT(INSTR_EDGES, graph->offsets[u + 1] - graph->offsets[u]);
+            for (int i = graph->offsets[u]; i < graph->offsets[u + 1]; i++) {
+                int neighbor = graph->dest[i];
+                int new_dist = min_dist + graph->weight[i];
+                int *slot;
+                if (dist_graph_owns(graph, neighbor)) {
+                    int v = neighbor - first;
+                    if (!visited[v] && new_dist < local_dist[v]) {
+                        local_dist[v] = new_dist;
+                        INSTR_COUNT(INSTR_DECREASES, 1);
+                    }
+                } else if ((slot = shared_distance_slot(shared, graph, neighbor)) != NULL) {
+                    // A settled node never improves, so no visited check is needed
+                    if (new_dist < *slot) {
+                        *slot = new_dist;
+                        INSTR_COUNT(INSTR_DECREASES, 1);
+                    }
+                } else {
+                    updates[2 * num_updates] = neighbor;
+                    updates[2 * num_updates + 1] = new_dist;
+                    num_updates++;
+                }
+            }
+            shared_distances_sync(shared);
+        }
+        INSTR_PHASE_END(INSTR_RELAX, relax_start);
         
-        int adj_size = graph->adj_size[min_node];
-        int neighbors_per_proc = adj_size / size;
-        int start_neighbor = rank * neighbors_per_proc;
-        int end_neighbor = (rank == size - 1) ? adj_size : (rank + 1) * neighbors_per_proc;
+        INSTR_MPI(INSTR_MPI_BCAST, sizeof(int), MPI_Bcast(&num_updates, 1, MPI_INT, owner, graph->comm));
+        if (num_updates == 0) {
+            continue;
+        }
+        INSTR_MPI(INSTR_MPI_BCAST, 2 * (size_t)num_updates * sizeof(int),
+                  MPI_Bcast(updates, 2 * num_updates, MPI_INT, owner, graph->comm));
         
-        for (int i = start_neighbor; i < end_neighbor; i++) {
-            int neighbor = graph->adj_list[min_node][i].dest;
-            int weight = graph->adj_list[min_node][i].weight;
-            
-            if (!visited[neighbor] && distances[min_node] != INF) {
-                int new_dist = distances[min_node] + weight;
-                if (new_dist < distances[neighbor]) {
-                    distances[neighbor] = new_dist;
+        if (rank != owner) {
+            INSTR_PHASE_BEGIN(apply_start);
+            for (int k = 0; k < num_updates; k++) {
+                int neighbor = updates[2 * k];
+                if (dist_graph_owns(graph, neighbor)) {
+                    int v = neighbor - first;
+                    if (!visited[v] && updates[2 * k + 1] < local_dist[v]) {
+                        local_dist[v] = updates[2 * k + 1];
+                        INSTR_COUNT(INSTR_DECREASES, 1);
+                    }
+                }
+            }
+            INSTR_PHASE_END(INSTR_RELAX, apply_start);
+        }
+    }
+    
+    free(visited);
+    free(updates);
+}
+
+// Communication-efficient variant: one MPI_Allreduce with MPI_MINLOC picks the
+// global (distance, node) minimum, and the owner of that node scatters each
+// remote relaxation only to the rank that owns its target. Per-iteration
+// traffic is O(P + degree) instead of O(P + P * degree).
+void dijkstra_mpi_sparse(const DistGraph *graph, const SharedDistances *shared, int source, int *local_dist) {
+    int rank = graph->rank;
+    int size = graph->size;
+    int first = graph->first_node;
+    size_t buffer_size = 2 * (size_t)graph->max_degree + 2;
+    bool *visited = (bool*)calloc(graph->local_nodes > 0 ? graph->local_nodes : 1, sizeof(bool));
+    int *send_buf = (int*)malloc(buffer_size * sizeof(int));
+    int *recv_buf = (int*)malloc(buffer_size * sizeof(int));
+    int *send_counts = (int*)malloc((size_t)size * sizeof(int));
+    int *send_displs = (int*)malloc((size_t)size * sizeof(int));
+    if (!visited || !send_buf || !recv_buf || !send_counts || !send_displs) {
+        perror("Error allocating MPI state");
+        MPI_Abort(graph->comm, EXIT_FAILURE);
+    }
+    
+    for (int i = 0; i < graph->local_nodes; i++) {
+        local_dist[i] = INF;
+    }
+    if (dist_graph_owns(graph, source)) {
+        local_dist[source - first] = 0;
+    }
+    
+    for (int count = 0; count < graph->num_nodes; count++) {
+        // MPI_2INT pair: MINLOC keeps the smallest distance, ties to the lowest node
+        shared_distances_sync(shared);
+        struct { int dist; int node; } local_min, global_min;
+        local_minimum(graph, visited, local_dist, &local_min.dist, &local_min.node);
+        INSTR_MPI(INSTR_MPI_ALLREDUCE, 2 * sizeof(local_min),
+                  MPI_Allreduce(&local_min, &global_min, 1, MPI_2INT, MPI_MINLOC, graph->comm));
+        
+        if (global_min.dist == INF || global_min.node == -1) {
+            break;
+        }
+        
+        int owner = dist_graph_owner(graph, global_min.node);
+        INSTR_PHASE_BEGIN(relax_start);
+        if (rank == owner) {
+            int u = global_min.node - first;
+            visited[u] = true;
+            INSTR_COUNT(INSTR_SETTLED, 1);
+            INSTR_COUNT(INSTR_EDGES, graph->offsets[u + 1] - graph->offsets[u]);
+            // Relax local targets in place and bucket remote ones by owner
+            memset(send_counts, 0, (size_t)size * sizeof(int));
+            for (int i = graph->offsets[u]; i < graph->offsets[u + 1]; i++) {
+                int neighbor = graph->dest[i];
+                int new_dist = global_min.dist + graph->weight[i];
+                int *slot;
+                if (dist_graph_owns(graph, neighbor)) {
+                    int v = neighbor - first;
+                    if (!visited[v] && new_dist < local_dist[v]) {
+                        local_dist[v] = new_dist;
+                        INSTR_COUNT(INSTR_DECREASES, 1);
+                    }
+                } else if ((slot = shared_distance_slot(shared, graph, neighbor)) != NULL) {
+                    if (new_dist < *slot) {
+                        *slot = new_dist;
+                        INSTR_COUNT(INSTR_DECREASES, 1);
+                    }
+                } else {
+                    send_counts[dist_graph_owner(graph, neighbor)] += 2;
+                }
+            }
+            shared_distances_sync(shared);
+            int offset = 0;
+            for (int r = 0; r < size; r++) {
+                send_displs[r] = offset;
+                offset += send_counts[r];
+            }
+            for (int i = graph->offsets[u]; i < graph->offsets[u + 1]; i++) {
+                int neighbor = graph->dest[i];
+                if (!dist_graph_owns(graph, neighbor) && !shared_distance_slot(shared, graph, neighbor)) {
+                    int pos = send_displs[dist_graph_owner(graph, neighbor)];
+                    send_buf[pos] = neighbor;
+                    send_buf[pos + 1] = global_min.dist + graph->weight[i];
+                    send_displs[dist_graph_owner(graph, neighbor)] += 2;
                 }
             }
+            for (int r = 0; r < size; r++) {
+                send_displs[r] -= send_counts[r];
+            }
         }
+        INSTR_PHASE_END(INSTR_RELAX, relax_start);
+        
+        int recv_count = 0;
+        INSTR_MPI(INSTR_MPI_SCATTER, (rank == owner ? (size_t)size + 1 : 1) * sizeof(int),
+                  MPI_Scatter(send_counts, 1, MPI_INT, &recv_count, 1, MPI_INT, owner, graph->comm));
+        INSTR_MPI(INSTR_MPI_SCATTERV,
+                  ((rank == owner ? (size_t)send_displs[size - 1] + send_counts[size - 1] : 0) +
+                   (size_t)recv_count) * sizeof(int),
+                  MPI_Scatterv(send_buf, send_counts, send_displs, MPI_INT,
+                               recv_buf, recv_count, MPI_INT, owner, graph->comm));
         
-        MPI_Allreduce(MPI_IN_PLACE, distances, graph->num_nodes, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+        INSTR_PHASE_BEGIN(apply_start);
+        for (int k = 0; k < recv_count; k += 2) {
+            int v = recv_buf[k] - first;
+            if (!visited[v] && recv_buf[k + 1] < local_dist[v]) {
+                local_dist[v] = recv_buf[k + 1];
+                INSTR_COUNT(INSTR_DECREASES, 1);
+            }
+        }
+        INSTR_PHASE_END(INSTR_RELAX, apply_start);
     }
     
     free(visited);
+    free(send_buf);
+    free(recv_buf);
+    free(send_counts);
+    free(send_displs);
+}
+
+// Per-thread delta-stepping state: buckets of local node indices, the nodes
+// settled in the current bucket, and remote (target, distance) requests
+// batched per destination rank
+typedef struct {
+    BucketSet buckets;
+    NodeList settled;
+    NodeList *outbox;
+    char pad[64];
+} DeltaThread;
+
+typedef struct {
+    const DistGraph *graph;
+    const SharedDistances *shared;
+    int *local_dist;
+    int *settled_bin;       // last bucket each local node was settled in
+    DeltaThread *threads;
+    int num_threads;
+    int delta;
+    NodeList frontier;
+    int *thread_sizes;      // num_threads + 1 prefix sums for gather_frontier
+    int *send_counts;
+    int *send_displs;
+    int *recv_counts;
+    int *recv_displs;
+    NodeList send_buf;
+    NodeList recv_buf;
+    bool push_failed;       // a bucket or outbox could not grow; see check_pushes
+} DeltaState;
+
+static inline int thread_id(void) {
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
 }
 
-Graph* read_graph_from_file(const char *filename) {
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        perror("Error opening file");
-        return NULL;
+// Buckets and outboxes grow inside parallel regions, where only the main
+// thread may call MPI; a failed push is recorded and the main thread aborts
+// the communicator at its next exchange
+static inline void note_push(DeltaState *state, bool ok) {
+    if (!ok) {
+        __atomic_store_n(&state->push_failed, true, __ATOMIC_RELAXED);
+    }
+}
+
+static void check_pushes(const DeltaState *state) {
+    if (state->push_failed) {
+        MPI_Abort(state->graph->comm, EXIT_FAILURE);
+    }
+}
+
+static inline void relax_owned(DeltaState *state, DeltaThread *self, int v, int new_dist) {
+    if (atomic_min_int(&state->local_dist[v], new_dist)) {
+        note_push(state, bucket_push(&self->buckets, new_dist / state->delta, v));
+        INSTR_COUNT(INSTR_DECREASES, 1);
+    }
+}
+
+// Relax the light (or heavy) edges of local node u, queueing remote targets.
+// Targets on a co-located rank are lowered in shared memory and only a
+// (target, -1) notice is queued, so the owner files the node in its bucket.
+static void relax_edges(DeltaState *state, DeltaThread *self, int u, bool light) {
+    const DistGraph *graph = state->graph;
+    int dist = __atomic_load_n(&state->local_dist[u], __ATOMIC_RELAXED);
+    INSTR_COUNT(INSTR_EDGES, graph->offsets[u + 1] - graph->offsets[u]);
+    for (int i = graph->offsets[u]; i < graph->offsets[u + 1]; i++) {
+        int weight = graph->weight[i];
+        if ((weight <= state->delta) != light) {
+            continue;
+        }
+        int neighbor = graph->dest[i];
+        int new_dist = dist + weight;
+        int *slot;
+        if (dist_graph_owns(graph, neighbor)) {
+            relax_owned(state, self, neighbor - graph->first_node, new_dist);
+        } else if ((slot = shared_distance_slot(state->shared, graph, neighbor)) != NULL) {
+            if (atomic_min_int(slot, new_dist)) {
+                INSTR_COUNT(INSTR_DECREASES, 1);
+                NodeList *out = &self->outbox[dist_graph_owner(graph, neighbor)];
+                note_push(state, node_list_push(out, neighbor) && node_list_push(out, -1));
+            }
+        } else {
+            NodeList *out = &self->outbox[dist_graph_owner(graph, neighbor)];
+            note_push(state, node_list_push(out, neighbor) && node_list_push(out, new_dist));
+        }
+    }
+}
+
+static void reserve_list(const DistGraph *graph, NodeList *list, size_t capacity) {
+    if (capacity > (size_t)list->capacity) {
+        free(list->data);
+        list->data = (int*)malloc(capacity * sizeof(int));
+        if (!list->data) {
+            perror("Error allocating exchange buffer");
+            MPI_Abort(graph->comm, EXIT_FAILURE);
+        }
+        list->capacity = (int)capacity;
+    }
+}
+
+// Concatenate every thread's copy of bucket bin into the frontier
+static void gather_frontier(DeltaState *state, int bin) {
+    int total = 0;
+    for (int t = 0; t < state->num_threads; t++) {
+        BucketSet *buckets = &state->threads[t].buckets;
+        state->thread_sizes[t] = total;
+        total += (bin < buckets->num_bins) ? buckets->bins[bin].size : 0;
+    }
+    state->thread_sizes[state->num_threads] = total;
+    reserve_list(state->graph, &state->frontier, total > 0 ? (size_t)total : 1);
+    state->frontier.size = total;
+    for (int t = 0; t < state->num_threads; t++) {
+        BucketSet *buckets = &state->threads[t].buckets;
+        if (bin < buckets->num_bins && buckets->bins[bin].size > 0) {
+            memcpy(state->frontier.data + state->thread_sizes[t], buckets->bins[bin].data,
+                   (size_t)buckets->bins[bin].size * sizeof(int));
+            buckets->bins[bin].size = 0;
+        }
+    }
+}
+
+// Deliver every queued request to its owner with one MPI_Alltoallv and apply
+// the ones received here. Collective over the graph's communicator; called
+// outside parallel regions (MPI_THREAD_FUNNELED).
+static void exchange_relaxations(DeltaState *state) {
+    check_pushes(state);
+    const DistGraph *graph = state->graph;
+    int size = graph->size;
+    int total_send = 0;
+    shared_distances_sync(state->shared);
+    for (int r = 0; r < size; r++) {
+        state->send_counts[r] = 0;
+        for (int t = 0; t < state->num_threads; t++) {
+            state->send_counts[r] += state->threads[t].outbox[r].size;
+        }
+        state->send_displs[r] = total_send;
+        total_send += state->send_counts[r];
+    }
+    INSTR_MPI(INSTR_MPI_ALLTOALL, 2 * (size_t)size * sizeof(int),
+              MPI_Alltoall(state->send_counts, 1, MPI_INT, state->recv_counts, 1, MPI_INT, graph->comm));
+    int total_recv = 0;
+    for (int r = 0; r < size; r++) {
+        state->recv_displs[r] = total_recv;
+        total_recv += state->recv_counts[r];
     }
     
-    int first = fgetc(file);
-    int second = fgetc(file);
-    int third = fgetc(file);
+    reserve_list(graph, &state->send_buf, total_send > 0 ? (size_t)total_send : 1);
+    reserve_list(graph, &state->recv_buf, total_recv > 0 ? (size_t)total_recv : 1);
+    for (int r = 0; r < size; r++) {
+        int offset = state->send_displs[r];
+        for (int t = 0; t < state->num_threads; t++) {
+            NodeList *out = &state->threads[t].outbox[r];
+            memcpy(state->send_buf.data + offset, out->data, (size_t)out->size * sizeof(int));
+            offset += out->size;
+            out->size = 0;
+        }
+    }
+    INSTR_MPI(INSTR_MPI_ALLTOALLV, ((size_t)total_send + total_recv) * sizeof(int),
+              MPI_Alltoallv(state->send_buf.data, state->send_counts, state->send_displs, MPI_INT,
+                            state->recv_buf.data, state->recv_counts, state->recv_displs, MPI_INT, graph->comm));
+    shared_distances_sync(state->shared);
     
-    if (first == 0xEF && second == 0xBB && third == 0xBF) {
-    } else {
-        rewind(file);
+    #pragma omp parallel num_threads(state->num_threads) if(total_recv >= PARALLEL_SCAN_MIN)
+    {
+        DeltaThread *self = &state->threads[thread_id()];
+        INSTR_PHASE_BEGIN(apply_start);
+        #pragma omp for nowait
+        for (int k = 0; k < total_recv; k += 2) {
+            int v = state->recv_buf.data[k] - graph->first_node;
+            int new_dist = state->recv_buf.data[k + 1];
+            if (new_dist < 0) {
+                // Already lowered in shared memory by a co-located rank
+                new_dist = __atomic_load_n(&state->local_dist[v], __ATOMIC_RELAXED);
+                note_push(state, bucket_push(&self->buckets, new_dist / state->delta, v));
+            } else {
+                relax_owned(state, self, v, new_dist);
+            }
+        }
+        INSTR_PHASE_END(INSTR_RELAX, apply_start);
+    }
+}
+
+// Lowest non-empty bucket after bin across this rank's threads and all ranks
+static int next_bucket(DeltaState *state, int bin) {
+    check_pushes(state);
+    int next = INT_MAX;
+    for (int t = 0; t < state->num_threads; t++) {
+        int local_next = bucket_next_nonempty(&state->threads[t].buckets, bin);
+        if (local_next < next) {
+            next = local_next;
+        }
+    }
+    INSTR_MPI(INSTR_MPI_ALLREDUCE, 2 * sizeof(int),
+              MPI_Allreduce(MPI_IN_PLACE, &next, 1, MPI_INT, MPI_MIN, state->graph->comm));
+    return next;
+}
+
+// Distributed delta-stepping: all ranks work on the same global bucket.
+// Each light-edge round relaxes the local part of the bucket, exchanges the
+// batched remote requests with MPI_Alltoallv and repeats until no rank
+// refilled the bucket; heavy edges of the settled nodes are then relaxed
+// once. Global synchronizations drop from one per node to a few per bucket.
+// In the hybrid build each rank's frontier is split across its threads.
+void dijkstra_mpi_delta(const DistGraph *graph, const SharedDistances *shared, int source, int *local_dist, int delta) {
+    int size = graph->size;
+    int num_threads = graph->num_threads;
+    if (delta <= 0) {
+        delta = dist_graph_default_delta(graph);
     }
     
-    int num_nodes, num_edges;
-    fscanf(file, "%d %d", &num_nodes, &num_edges);
+    DeltaState state;
+    memset(&state, 0, sizeof(state));
+    state.graph = graph;
+    state.shared = shared;
+    state.local_dist = local_dist;
+    state.num_threads = num_threads;
+    state.delta = delta;
+    state.settled_bin = (int*)malloc((graph->local_nodes > 0 ? (size_t)graph->local_nodes : 1) * sizeof(int));
+    state.threads = (DeltaThread*)calloc((size_t)num_threads, sizeof(DeltaThread));
+    state.thread_sizes = (int*)malloc(((size_t)num_threads + 1) * sizeof(int));
+    state.send_counts = (int*)malloc((size_t)size * sizeof(int));
+    state.send_displs = (int*)malloc((size_t)size * sizeof(int));
+    state.recv_counts = (int*)malloc((size_t)size * sizeof(int));
+    state.recv_displs = (int*)malloc((size_t)size * sizeof(int));
+    bool ok = state.settled_bin && state.threads && state.thread_sizes && state.send_counts &&
+              state.send_displs && state.recv_counts && state.recv_displs;
+    for (int t = 0; ok && t < num_threads; t++) {
+        state.threads[t].outbox = (NodeList*)calloc((size_t)size, sizeof(NodeList));
+        ok = state.threads[t].outbox != NULL;
+    }
+    if (!ok) {
+        perror("Error allocating MPI state");
+        MPI_Abort(graph->comm, EXIT_FAILURE);
+    }
     
-    Graph *graph = create_graph(num_nodes, num_edges);
+    #pragma omp parallel for num_threads(num_threads)
+    for (int i = 0; i < graph->local_nodes; i++) {
+        local_dist[i] = INF;
+        state.settled_bin[i] = -1;
+    }
+    if (dist_graph_owns(graph, source)) {
+        relax_owned(&state, &state.threads[0], source - graph->first_node, 0);
+    }
+    shared_distances_sync(shared);
     
-    for (int i = 0; i < num_edges; i++) {
-        int u, v, weight;
-        fscanf(file, "%d %d %d", &u, &v, &weight);
-        add_edge(graph, u, v, weight);
+    int bin = next_bucket(&state, -1);
+    while (bin != INT_MAX) {
+        // Light phase: drain the bucket until no rank refills it
+        for (;;) {
+            INSTR_PHASE_BEGIN(gather_start);
+            gather_frontier(&state, bin);
+            INSTR_PHASE_END(INSTR_SELECT, gather_start);
+            #pragma omp parallel num_threads(num_threads) if(state.frontier.size >= 64)
+            {
+                DeltaThread *self = &state.threads[thread_id()];
+                INSTR_PHASE_BEGIN(light_start);
+                #pragma omp for schedule(dynamic, 64) nowait
+                for (int f = 0; f < state.frontier.size; f++) {
+                    int u = state.frontier.data[f];
+                    INSTR_COUNT(INSTR_QUEUE_POP, 1);
+                    if (__atomic_load_n(&local_dist[u], __ATOMIC_RELAXED) / delta != bin) {
+                        continue;    // stale entry, node moved to a lower bucket
+                    }
+                    if (__atomic_exchange_n(&state.settled_bin[u], bin, __ATOMIC_RELAXED) != bin) {
+                        note_push(&state, node_list_push(&self->settled, u));
+                    }
+                    INSTR_COUNT(INSTR_SETTLED, 1);
+                    relax_edges(&state, self, u, true);
+                }
+                INSTR_PHASE_END(INSTR_RELAX, light_start);
+            }
+            exchange_relaxations(&state);
+            
+            int refilled = 0;
+            for (int t = 0; t < num_threads; t++) {
+                BucketSet *buckets = &state.threads[t].buckets;
+                refilled |= (bin < buckets->num_bins && buckets->bins[bin].size > 0);
+            }
+            INSTR_MPI(INSTR_MPI_ALLREDUCE, 2 * sizeof(int),
+                      MPI_Allreduce(MPI_IN_PLACE, &refilled, 1, MPI_INT, MPI_LOR, graph->comm));
+            if (!refilled) {
+                break;
+            }
+        }
+        
+        // Heavy phase: distances in this bucket are final, relax heavy edges once
+        #pragma omp parallel num_threads(num_threads)
+        {
+            DeltaThread *self = &state.threads[thread_id()];
+            INSTR_PHASE_BEGIN(heavy_start);
+            for (int s = 0; s < self->settled.size; s++) {
+                relax_edges(&state, self, self->settled.data[s], false);
+            }
+            self->settled.size = 0;
+            INSTR_PHASE_END(INSTR_RELAX, heavy_start);
+        }
+        exchange_relaxations(&state);
+        
+        bin = next_bucket(&state, bin);
     }
     
-    fclose(file);
-    return graph;
+    for (int t = 0; t < num_threads; t++) {
+        for (int r = 0; r < size; r++) {
+            free(state.threads[t].outbox[r].data);
+        }
+        free(state.threads[t].outbox);
+        free(state.threads[t].settled.data);
+        bucket_set_free(&state.threads[t].buckets);
+    }
+    free(state.threads);
+    free(state.thread_sizes);
+    free(state.send_counts);
+    free(state.send_displs);
+    free(state.recv_counts);
+    free(state.recv_displs);
+    free(state.send_buf.data);
+    free(state.recv_buf.data);
+    free(state.frontier.data);
+    free(state.settled_bin);
+}
+
+static bool parse_mpi_mode(const char *name, MpiMode *mode) {
+    if (strcmp(name, "gather") == 0) {
+        *mode = MPI_MODE_GATHER;
+    } else if (strcmp(name, "sparse") == 0) {
+        *mode = MPI_MODE_SPARSE;
+    } else if (strcmp(name, "delta") == 0) {
+        *mode = MPI_MODE_DELTA;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static const char* mpi_mode_name(MpiMode mode) {
+    switch (mode) {
+        case MPI_MODE_SPARSE:
+            return "sparse";
+        case MPI_MODE_DELTA:
+            return "delta";
+        case MPI_MODE_GATHER:
+        default:
+            return "gather";
+    }
+}
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Usage: mpirun -np <num_processes> %s [--mode gather|sparse|delta] [--delta <width>] [--threads <per_rank>] [--shared] [--format text|binary|summary|quiet] [--output <file>] <input_file> <source_node>\n", prog);
+    fprintf(stderr, "Example: mpirun -np 4 %s --mode sparse weighted_graph.txt 0\n", prog);
 }
 
 int main(int argc, char *argv[]) {
+#ifdef _OPENMP
+    // Hybrid build: OpenMP threads inside each rank, MPI called only by the
+    // main thread outside parallel regions
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+#else
     MPI_Init(&argc, &argv);
+#endif
     
     int rank, size;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
     
-    if (argc != 3) {
+#ifdef _OPENMP
+    if (provided < MPI_THREAD_FUNNELED) {
         if (rank == 0) {
-            fprintf(stderr, "Usage: mpirun -np <num_processes> %s <input_file> <source_node>\n", argv[0]);
-            fprintf(stderr, "Example: mpirun -np 4 %s weighted_graph.txt 0\n", argv[0]);
+            fprintf(stderr, "Error: MPI library does not support MPI_THREAD_FUNNELED\n");
         }
         MPI_Finalize();
         return EXIT_FAILURE;
     }
+#endif
     
-    const char *filename = argv[1];
-    int source = atoi(argv[2]);
+    MpiMode mode = MPI_MODE_GATHER;
+    int delta = 0;
+    bool use_shared = false;
+    OutputFormat format = OUTPUT_TEXT;
+    const char *output_file = NULL;
+    int num_threads = 1;
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+#endif
     
-    Graph *graph = NULL;
-    if (rank == 0) {
-        graph = read_graph_from_file(filename);
-        if (!graph) {
-            MPI_Finalize();
-            return EXIT_FAILURE;
-        }
-        
-        if (source < 0 || source >= graph->num_nodes) {
-            fprintf(stderr, "Error: Source node must be between 0 and %d\n", graph->num_nodes - 1);
-            free_graph(graph);
-            MPI_Finalize();
-            return EXIT_FAILURE;
+    static const struct option long_options[] = {
+        {"mode", required_argument, NULL, 'm'},
+        {"delta", required_argument, NULL, 'd'},
+        {"threads", required_argument, NULL, 't'},
+        {"shared", no_argument, NULL, 's'},
+        {"format", required_argument, NULL, 'f'},
+        {"output", required_argument, NULL, 'o'},
+        {NULL, 0, NULL, 0}
+    };
+    
+    // Every rank parses the same arguments; only rank 0 reports errors
+    int opt;
+    opterr = (rank == 0);
+    while ((opt = getopt_long(argc, argv, "m:d:t:sf:o:", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'm':
+                if (!parse_mpi_mode(optarg, &mode)) {
+                    if (rank == 0) {
+                        fprintf(stderr, "Error: Unknown mode '%s'\n", optarg);
+                        print_usage(argv[0]);
+                    }
+                    MPI_Finalize();
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'd':
+                delta = atoi(optarg);
+                if (delta <= 0) {
+                    if (rank == 0) {
+                        fprintf(stderr, "Error: Delta must be positive\n");
+                    }
+                    MPI_Finalize();
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 's':
+                use_shared = true;
+                break;
+            case 'f':
+                if (!parse_output_format(optarg, &format)) {
+                    if (rank == 0) {
+                        fprintf(stderr, "Error: Unknown output format '%s'\n", optarg);
+                        print_usage(argv[0]);
+                    }
+                    MPI_Finalize();
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'o':
+                output_file = optarg;
+                break;
+            case 't':
+                num_threads = atoi(optarg);
+#ifdef _OPENMP
+                if (num_threads <= 0) {
+#else
+                if (num_threads != 1) {
+#endif
+                    if (rank == 0) {
+#ifdef _OPENMP
+                        fprintf(stderr, "Error: Number of threads must be positive\n");
+#else
+                        fprintf(stderr, "Error: This build is MPI-only; use dijkstra_mpi_hybrid for threads per rank\n");
+#endif
+                    }
+                    MPI_Finalize();
+                    return EXIT_FAILURE;
+                }
+                break;
+            default:
+                if (rank == 0) {
+                    print_usage(argv[0]);
+                }
+                MPI_Finalize();
+                return EXIT_FAILURE;
         }
     }
     
-    int num_nodes, num_edges;
-    if (rank == 0) {
-        num_nodes = graph->num_nodes;
-        num_edges = graph->num_edges;
+    if (argc - optind != 2) {
+        if (rank == 0) {
+            print_usage(argv[0]);
+        }
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+    if (delta > 0 && mode != MPI_MODE_DELTA) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: --delta only applies to --mode delta\n");
+        }
+        MPI_Finalize();
+        return EXIT_FAILURE;
     }
-    MPI_Bcast(&num_nodes, 1, MPI_INT, 0, MPI_COMM_WORLD);
-    MPI_Bcast(&num_edges, 1, MPI_INT, 0, MPI_COMM_WORLD);
     
-    if (rank != 0) {
-        graph = create_graph(num_nodes, num_edges);
+    const char *filename = argv[optind];
+    int source = atoi(argv[optind + 1]);
+#ifdef _OPENMP
+    omp_set_num_threads(num_threads);
+#endif
+    
+    // Every rank reads its own share of the file and keeps only its block of rows
+    double load_start = MPI_Wtime();
+    DistGraph *graph = dist_graph_read(filename, MPI_COMM_WORLD);
+    double load_time = MPI_Wtime() - load_start;
+    if (!graph) {
+        MPI_Finalize();
+        return EXIT_FAILURE;
     }
-
-    if (rank != 0) {
-        FILE *file = fopen(filename, "r");
-        if (file) {
-            int dummy_nodes, dummy_edges;
-            fscanf(file, "%d %d", &dummy_nodes, &dummy_edges);
-            for (int i = 0; i < num_edges; i++) {
-                int u, v, weight;
-                fscanf(file, "%d %d %d", &u, &v, &weight);
-                add_edge(graph, u, v, weight);
-            }
-            fclose(file);
+    
+    if (source < 0 || source >= graph->num_nodes) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: Source node must be between 0 and %d\n", graph->num_nodes - 1);
         }
+        free_dist_graph(graph);
+        MPI_Finalize();
+        return EXIT_FAILURE;
     }
+    // Reordered binary graphs: the engines start from the source's node id
+    int source_node = dist_graph_node(graph, source);
     
-    int *distances = (int*)malloc(num_nodes * sizeof(int));
+    // With --shared the distance blocks of co-located ranks live in one
+    // shared-memory segment per host
+    SharedDistances *shared = NULL;
+    int *local_dist;
+    if (use_shared) {
+        shared = shared_distances_create(graph);
+        if (!shared) {
+            free_dist_graph(graph);
+            MPI_Finalize();
+            return EXIT_FAILURE;
+        }
+        local_dist = shared->dist[shared->node_rank];
+    } else {
+        local_dist = (int*)malloc((graph->local_nodes > 0 ? (size_t)graph->local_nodes : 1) * sizeof(int));
+    }
     
+    INSTR_RESET();
     double start = MPI_Wtime();
-    dijkstra_mpi(graph, source, distances, rank, size);
+    if (mode == MPI_MODE_DELTA && delta <= 0) {
+        delta = dist_graph_default_delta(graph);
+    }
+    if (mode == MPI_MODE_SPARSE) {
+        dijkstra_mpi_sparse(graph, shared, source_node, local_dist);
+    } else if (mode == MPI_MODE_DELTA) {
+        dijkstra_mpi_delta(graph, shared, source_node, local_dist, delta);
+    } else {
+        dijkstra_mpi(graph, shared, source_node, local_dist);
+    }
     double end = MPI_Wtime();
     
+#ifdef SSSP_INSTRUMENT
+    // Every rank's per-thread slots, reported by rank 0 after the timings
+    InstrSlot *rank_slots = NULL;
+    if (rank == 0) {
+        rank_slots = (InstrSlot*)malloc((size_t)size * sizeof(instr_slots));
+        if (!rank_slots) {
+            perror("Error allocating instrumentation report");
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+    }
+    MPI_Gather(instr_slots, (int)sizeof(instr_slots), MPI_BYTE,
+               rank_slots, (int)sizeof(instr_slots), MPI_BYTE, 0, MPI_COMM_WORLD);
+#endif
+    
     double execution_time = end - start;
     double max_time;
     MPI_Reduce(&execution_time, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    double max_load_time;
+    MPI_Reduce(&load_time, &max_load_time, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    
+    // Hosts = number of node-local leaders
+    int num_hosts = 0;
+    if (shared) {
+        int leader = (shared->node_rank == 0);
+        MPI_Reduce(&leader, &num_hosts, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+    }
     
+    int *distances = NULL;
     if (rank == 0) {
-        printf("Shortest distances from node %d:\n", source);
-        for (int i = 0; i < graph->num_nodes; i++) {
-            if (distances[i] == INF) {
-                printf("Node %d: INF\n", i);
-            } else {
-                printf("Node %d: %d\n", i, distances[i]);
-            }
+        distances = (int*)malloc((size_t)graph->num_nodes * sizeof(int));
+    }
+    dist_graph_gather_distances(graph, local_dist, distances, 0);
+    
+    // Only rank 0 holds the gathered array and writes it
+    int status = 0;
+    if (rank == 0) {
+        double output_start = MPI_Wtime();
+        status = restore_input_order(distances, graph->original_id, graph->num_nodes, graph->num_threads);
+        status = status == 0 ? write_distances(distances, graph->num_nodes, source, format, output_file, graph->num_threads) : -1;
+        double output_time = MPI_Wtime() - output_start;
+        
+        char layout[64];
+        if (graph->num_threads > 1) {
+            snprintf(layout, sizeof(layout), "%d processes x %d threads", size, graph->num_threads);
+        } else {
+            snprintf(layout, sizeof(layout), "%d processes", size);
         }
-        printf("\nMPI execution time (%d processes): %.6f seconds\n", size, max_time);
+        if (shared) {
+            size_t used = strlen(layout);
+            snprintf(layout + used, sizeof(layout) - used, ", shared on %d hosts", num_hosts);
+        }
+        if (mode == MPI_MODE_DELTA) {
+            printf("\nMPI execution time (%s, %s, delta=%d): %.6f seconds\n",
+                   layout, mpi_mode_name(mode), delta, max_time);
+        } else {
+            printf("\nMPI execution time (%s, %s): %.6f seconds\n", layout, mpi_mode_name(mode), max_time);
+        }
+        printf("Graph load time: %.6f seconds\n", max_load_time);
+        printf("Output time (%s): %.6f seconds\n", output_format_name(format), output_time);
+#ifdef SSSP_INSTRUMENT
+        for (int r = 0; r < size; r++) {
+            char label[32];
+            snprintf(label, sizeof(label), "rank %d", r);
+            instr_report(stdout, label, rank_slots + (size_t)r * INSTR_MAX_THREADS);
+        }
+        free(rank_slots);
+#endif
     }
+    MPI_Bcast(&status, 1, MPI_INT, 0, MPI_COMM_WORLD);
     
     free(distances);
-    free_graph(graph);
+    if (shared) {
+        shared_distances_free(shared);
+    } else {
+        free(local_dist);
+    }
+    free_dist_graph(graph);
     
     MPI_Finalize();
-    return EXIT_SUCCESS;
+    return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
@@ -1,288 +1,250 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
-#include <limits.h>
 #include <stdbool.h>
 #include <time.h>
+#include <getopt.h>
 #include <omp.h>
+#include "sssp.h"
+#include "instrument.h"
+#include "affinity.h"
 
-#define INF INT_MAX
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--engine dijkstra|persistent|delta] [--delta <width>] [--format text|binary|summary|quiet] [--output <file>] [--bind none|close|spread] [--numa] [--reorder input|rcm|bfs|degree] <input_file> <source_node> <num_threads>\n", prog);
+    fprintf(stderr, "       %s [--engine auto|scan|heap|dial|radix] [--format text|summary|quiet] [--output <file>] [--bind none|close|spread] [--numa] [--reorder ...] --sources <file> | --source-range <first>:<last> <input_file> <num_threads>\n", prog);
+    fprintf(stderr, "--numa re-places the graph with parallel first-touch from pinned threads (--bind spread unless given)\n");
+    fprintf(stderr, "--reorder renumbers the nodes for locality after loading; node ids in the arguments and output stay input ids\n");
+    fprintf(stderr, "Example: %s --engine delta weighted_graph.txt 0 4\n", prog);
+}
 
-typedef struct {
-    int dest;
-    int weight;
-} Edge;
+// Renumber the nodes in *order (NULL: keep the file's numbering)
+static bool reorder_nodes(Graph *graph, const VertexOrder *order, int num_threads, double *reorder_time) {
+    *reorder_time = 0.0;
+    if (!order) {
+        return true;
+    }
+    double start = omp_get_wtime();
+    bool ok = reorder_graph(graph, *order, num_threads) == 0;
+    *reorder_time = omp_get_wtime() - start;
+    return ok;
+}
 
-typedef struct {
-    int num_nodes;
-    int num_edges;
-    Edge **adj_list;  
-    int *adj_size;    
-} Graph;
+// Copy the graph arrays from the (pinned) worker threads so their pages
+// land on the NUMA nodes of the threads that scan them
+static bool place_graph(Graph *graph, bool first_touch, int num_threads, double *place_time) {
+    *place_time = 0.0;
+    if (!first_touch) {
+        return true;
+    }
+    double start = omp_get_wtime();
+    bool ok = graph_first_touch(graph, num_threads) == 0;
+    *place_time = omp_get_wtime() - start;
+    return ok;
+}
 
-Graph* create_graph(int num_nodes, int num_edges) {
-    Graph *graph = (Graph*)malloc(sizeof(Graph));
-    graph->num_nodes = num_nodes;
-    graph->num_edges = num_edges;
-    graph->adj_list = (Edge**)malloc(num_nodes * sizeof(Edge*));
-    graph->adj_size = (int*)calloc(num_nodes, sizeof(int));
-    
-    for (int i = 0; i < num_nodes; i++) {
-        graph->adj_list[i] = (Edge*)malloc(sizeof(Edge));
+static void print_load_times(const Graph *graph, const VertexOrder *order, double load_time, double reorder_time) {
+    printf("Graph load time: %.6f seconds\n", load_time);
+    if (order) {
+        printf("Reorder time (%s): %.6f seconds\n", vertex_order_name(graph->order), reorder_time);
     }
-    
-    return graph;
 }
 
-void add_edge(Graph *graph, int u, int v, int weight) {
-    if (u < 0 || u >= graph->num_nodes || v < 0 || v >= graph->num_nodes) {
-        fprintf(stderr, "Error: Invalid edge (%d, %d) - nodes must be between 0 and %d\n", 
-                u, v, graph->num_nodes - 1);
+// Thread CPUs and the NUMA nodes holding the adjacency (and distances, if given)
+static void report_placement(const Graph *graph, const int *distances, ThreadBinding binding, bool first_touch,
+                             double place_time, int num_threads) {
+    if (binding == BIND_NONE && !first_touch) {
         return;
     }
-    
-    int u_size = graph->adj_size[u];
-    int v_size = graph->adj_size[v];
-    
-    graph->adj_list[u] = (Edge*)realloc(graph->adj_list[u], (u_size + 1) * sizeof(Edge));
-    if (!graph->adj_list[u]) {
-        perror("Error reallocating memory");
-        return;
+    if (first_touch) {
+        printf("NUMA first-touch time: %.6f seconds\n", place_time);
     }
-    graph->adj_list[u][u_size].dest = v;
-    graph->adj_list[u][u_size].weight = weight;
-    graph->adj_size[u]++;
-    
-    graph->adj_list[v] = (Edge*)realloc(graph->adj_list[v], (v_size + 1) * sizeof(Edge));
-    if (!graph->adj_list[v]) {
-        perror("Error reallocating memory");
-        return;
+    print_thread_placement(stdout, binding, num_threads);
+    size_t num_entries = (size_t)graph->offsets[graph->num_nodes];
+    print_memory_placement(stdout, "adjacency", graph->dest, num_entries * sizeof(int));
+    if (distances) {
+        print_memory_placement(stdout, "distances", distances, (size_t)graph->num_nodes * sizeof(int));
     }
-    graph->adj_list[v][v_size].dest = u;
-    graph->adj_list[v][v_size].weight = weight;
-    graph->adj_size[v]++;
 }
 
-void free_graph(Graph *graph) {
-    for (int i = 0; i < graph->num_nodes; i++) {
-        free(graph->adj_list[i]);
+// Load the graph once and answer the listed sources in parallel, one
+// source per thread at a time with a sequential engine
+static int run_batch(const char *filename, const char *engine_name, const char *source_file,
+                     const char *source_range, int num_threads, OutputFormat format, const char *output_file,
+                     ThreadBinding binding, bool first_touch, const VertexOrder *order) {
+    if (format == OUTPUT_BINARY) {
+        fprintf(stderr, "Error: Binary output holds a single source and is not supported for batches\n");
+        return EXIT_FAILURE;
     }
-    free(graph->adj_list);
-    free(graph->adj_size);
-    free(graph);
-}
-
-// Parallel Dijkstra's algorithm using OpenMP
-void dijkstra_parallel(Graph *graph, int source, int *distances, int num_threads) {
-    bool *visited = (bool*)calloc(graph->num_nodes, sizeof(bool));
-    
-    #pragma omp parallel for num_threads(num_threads)
-    for (int i = 0; i < graph->num_nodes; i++) {
-        distances[i] = INF;
+    SequentialEngine engine = ENGINE_AUTO;
+    if (engine_name && !parse_sequential_engine(engine_name, &engine)) {
+        fprintf(stderr, "Error: Unknown batch engine '%s' (use auto, scan, heap, dial or radix)\n", engine_name);
+        return EXIT_FAILURE;
     }
-    distances[source] = 0;
     
-    for (int count = 0; count < graph->num_nodes; count++) {
-        int min_dist = INF;
-        int min_node = -1;
-        
-        #pragma omp parallel for num_threads(num_threads) reduction(min:min_dist)
-        for (int v = 0; v < graph->num_nodes; v++) {
-            if (!visited[v] && distances[v] < min_dist) {
-                min_dist = distances[v];
-            }
-        }
-        
-        if (min_dist == INF) {
-            break;
-        }
-        
-        for (int v = 0; v < graph->num_nodes; v++) {
-            if (!visited[v] && distances[v] == min_dist) {
-                min_node = v;
-                break;
-            }
-        }
-        
-        if (min_node == -1) {
-            break;
-        }
-        
-        visited[min_node] = true;
-        
-        int adj_size = graph->adj_size[min_node];
-        #pragma omp parallel for num_threads(num_threads)
-        for (int i = 0; i < adj_size; i++) {
-            int neighbor = graph->adj_list[min_node][i].dest;
-            int weight = graph->adj_list[min_node][i].weight;
-            
-            if (!visited[neighbor] && distances[min_node] != INF) {
-                int new_dist = distances[min_node] + weight;
-                #pragma omp critical
-                {
-                    if (new_dist < distances[neighbor]) {
-                        distances[neighbor] = new_dist;
-                    }
-                }
-            }
-        }
+    int count = 0;
+    int *sources = source_file ? read_source_list(source_file, &count) : parse_source_range(source_range, &count);
+    if (!sources) {
+        return EXIT_FAILURE;
     }
     
-    free(visited);
-}
-
-void dijkstra_parallel_optimized(Graph *graph, int source, int *distances, int num_threads) {
-    bool *visited = (bool*)calloc(graph->num_nodes, sizeof(bool));
+    double load_start = omp_get_wtime();
+    Graph *graph = read_graph_from_file(filename);
+    double load_time = omp_get_wtime() - load_start;
+    double reorder_time, place_time;
+    if (!graph || !check_sources(sources, count, graph->num_nodes) ||
+        !reorder_nodes(graph, order, num_threads, &reorder_time) ||
+        !place_graph(graph, first_touch, num_threads, &place_time)) {
+        free_graph(graph);
+        free(sources);
+        return EXIT_FAILURE;
+    }
     
-    #pragma omp parallel for num_threads(num_threads)
-    for (int i = 0; i < graph->num_nodes; i++) {
-        distances[i] = INF;
+    FILE *out = open_output_stream(output_file);
+    if (!out) {
+        free_graph(graph);
+        free(sources);
+        return EXIT_FAILURE;
     }
-    distances[source] = 0;
     
-    for (int count = 0; count < graph->num_nodes; count++) {
-        int min_dist = INF;
-        int min_node = -1;
-        
-        #pragma omp parallel num_threads(num_threads)
-        {
-            int local_min_dist = INF;
-            int local_min_node = -1;
-            
-            #pragma omp for nowait
-            for (int v = 0; v < graph->num_nodes; v++) {
-                if (!visited[v] && distances[v] < local_min_dist) {
-                    local_min_dist = distances[v];
-                    local_min_node = v;
-                }
-            }
-            
-            #pragma omp critical
-            {
-                if (local_min_dist < min_dist) {
-                    min_dist = local_min_dist;
-                    min_node = local_min_node;
-                }
-            }
-        }
-        
-        if (min_dist == INF || min_node == -1) {
-            break;
-        }
-        
-        visited[min_node] = true;
-        
-        int adj_size = graph->adj_size[min_node];
-        int base_dist = distances[min_node];
-        
-        if (adj_size > 0 && graph->adj_list[min_node] != NULL) {
-            #pragma omp parallel for num_threads(num_threads)
-            for (int i = 0; i < adj_size; i++) {
-                int neighbor = graph->adj_list[min_node][i].dest;
-                int weight = graph->adj_list[min_node][i].weight;
-                
-                if (neighbor >= 0 && neighbor < graph->num_nodes && !visited[neighbor] && base_dist != INF) {
-                    int new_dist = base_dist + weight;
-                    #pragma omp critical
-                    {
-                        if (new_dist < distances[neighbor]) {
-                            distances[neighbor] = new_dist;
-                        }
-                    }
-                }
-            }
-        }
+    engine = resolve_sequential_engine(engine, graph);
+    INSTR_RESET();
+    double elapsed = run_sssp_batch(graph, engine, sources, count, num_threads, out, format, NULL);
+    if (close_output_stream(out, output_file) != 0) {
+        elapsed = -1;
+    }
+    if (elapsed >= 0) {
+        printf("Batch execution time (%d queries, %d threads, %s): %.6f seconds (%.1f queries/sec)\n",
+               count, num_threads, sequential_engine_name(engine), elapsed, count / elapsed);
+        print_load_times(graph, order, load_time, reorder_time);
+        report_placement(graph, NULL, binding, first_touch, place_time, num_threads);
+        INSTR_REPORT(stdout, "batch");
     }
     
-    free(visited);
+    free_graph(graph);
+    free(sources);
+    return elapsed >= 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
-Graph* read_graph_from_file(const char *filename) {
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        fprintf(stderr, "Error: Cannot open file '%s'\n", filename);
-        perror("fopen");
-        return NULL;
-    }
-    
-    int first = fgetc(file);
-    int second = fgetc(file);
-    int third = fgetc(file);
+int main(int argc, char *argv[]) {
+    ParallelEngine engine = PARALLEL_ENGINE_DIJKSTRA;
+    int delta = 0;
+    const char *engine_name = NULL;
+    const char *source_file = NULL;
+    const char *source_range = NULL;
+    OutputFormat format = OUTPUT_TEXT;
+    const char *output_file = NULL;
+    ThreadBinding binding = BIND_NONE;
+    bool binding_given = false;
+    bool first_touch = false;
+    VertexOrder reorder;
+    const VertexOrder *order = NULL;
     
-    if (first == 0xEF && second == 0xBB && third == 0xBF) {
-    } else {
-        rewind(file);
-    }
+    static const struct option long_options[] = {
+        {"engine", required_argument, NULL, 'e'},
+        {"delta", required_argument, NULL, 'd'},
+        {"sources", required_argument, NULL, 'S'},
+        {"source-range", required_argument, NULL, 'R'},
+        {"format", required_argument, NULL, 'f'},
+        {"output", required_argument, NULL, 'o'},
+        {"bind", required_argument, NULL, 'b'},
+        {"numa", no_argument, NULL, 'N'},
+        {"reorder", required_argument, NULL, 'r'},
+        {NULL, 0, NULL, 0}
+    };
     
-    int num_nodes, num_edges;
-    int result = fscanf(file, "%d %d", &num_nodes, &num_edges);
-    if (result != 2) {
-        rewind(file);
-        char first_line[256];
-        if (fgets(first_line, sizeof(first_line), file)) {
-            fprintf(stderr, "Error: Failed to parse graph header from '%s'\n", filename);
-            fprintf(stderr, "First line (as read): '");
-            for (size_t i = 0; i < strlen(first_line) && i < 50; i++) {
-                unsigned char c = (unsigned char)first_line[i];
-                if (c >= 32 && c < 127) {
-                    fprintf(stderr, "%c", c);
-                } else if (c == '\n') {
-                    fprintf(stderr, "\\n");
-                } else if (c == '\r') {
-                    fprintf(stderr, "\\r");
-                } else if (c == '\t') {
-                    fprintf(stderr, "\\t");
-                } else {
-                    fprintf(stderr, "\\x%02x", c);
+    int opt;
+    while ((opt = getopt_long(argc, argv, "e:d:S:R:f:o:b:Nr:", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'e':
+                engine_name = optarg;
+                break;
+            case 'd':
+                delta = atoi(optarg);
+                if (delta <= 0) {
+                    fprintf(stderr, "Error: Delta must be positive\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'S':
+                source_file = optarg;
+                break;
+            case 'R':
+                source_range = optarg;
+                break;
+            case 'f':
+                if (!parse_output_format(optarg, &format)) {
+                    fprintf(stderr, "Error: Unknown output format '%s'\n", optarg);
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
                 }
-            }
-            fprintf(stderr, "'\n");
-            fprintf(stderr, "Expected format: '<num_nodes> <num_edges>' (two integers)\n");
-            fprintf(stderr, "fscanf returned %d (expected 2)\n", result);
-        } else {
-            fprintf(stderr, "Error: Failed to read first line from '%s'\n", filename);
+                break;
+            case 'o':
+                output_file = optarg;
+                break;
+            case 'b':
+                if (!parse_thread_binding(optarg, &binding)) {
+                    fprintf(stderr, "Error: Unknown binding '%s' (use none, close or spread)\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                binding_given = true;
+                break;
+            case 'N':
+                first_touch = true;
+                break;
+            case 'r':
+                if (!parse_vertex_order(optarg, &reorder)) {
+                    fprintf(stderr, "Error: Unknown vertex order '%s'\n", optarg);
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                order = &reorder;
+                break;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
         }
-        fclose(file);
-        return NULL;
     }
     
-    if (num_nodes <= 0 || num_edges < 0) {
-        fprintf(stderr, "Error: Invalid graph size: %d nodes, %d edges\n", num_nodes, num_edges);
-        fclose(file);
-        return NULL;
+    // First-touch placement only pays off with threads that stay on their node
+    if (first_touch && !binding_given) {
+        binding = BIND_SPREAD;
     }
     
-    Graph *graph = create_graph(num_nodes, num_edges);
-    if (!graph) {
-        fclose(file);
-        return NULL;
+    // Batch mode: one graph load, many sources, parallel across sources
+    if (source_file || source_range) {
+        if (argc - optind != 2 || (source_file && source_range) || delta > 0) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        int num_threads = atoi(argv[optind + 1]);
+        if (num_threads <= 0) {
+            fprintf(stderr, "Error: Number of threads must be positive\n");
+            return EXIT_FAILURE;
+        }
+        if (!bind_threads(binding, num_threads)) {
+            return EXIT_FAILURE;
+        }
+        return run_batch(argv[optind], engine_name, source_file, source_range, num_threads, format, output_file,
+                         binding, first_touch, order);
     }
     
-    for (int i = 0; i < num_edges; i++) {
-        int u, v, weight;
-        if (fscanf(file, "%d %d %d", &u, &v, &weight) != 3) {
-            fprintf(stderr, "Error: Failed to read edge %d\n", i);
-            free_graph(graph);
-            fclose(file);
-            return NULL;
-        }
-        add_edge(graph, u, v, weight);
+    if (engine_name && !parse_parallel_engine(engine_name, &engine)) {
+        fprintf(stderr, "Error: Unknown engine '%s'\n", engine_name);
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (delta > 0 && engine != PARALLEL_ENGINE_DELTA) {
+        fprintf(stderr, "Error: --delta only applies to --engine delta\n");
+        return EXIT_FAILURE;
     }
     
-    fclose(file);
-    return graph;
-}
-
-int main(int argc, char *argv[]) {
-    if (argc != 4) {
-        fprintf(stderr, "Usage: %s <input_file> <source_node> <num_threads>\n", argv[0]);
-        fprintf(stderr, "Example: %s weighted_graph.txt 0 4\n", argv[0]);
+    if (argc - optind != 3) {
+        print_usage(argv[0]);
         return EXIT_FAILURE;
     }
     
-    const char *filename = argv[1];
-    int source = atoi(argv[2]);
-    int num_threads = atoi(argv[3]);
+    const char *filename = argv[optind];
+    int source = atoi(argv[optind + 1]);
+    int num_threads = atoi(argv[optind + 2]);
     
     if (num_threads <= 0) {
         fprintf(stderr, "Error: Number of threads must be positive\n");
@@ -290,9 +252,18 @@ int main(int argc, char *argv[]) {
     }
     
     omp_set_num_threads(num_threads);
+    // Pin before loading so every later first touch happens on the final CPUs
+    if (!bind_threads(binding, num_threads)) {
+        return EXIT_FAILURE;
+    }
     
+    double load_start = omp_get_wtime();
     Graph *graph = read_graph_from_file(filename);
-    if (!graph) {
+    double load_time = omp_get_wtime() - load_start;
+    double reorder_time, place_time;
+    if (!graph || !reorder_nodes(graph, order, num_threads, &reorder_time) ||
+        !place_graph(graph, first_touch, num_threads, &place_time)) {
+        free_graph(graph);
         return EXIT_FAILURE;
     }
     
@@ -303,27 +274,46 @@ int main(int argc, char *argv[]) {
     }
     
     int *distances = (int*)malloc(graph->num_nodes * sizeof(int));
+    if (!distances) {
+        perror("Error allocating distances");
+        free_graph(graph);
+        return EXIT_FAILURE;
+    }
     
+    INSTR_RESET();
     double start = omp_get_wtime();
-    dijkstra_parallel_optimized(graph, source, distances, num_threads);
+    if (engine == PARALLEL_ENGINE_DELTA && delta <= 0) {
+        delta = default_delta(graph);
+    }
+    if (run_parallel_engine(engine, graph, graph_node(graph, source), distances, num_threads, delta) != 0) {
+        free(distances);
+        free_graph(graph);
+        return EXIT_FAILURE;
+    }
     double end = omp_get_wtime();
     
     double execution_time = end - start;
     
-    printf("Shortest distances from node %d:\n", source);
-    for (int i = 0; i < graph->num_nodes; i++) {
-        if (distances[i] == INF) {
-            printf("Node %d: INF\n", i);
-        } else {
-            printf("Node %d: %d\n", i, distances[i]);
-        }
-    }
+    double output_start = omp_get_wtime();
+    int status = restore_input_order(distances, graph->original_id, graph->num_nodes, num_threads);
+    status = status == 0 ? write_distances(distances, graph->num_nodes, source, format, output_file, num_threads) : -1;
+    double output_time = omp_get_wtime() - output_start;
     
-    printf("\nParallel execution time (%d threads): %.6f seconds\n", num_threads, execution_time);
+    if (engine == PARALLEL_ENGINE_DELTA) {
+        printf("\nParallel execution time (%d threads, %s, delta=%d): %.6f seconds\n",
+               num_threads, parallel_engine_name(engine), delta, execution_time);
+    } else {
+        printf("\nParallel execution time (%d threads, %s): %.6f seconds\n",
+               num_threads, parallel_engine_name(engine), execution_time);
+    }
+    print_load_times(graph, order, load_time, reorder_time);
+    printf("Output time (%s): %.6f seconds\n", output_format_name(format), output_time);
+    report_placement(graph, distances, binding, first_touch, place_time, num_threads);
+    INSTR_REPORT(stdout, parallel_engine_name(engine));
     
     free(distances);
     free_graph(graph);
     
-    return EXIT_SUCCESS;
+    return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
@@ -1,149 +1,302 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <limits.h>
 #include <stdbool.h>
 #include <time.h>
+#include <getopt.h>
+#include <omp.h>
+#include "sssp.h"
+#include "instrument.h"
 
-#define INF INT_MAX
-
-typedef struct {
-    int dest;
-    int weight;
-} Edge;
-
-typedef struct {
-    int num_nodes;
-    int num_edges;
-    Edge **adj_list;  
-    int *adj_size;    
-} Graph;
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--engine auto|scan|heap|dial|radix] [--format text|binary|summary|quiet] [--output <file>] [--reorder input|rcm|bfs|degree] <input_file> <source_node>\n", prog);
+    fprintf(stderr, "       %s [--engine ... | --bidirectional | --landmarks <file> | --hierarchy <file>] <input_file> <source_node> <target_node>\n", prog);
+    fprintf(stderr, "       %s [--engine ...] [--format text|summary|quiet] [--output <file>] --sources <file> | --source-range <first>:<last> <input_file>\n", prog);
+    fprintf(stderr, "--reorder renumbers the nodes for locality after loading; node ids on the command line and in the output stay input ids\n");
+    fprintf(stderr, "Example: %s --engine heap weighted_graph.txt 0\n", prog);
+}
 
-Graph* create_graph(int num_nodes, int num_edges) {
-    Graph *graph = (Graph*)malloc(sizeof(Graph));
-    graph->num_nodes = num_nodes;
-    graph->num_edges = num_edges;
-    graph->adj_list = (Edge**)malloc(num_nodes * sizeof(Edge*));
-    graph->adj_size = (int*)calloc(num_nodes, sizeof(int));
-    
-    for (int i = 0; i < num_nodes; i++) {
-        graph->adj_list[i] = (Edge*)malloc(sizeof(Edge));
+// Read the graph and renumber its nodes in *order (NULL: keep the file's
+// numbering); reports and returns NULL on error
+static Graph* load_graph(const char *filename, const VertexOrder *order, double *load_time, double *reorder_time) {
+    double start = omp_get_wtime();
+    Graph *graph = read_graph_from_file(filename);
+    *load_time = omp_get_wtime() - start;
+    *reorder_time = 0.0;
+    if (graph && order) {
+        start = omp_get_wtime();
+        if (reorder_graph(graph, *order, 0) != 0) {
+            free_graph(graph);
+            return NULL;
+        }
+        *reorder_time = omp_get_wtime() - start;
     }
-    
     return graph;
 }
 
-void add_edge(Graph *graph, int u, int v, int weight) {
-    int u_size = graph->adj_size[u];
-    int v_size = graph->adj_size[v];
-    
-    graph->adj_list[u] = (Edge*)realloc(graph->adj_list[u], (u_size + 1) * sizeof(Edge));
-    graph->adj_list[u][u_size].dest = v;
-    graph->adj_list[u][u_size].weight = weight;
-    graph->adj_size[u]++;
-    
-    graph->adj_list[v] = (Edge*)realloc(graph->adj_list[v], (v_size + 1) * sizeof(Edge));
-    graph->adj_list[v][v_size].dest = u;
-    graph->adj_list[v][v_size].weight = weight;
-    graph->adj_size[v]++;
-}
-
-void free_graph(Graph *graph) {
-    for (int i = 0; i < graph->num_nodes; i++) {
-        free(graph->adj_list[i]);
+static void print_load_times(const Graph *graph, const VertexOrder *order, double load_time, double reorder_time) {
+    printf("Graph load time: %.6f seconds\n", load_time);
+    if (order) {
+        printf("Reorder time (%s): %.6f seconds\n", vertex_order_name(graph->order), reorder_time);
     }
-    free(graph->adj_list);
-    free(graph->adj_size);
-    free(graph);
 }
 
-// Sequential Dijkstra's algorithm
-void dijkstra_sequential(Graph *graph, int source, int *distances) {
-    bool *visited = (bool*)calloc(graph->num_nodes, sizeof(bool));
-    
-    for (int i = 0; i < graph->num_nodes; i++) {
-        distances[i] = INF;
-    }
-    distances[source] = 0;
-    
-    for (int count = 0; count < graph->num_nodes; count++) {
-        int min_dist = INF;
-        int min_node = -1;
-        
-        for (int v = 0; v < graph->num_nodes; v++) {
-            if (!visited[v] && distances[v] < min_dist) {
-                min_dist = distances[v];
-                min_node = v;
-            }
-        }
-        
-        if (min_node == -1) {
-            break;
-        }
-        
-        visited[min_node] = true;
-        
-        for (int i = 0; i < graph->adj_size[min_node]; i++) {
-            int neighbor = graph->adj_list[min_node][i].dest;
-            int weight = graph->adj_list[min_node][i].weight;
-            
-            if (!visited[neighbor] && distances[min_node] != INF) {
-                int new_dist = distances[min_node] + weight;
-                if (new_dist < distances[neighbor]) {
-                    distances[neighbor] = new_dist;
-                }
-            }
-        }
+// Load the graph once and answer every listed source on a single worker
+static int run_batch(const char *filename, const VertexOrder *order, SequentialEngine engine, const char *source_file,
+                     const char *source_range, OutputFormat format, const char *output_file) {
+    if (format == OUTPUT_BINARY) {
+        fprintf(stderr, "Error: Binary output holds a single source and is not supported for batches\n");
+        return EXIT_FAILURE;
+    }
+    int count = 0;
+    int *sources = source_file ? read_source_list(source_file, &count) : parse_source_range(source_range, &count);
+    if (!sources) {
+        return EXIT_FAILURE;
+    }
+    
+    double load_time, reorder_time;
+    Graph *graph = load_graph(filename, order, &load_time, &reorder_time);
+    if (!graph || !check_sources(sources, count, graph->num_nodes)) {
+        free_graph(graph);
+        free(sources);
+        return EXIT_FAILURE;
     }
     
-    free(visited);
+    FILE *out = open_output_stream(output_file);
+    if (!out) {
+        free_graph(graph);
+        free(sources);
+        return EXIT_FAILURE;
+    }
+    
+    engine = resolve_sequential_engine(engine, graph);
+    INSTR_RESET();
+    double elapsed = run_sssp_batch(graph, engine, sources, count, 1, out, format, NULL);
+    if (close_output_stream(out, output_file) != 0) {
+        elapsed = -1;
+    }
+    if (elapsed >= 0) {
+        printf("Batch execution time (%d queries, %s): %.6f seconds (%.1f queries/sec)\n",
+               count, sequential_engine_name(engine), elapsed, count / elapsed);
+        print_load_times(graph, order, load_time, reorder_time);
+        INSTR_REPORT(stdout, "batch");
+    }
+    
+    free_graph(graph);
+    free(sources);
+    return elapsed >= 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
-Graph* read_graph_from_file(const char *filename) {
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        perror("Error opening file");
-        return NULL;
+// Distance between two nodes; the search stops as soon as the target is settled
+// With a landmark file the query runs A* (ALT) on its lower bounds, with a
+// contraction hierarchy file an upward search on its shortcuts
+static int run_point_to_point(const char *filename, const VertexOrder *order, SequentialEngine engine, bool bidirectional,
+                              const char *landmark_file, const char *hierarchy_file, int source, int target) {
+    double load_time, reorder_time;
+    Graph *graph = load_graph(filename, order, &load_time, &reorder_time);
+    if (!graph) {
+        return EXIT_FAILURE;
     }
     
-    int first = fgetc(file);
-    int second = fgetc(file);
-    int third = fgetc(file);
-    
-    if (first == 0xEF && second == 0xBB && third == 0xBF) {
-    } else {
-        rewind(file);
+    if (source < 0 || source >= graph->num_nodes || target < 0 || target >= graph->num_nodes) {
+        fprintf(stderr, "Error: Source and target nodes must be between 0 and %d\n", graph->num_nodes - 1);
+        free_graph(graph);
+        return EXIT_FAILURE;
     }
     
-    int num_nodes, num_edges;
-    fscanf(file, "%d %d", &num_nodes, &num_edges);
+    LandmarkTable *landmarks = NULL;
+    AltWorkspace *alt = NULL;
+    if (landmark_file) {
+        landmarks = read_landmarks_binary(landmark_file, graph);
+        alt = landmarks ? alt_workspace_create(graph, landmarks) : NULL;
+        if (!alt) {
+            free_landmarks(landmarks);
+            free_graph(graph);
+            return EXIT_FAILURE;
+        }
+    }
+    ContractionHierarchy *hierarchy = NULL;
+    ChWorkspace *ch = NULL;
+    if (hierarchy_file) {
+        hierarchy = read_hierarchy_binary(hierarchy_file, graph);
+        ch = hierarchy ? ch_workspace_create(hierarchy) : NULL;
+        if (!ch) {
+            free_hierarchy(hierarchy);
+            free_graph(graph);
+            return EXIT_FAILURE;
+        }
+    }
     
-    Graph *graph = create_graph(num_nodes, num_edges);
+    engine = resolve_sequential_engine(engine, graph);
+    if (!alt && !ch && !bidirectional && !check_sequential_engine(engine, graph)) {
+        free_graph(graph);
+        return EXIT_FAILURE;
+    }
+    int from = graph_node(graph, source);
+    int to = graph_node(graph, target);
+    int settled = 0;
+    INSTR_RESET();
+    double start = omp_get_wtime();
+    int distance;
+    const char *method;
+    if (alt) {
+        distance = alt_query(alt, from, to, &settled);
+        method = "ALT";
+    } else if (ch) {
+        distance = ch_query(ch, from, to, &settled);
+        method = "contraction hierarchy";
+    } else if (bidirectional) {
+        distance = dijkstra_bidirectional(graph, from, to, &settled);
+        method = "bidirectional";
+    } else {
+        distance = dijkstra_point_to_point(engine, graph, from, to, &settled);
+        method = sequential_engine_name(engine);
+    }
+    double elapsed = omp_get_wtime() - start;
     
-    for (int i = 0; i < num_edges; i++) {
-        int u, v, weight;
-        fscanf(file, "%d %d %d", &u, &v, &weight);
-        add_edge(graph, u, v, weight);
+    if (distance < 0) {
+        alt_workspace_free(alt);
+        free_landmarks(landmarks);
+        ch_workspace_free(ch);
+        free_hierarchy(hierarchy);
+        free_graph(graph);
+        return EXIT_FAILURE;
+    }
+    if (distance == INF) {
+        printf("Shortest distance from node %d to node %d: INF\n", source, target);
+    } else {
+        printf("Shortest distance from node %d to node %d: %d\n", source, target, distance);
     }
+    printf("Settled nodes: %d of %d\n", settled, graph->num_nodes);
+    if (landmarks) {
+        printf("Landmarks: %d\n", landmarks->num_landmarks);
+    }
+    printf("\nSequential execution time (%s, point-to-point): %.6f seconds\n", method, elapsed);
+    print_load_times(graph, order, load_time, reorder_time);
+    INSTR_REPORT(stdout, method);
     
-    fclose(file);
-    return graph;
+    alt_workspace_free(alt);
+    free_landmarks(landmarks);
+    ch_workspace_free(ch);
+    free_hierarchy(hierarchy);
+    free_graph(graph);
+    return EXIT_SUCCESS;
 }
 
 int main(int argc, char *argv[]) {
-    if (argc != 3) {
-        fprintf(stderr, "Usage: %s <input_file> <source_node>\n", argv[0]);
-        fprintf(stderr, "Example: %s weighted_graph.txt 0\n", argv[0]);
+    SequentialEngine engine = ENGINE_AUTO;
+    bool engine_given = false;
+    const char *source_file = NULL;
+    const char *source_range = NULL;
+    bool bidirectional = false;
+    const char *landmark_file = NULL;
+    const char *hierarchy_file = NULL;
+    OutputFormat format = OUTPUT_TEXT;
+    bool format_given = false;
+    const char *output_file = NULL;
+    VertexOrder reorder;
+    const VertexOrder *order = NULL;
+    
+    static const struct option long_options[] = {
+        {"engine", required_argument, NULL, 'e'},
+        {"bidirectional", no_argument, NULL, 'b'},
+        {"landmarks", required_argument, NULL, 'L'},
+        {"hierarchy", required_argument, NULL, 'H'},
+        {"sources", required_argument, NULL, 'S'},
+        {"source-range", required_argument, NULL, 'R'},
+        {"format", required_argument, NULL, 'f'},
+        {"output", required_argument, NULL, 'o'},
+        {"reorder", required_argument, NULL, 'r'},
+        {NULL, 0, NULL, 0}
+    };
+    
+    int opt;
+    while ((opt = getopt_long(argc, argv, "e:bL:H:S:R:f:o:r:", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'e':
+                if (!parse_sequential_engine(optarg, &engine)) {
+                    fprintf(stderr, "Error: Unknown engine '%s'\n", optarg);
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                engine_given = true;
+                break;
+            case 'b':
+                bidirectional = true;
+                break;
+            case 'L':
+                landmark_file = optarg;
+                break;
+            case 'H':
+                hierarchy_file = optarg;
+                break;
+            case 'S':
+                source_file = optarg;
+                break;
+            case 'R':
+                source_range = optarg;
+                break;
+            case 'f':
+                if (!parse_output_format(optarg, &format)) {
+                    fprintf(stderr, "Error: Unknown output format '%s'\n", optarg);
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                format_given = true;
+                break;
+            case 'o':
+                output_file = optarg;
+                break;
+            case 'r':
+                if (!parse_vertex_order(optarg, &reorder)) {
+                    fprintf(stderr, "Error: Unknown vertex order '%s'\n", optarg);
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                order = &reorder;
+                break;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    
+    if (source_file || source_range) {
+        if (argc - optind != 1 || (source_file && source_range) || bidirectional || landmark_file || hierarchy_file) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        return run_batch(argv[optind], order, engine, source_file, source_range, format, output_file);
+    }
+    
+    if (argc - optind == 3) {
+        if (format_given || output_file) {
+            fprintf(stderr, "Error: --format and --output apply to full distance arrays, not point-to-point queries\n");
+            return EXIT_FAILURE;
+        }
+        if (engine_given + bidirectional + (landmark_file != NULL) + (hierarchy_file != NULL) > 1) {
+            fprintf(stderr, "Error: --engine, --bidirectional, --landmarks and --hierarchy each select the point-to-point method; give at most one\n");
+            return EXIT_FAILURE;
+        }
+        return run_point_to_point(argv[optind], order, engine, bidirectional, landmark_file, hierarchy_file,
+                                  atoi(argv[optind + 1]), atoi(argv[optind + 2]));
+    }
+    
+    if (argc - optind != 2 || bidirectional || landmark_file || hierarchy_file) {
+        print_usage(argv[0]);
         return EXIT_FAILURE;
     }
     
-    const char *filename = argv[1];
-    int source = atoi(argv[2]);
+    const char *filename = argv[optind];
+    int source = atoi(argv[optind + 1]);
     
-    Graph *graph = read_graph_from_file(filename);
+    double load_time, reorder_time;
+    Graph *graph = load_graph(filename, order, &load_time, &reorder_time);
     if (!graph) {
         return EXIT_FAILURE;
     }
     
+    engine = resolve_sequential_engine(engine, graph);
+    
     if (source < 0 || source >= graph->num_nodes) {
         fprintf(stderr, "Error: Source node must be between 0 and %d\n", graph->num_nodes - 1);
         free_graph(graph);
@@ -151,28 +304,37 @@ int main(int argc, char *argv[]) {
     }
     
     int *distances = (int*)malloc(graph->num_nodes * sizeof(int));
+    if (!distances) {
+        perror("Error allocating distances");
+        free_graph(graph);
+        return EXIT_FAILURE;
+    }
     
+    INSTR_RESET();
     clock_t start = clock();
-    dijkstra_sequential(graph, source, distances);
+    if (run_sequential_engine(engine, graph, graph_node(graph, source), distances) != 0) {
+        free(distances);
+        free_graph(graph);
+        return EXIT_FAILURE;
+    }
     clock_t end = clock();
     
     double cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
     
-    printf("Shortest distances from node %d:\n", source);
-    for (int i = 0; i < graph->num_nodes; i++) {
-        if (distances[i] == INF) {
-            printf("Node %d: INF\n", i);
-        } else {
-            printf("Node %d: %d\n", i, distances[i]);
-        }
-    }
+    double output_start = omp_get_wtime();
+    int status = restore_input_order(distances, graph->original_id, graph->num_nodes, 0);
+    status = status == 0 ? write_distances(distances, graph->num_nodes, source, format, output_file, 0) : -1;
+    double output_time = omp_get_wtime() - output_start;
     
-    printf("\nSequential execution time: %.6f seconds\n", cpu_time_used);
+    printf("\nSequential execution time (%s): %.6f seconds\n", sequential_engine_name(engine), cpu_time_used);
+    print_load_times(graph, order, load_time, reorder_time);
+    printf("Output time (%s): %.6f seconds\n", output_format_name(format), output_time);
+    INSTR_REPORT(stdout, sequential_engine_name(engine));
     
     // Cleanup
     free(distances);
     free_graph(graph);
     
-    return EXIT_SUCCESS;
+    return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
@@ -0,0 +1,574 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <omp.h>
+#include "sssp.h"
+
+// Query server: loads the graph once and answers line-based queries from
+// stdin or from clients of a Unix domain socket (one client at a time).
+//
+//   sssp <source>             OK <num_nodes>, then one line of distances
+//   dist <source> <target>    OK <distance> (upward search with --hierarchy,
+//                             A* with --landmarks, bidirectional search with
+//                             --bidirectional)
+//   radius <source> <limit>   OK <count>, then one line of node:distance
+//                             pairs (ascending node id) with distance <= limit
+//   stats                     OK queries=... hits=... misses=... cached=...
+//   quit                      end this session
+//   shutdown                  stop the server
+//
+// Unreachable distances are written as INF; bad requests get "ERR <reason>",
+// as do searches that run out of memory.
+// Full distance arrays computed for sssp queries are kept in an LRU cache
+// keyed by source, and every query type is answered from it on a hit.
+// Node ids in requests and replies are input ids, also on reordered graphs.
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--engine auto|scan|heap|dial|radix] [--cache <entries>] [--bidirectional | --landmarks <file> | --hierarchy <file>] [--reorder input|rcm|bfs|degree] [--socket <path>] <input_file>\n", prog);
+    fprintf(stderr, "Example: %s --socket /tmp/dijkstra.sock weighted_graph.txt\n", prog);
+}
+
+// LRU cache of full distance arrays. slot_of[source] gives the entry for a
+// cached source in O(1); entries form a doubly-linked list, most recent first.
+typedef struct {
+    int source;
+    int *distances;
+    int prev;
+    int next;
+} CacheEntry;
+
+typedef struct {
+    CacheEntry *entries;
+    int *slot_of;           // num_nodes entries, -1 if not cached
+    int capacity;
+    int size;
+    int head;               // most recently used, -1 if empty
+    int tail;               // least recently used
+} DistanceCache;
+
+static DistanceCache* cache_create(int capacity, int num_nodes) {
+    DistanceCache *cache = (DistanceCache*)calloc(1, sizeof(DistanceCache));
+    if (!cache) {
+        return NULL;
+    }
+    cache->entries = (CacheEntry*)calloc(capacity > 0 ? capacity : 1, sizeof(CacheEntry));
+    cache->slot_of = (int*)malloc((size_t)num_nodes * sizeof(int));
+    if (!cache->entries || !cache->slot_of) {
+        free(cache->entries);
+        free(cache->slot_of);
+        free(cache);
+        return NULL;
+    }
+    for (int i = 0; i < num_nodes; i++) {
+        cache->slot_of[i] = -1;
+    }
+    cache->capacity = capacity;
+    cache->head = -1;
+    cache->tail = -1;
+    return cache;
+}
+
+static void cache_free(DistanceCache *cache) {
+    if (!cache) {
+        return;
+    }
+    for (int i = 0; i < cache->size; i++) {
+        free(cache->entries[i].distances);
+    }
+    free(cache->entries);
+    free(cache->slot_of);
+    free(cache);
+}
+
+static void cache_unlink(DistanceCache *cache, int slot) {
+    CacheEntry *entry = &cache->entries[slot];
+    if (entry->prev >= 0) {
+        cache->entries[entry->prev].next = entry->next;
+    } else {
+        cache->head = entry->next;
+    }
+    if (entry->next >= 0) {
+        cache->entries[entry->next].prev = entry->prev;
+    } else {
+        cache->tail = entry->prev;
+    }
+}
+
+static void cache_push_front(DistanceCache *cache, int slot) {
+    CacheEntry *entry = &cache->entries[slot];
+    entry->prev = -1;
+    entry->next = cache->head;
+    if (cache->head >= 0) {
+        cache->entries[cache->head].prev = slot;
+    }
+    cache->head = slot;
+    if (cache->tail < 0) {
+        cache->tail = slot;
+    }
+}
+
+// Distances from source if cached (and mark them most recently used), else NULL
+static const int* cache_lookup(DistanceCache *cache, int source) {
+    int slot = cache->slot_of[source];
+    if (slot < 0) {
+        return NULL;
+    }
+    if (cache->head != slot) {
+        cache_unlink(cache, slot);
+        cache_push_front(cache, slot);
+    }
+    return cache->entries[slot].distances;
+}
+
+// Buffer to fill with the distances from source, taking a free entry or
+// evicting the least recently used one; NULL if caching is disabled
+static int* cache_insert(DistanceCache *cache, int source, int num_nodes) {
+    if (cache->capacity <= 0) {
+        return NULL;
+    }
+    int slot;
+    if (cache->size < cache->capacity) {
+        int *distances = (int*)malloc((size_t)num_nodes * sizeof(int));
+        if (!distances) {
+            return NULL;
+        }
+        slot = cache->size++;
+        cache->entries[slot].distances = distances;
+    } else {
+        slot = cache->tail;
+        cache_unlink(cache, slot);
+        cache->slot_of[cache->entries[slot].source] = -1;
+    }
+    cache->entries[slot].source = source;
+    cache->slot_of[source] = slot;
+    cache_push_front(cache, slot);
+    return cache->entries[slot].distances;
+}
+
+// Drop the entry of source after its search failed; the last entry moves
+// into its slot so entries[0, size) stay in use
+static void cache_discard(DistanceCache *cache, int source) {
+    int slot = cache->slot_of[source];
+    cache->slot_of[source] = -1;
+    cache_unlink(cache, slot);
+    free(cache->entries[slot].distances);
+    int last = --cache->size;
+    if (slot != last) {
+        CacheEntry *entry = &cache->entries[slot];
+        *entry = cache->entries[last];
+        if (entry->prev >= 0) {
+            cache->entries[entry->prev].next = slot;
+        } else {
+            cache->head = slot;
+        }
+        if (entry->next >= 0) {
+            cache->entries[entry->next].prev = slot;
+        } else {
+            cache->tail = slot;
+        }
+        cache->slot_of[entry->source] = slot;
+    }
+}
+
+typedef struct {
+    const Graph *graph;
+    SsspWorkspace *workspace;
+    // At most one of these is set; it answers uncached dist queries
+    BidirectionalWorkspace *bidirectional;
+    AltWorkspace *alt;
+    ChWorkspace *ch;
+    DistanceCache *cache;
+    int *scratch;           // distances of uncached searches
+    int *order;             // input ids for radius replies
+    long queries;
+    long hits;
+    long misses;
+} Server;
+
+static void write_distance(FILE *out, int distance) {
+    if (distance == INF) {
+        fputs("INF", out);
+    } else {
+        fprintf(out, "%d", distance);
+    }
+}
+
+static int compare_ints(const void *a, const void *b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+static bool check_node(FILE *out, const Server *server, int node, const char *what) {
+    if (node < 0 || node >= server->graph->num_nodes) {
+        fprintf(out, "ERR %s must be between 0 and %d\n", what, server->graph->num_nodes - 1);
+        return false;
+    }
+    return true;
+}
+
+static const int* cached_distances(Server *server, int source) {
+    server->queries++;
+    const int *distances = cache_lookup(server->cache, source);
+    if (distances) {
+        server->hits++;
+    } else {
+        server->misses++;
+    }
+    return distances;
+}
+
+static void answer_sssp(Server *server, FILE *out, int input_source) {
+    const Graph *graph = server->graph;
+    int n = graph->num_nodes;
+    int source = graph_node(graph, input_source);
+    const int *distances = cached_distances(server, source);
+    if (!distances) {
+        int *slot = cache_insert(server->cache, source, n);
+        int *target = slot ? slot : server->scratch;
+        if (sssp_workspace_run(server->workspace, source, target) != 0) {
+            if (slot) {
+                cache_discard(server->cache, source);
+            }
+            fputs("ERR out of memory\n", out);
+            return;
+        }
+        distances = target;
+    }
+    fprintf(out, "OK %d\n", n);
+    for (int u = 0; u < n; u++) {
+        if (u > 0) {
+            fputc(' ', out);
+        }
+        write_distance(out, distances[graph_node(graph, u)]);
+    }
+    fputc('\n', out);
+}
+
+static void answer_dist(Server *server, FILE *out, int input_source, int input_target) {
+    int source = graph_node(server->graph, input_source);
+    int target = graph_node(server->graph, input_target);
+    const int *distances = cached_distances(server, source);
+    int distance;
+    if (distances) {
+        distance = distances[target];
+    } else if (server->ch) {
+        distance = ch_query(server->ch, source, target, NULL);
+    } else if (server->alt) {
+        distance = alt_query(server->alt, source, target, NULL);
+    } else if (server->bidirectional) {
+        distance = bidirectional_query(server->bidirectional, source, target, NULL);
+    } else {
+        // Stop as soon as the target is settled; not cached since the array is partial
+        distance = sssp_workspace_search(server->workspace, source, target, INF, server->scratch) == 0 ?
+                   server->scratch[target] : -1;
+    }
+    if (distance < 0) {
+        fputs("ERR out of memory\n", out);
+        return;
+    }
+    fputs("OK ", out);
+    write_distance(out, distance);
+    fputc('\n', out);
+}
+
+static void answer_radius(Server *server, FILE *out, int input_source, int limit) {
+    const Graph *graph = server->graph;
+    int n = graph->num_nodes;
+    int source = graph_node(graph, input_source);
+    const int *distances = cached_distances(server, source);
+    int count = 0;
+    // A scan of a cached array finds the nodes in ascending input id unless the graph was reordered
+    bool sorted = distances && !graph->original_id;
+    if (distances) {
+        for (int v = 0; v < n; v++) {
+            if (distances[v] <= limit) {
+                server->order[count++] = graph_input_id(graph, v);
+            }
+        }
+    } else {
+        // Every node within the limit is settled before the search stops
+        if (sssp_workspace_search(server->workspace, source, -1, limit, server->scratch) != 0) {
+            fputs("ERR out of memory\n", out);
+            return;
+        }
+        const int *settled = sssp_workspace_settled(server->workspace, &count);
+        for (int i = 0; i < count; i++) {
+            server->order[i] = graph_input_id(graph, settled[i]);
+        }
+        distances = server->scratch;
+    }
+    if (!sorted) {
+        qsort(server->order, count, sizeof(int), compare_ints);
+    }
+    fprintf(out, "OK %d\n", count);
+    for (int i = 0; i < count; i++) {
+        int u = server->order[i];
+        fprintf(out, i > 0 ? " %d:%d" : "%d:%d", u, distances[graph_node(graph, u)]);
+    }
+    fputc('\n', out);
+}
+
+typedef enum {
+    SESSION_EOF,
+    SESSION_QUIT,
+    SESSION_SHUTDOWN
+} SessionEnd;
+
+// Answer queries from in until EOF, "quit" or "shutdown"
+static SessionEnd serve_session(Server *server, FILE *in, FILE *out) {
+    char *line = NULL;
+    size_t line_capacity = 0;
+    SessionEnd end = SESSION_EOF;
+    while (getline(&line, &line_capacity, in) != -1) {
+        char command[16];
+        int a, b;
+        char extra;
+        int fields = sscanf(line, "%15s %d %d %c", command, &a, &b, &extra);
+        if (fields <= 0 || command[0] == '#') {
+            continue;
+        }
+        if (strcmp(command, "sssp") == 0 && fields == 2) {
+            if (check_node(out, server, a, "source")) {
+                answer_sssp(server, out, a);
+            }
+        } else if (strcmp(command, "dist") == 0 && fields == 3) {
+            if (check_node(out, server, a, "source") && check_node(out, server, b, "target")) {
+                answer_dist(server, out, a, b);
+            }
+        } else if (strcmp(command, "radius") == 0 && fields == 3) {
+            if (check_node(out, server, a, "source")) {
+                if (b < 0) {
+                    fputs("ERR limit must be non-negative\n", out);
+                } else {
+                    answer_radius(server, out, a, b);
+                }
+            }
+        } else if (strcmp(command, "stats") == 0 && fields == 1) {
+            fprintf(out, "OK queries=%ld hits=%ld misses=%ld cached=%d/%d\n",
+                    server->queries, server->hits, server->misses, server->cache->size, server->cache->capacity);
+        } else if (strcmp(command, "quit") == 0 && fields == 1) {
+            end = SESSION_QUIT;
+            break;
+        } else if (strcmp(command, "shutdown") == 0 && fields == 1) {
+            fputs("OK\n", out);
+            end = SESSION_SHUTDOWN;
+            break;
+        } else {
+            fputs("ERR unknown request (expected sssp, dist, radius, stats, quit or shutdown)\n", out);
+        }
+        fflush(out);
+    }
+    fflush(out);
+    free(line);
+    return end;
+}
+
+// Accept clients on a Unix domain socket at path until one sends "shutdown"
+static int serve_socket(Server *server, const char *path) {
+    struct sockaddr_un address;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Error: Socket path '%s' is too long\n", path);
+        return EXIT_FAILURE;
+    }
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        perror("Error creating socket");
+        return EXIT_FAILURE;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+    unlink(path);
+    if (bind(listener, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 16) != 0) {
+        perror("Error binding socket");
+        close(listener);
+        return EXIT_FAILURE;
+    }
+    // A client that disconnects mid-reply must not kill the server
+    signal(SIGPIPE, SIG_IGN);
+    fprintf(stderr, "Listening on %s\n", path);
+
+    SessionEnd end = SESSION_EOF;
+    while (end != SESSION_SHUTDOWN) {
+        int client = accept(listener, NULL, NULL);
+        if (client < 0) {
+            perror("Error accepting connection");
+            continue;
+        }
+        int client_out = dup(client);
+        FILE *in = fdopen(client, "r");
+        FILE *out = client_out >= 0 ? fdopen(client_out, "w") : NULL;
+        if (!in || !out) {
+            perror("Error opening connection");
+            if (in) {
+                fclose(in);
+            } else {
+                close(client);
+            }
+            if (client_out >= 0 && !out) {
+                close(client_out);
+            }
+            continue;
+        }
+        end = serve_session(server, in, out);
+        fclose(in);
+        fclose(out);
+    }
+
+    close(listener);
+    unlink(path);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[]) {
+    SequentialEngine engine = ENGINE_AUTO;
+    int cache_entries = 16;
+    const char *socket_path = NULL;
+    bool bidirectional = false;
+    const char *landmark_file = NULL;
+    const char *hierarchy_file = NULL;
+    VertexOrder reorder;
+    const VertexOrder *order = NULL;
+
+    static const struct option long_options[] = {
+        {"engine", required_argument, NULL, 'e'},
+        {"cache", required_argument, NULL, 'c'},
+        {"socket", required_argument, NULL, 's'},
+        {"bidirectional", no_argument, NULL, 'b'},
+        {"landmarks", required_argument, NULL, 'L'},
+        {"hierarchy", required_argument, NULL, 'H'},
+        {"reorder", required_argument, NULL, 'r'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "e:c:s:bL:H:r:", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'e':
+                if (!parse_sequential_engine(optarg, &engine)) {
+                    fprintf(stderr, "Error: Unknown engine '%s'\n", optarg);
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'c':
+                cache_entries = atoi(optarg);
+                if (cache_entries < 0) {
+                    fprintf(stderr, "Error: Cache size must be non-negative\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 's':
+                socket_path = optarg;
+                break;
+            case 'b':
+                bidirectional = true;
+                break;
+            case 'L':
+                landmark_file = optarg;
+                break;
+            case 'H':
+                hierarchy_file = optarg;
+                break;
+            case 'r':
+                if (!parse_vertex_order(optarg, &reorder)) {
+                    fprintf(stderr, "Error: Unknown vertex order '%s'\n", optarg);
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                order = &reorder;
+                break;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (argc - optind != 1) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (bidirectional + (landmark_file != NULL) + (hierarchy_file != NULL) > 1) {
+        fprintf(stderr, "Error: --bidirectional, --landmarks and --hierarchy each select how dist queries run; give at most one\n");
+        return EXIT_FAILURE;
+    }
+
+    double load_start = omp_get_wtime();
+    Graph *graph = read_graph_from_file(argv[optind]);
+    // Renumber before reading preprocessed files, which must match the final order
+    if (graph && order && reorder_graph(graph, *order, 0) != 0) {
+        free_graph(graph);
+        graph = NULL;
+    }
+    double load_time = omp_get_wtime() - load_start;
+    if (!graph) {
+        return EXIT_FAILURE;
+    }
+
+    LandmarkTable *landmarks = NULL;
+    if (landmark_file) {
+        landmarks = read_landmarks_binary(landmark_file, graph);
+        if (!landmarks) {
+            free_graph(graph);
+            return EXIT_FAILURE;
+        }
+    }
+    ContractionHierarchy *hierarchy = NULL;
+    if (hierarchy_file) {
+        hierarchy = read_hierarchy_binary(hierarchy_file, graph);
+        if (!hierarchy) {
+            free_landmarks(landmarks);
+            free_graph(graph);
+            return EXIT_FAILURE;
+        }
+    }
+    
+    Server server = {0};
+    server.graph = graph;
+    server.workspace = sssp_workspace_create(graph, engine);
+    server.bidirectional = bidirectional ? bidirectional_workspace_create(graph) : NULL;
+    server.alt = landmarks ? alt_workspace_create(graph, landmarks) : NULL;
+    server.ch = hierarchy ? ch_workspace_create(hierarchy) : NULL;
+    server.cache = cache_create(cache_entries, graph->num_nodes);
+    server.scratch = (int*)malloc((size_t)graph->num_nodes * sizeof(int));
+    server.order = (int*)malloc((size_t)graph->num_nodes * sizeof(int));
+    int status = EXIT_FAILURE;
+    // The workspaces report their own failures, including a rejected engine
+    bool ok = server.workspace && (server.bidirectional || !bidirectional) && (server.alt || !landmarks) &&
+              (server.ch || !hierarchy);
+    if (ok && !(server.cache && server.scratch && server.order)) {
+        perror("Error allocating server buffers");
+        ok = false;
+    }
+    if (ok) {
+        fprintf(stderr, "Graph loaded: %d nodes, %d edges (%.6f seconds, %s order, %s engine, cache of %d sources)\n",
+                graph->num_nodes, graph->num_edges, load_time, vertex_order_name(graph->order),
+                sequential_engine_name(resolve_sequential_engine(engine, graph)), cache_entries);
+        if (socket_path) {
+            status = serve_socket(&server, socket_path);
+        } else {
+            serve_session(&server, stdin, stdout);
+            status = EXIT_SUCCESS;
+        }
+    }
+
+    free(server.order);
+    free(server.scratch);
+    cache_free(server.cache);
+    bidirectional_workspace_free(server.bidirectional);
+    alt_workspace_free(server.alt);
+    free_landmarks(landmarks);
+    ch_workspace_free(server.ch);
+    free_hierarchy(hierarchy);
+    sssp_workspace_free(server.workspace);
+    free_graph(graph);
+
+    return status;
+}
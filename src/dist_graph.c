@@ -0,0 +1,593 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "dist_graph.h"
+
+static DistGraph* alloc_dist_graph(int num_nodes, int num_edges, int max_weight, MPI_Comm comm) {
+    DistGraph *graph = (DistGraph*)calloc(1, sizeof(DistGraph));
+    if (!graph) {
+        perror("Error allocating distributed graph");
+        return NULL;
+    }
+    MPI_Comm_rank(comm, &graph->rank);
+    MPI_Comm_size(comm, &graph->size);
+    graph->comm = comm;
+#ifdef _OPENMP
+    graph->num_threads = omp_get_max_threads();
+#else
+    graph->num_threads = 1;
+#endif
+    graph->num_nodes = num_nodes;
+    graph->num_edges = num_edges;
+    graph->max_weight = max_weight;
+    graph->first_node = partition_first(num_nodes, graph->size, graph->rank);
+    graph->local_nodes = partition_first(num_nodes, graph->size, graph->rank + 1) - graph->first_node;
+    return graph;
+}
+
+// Compute the global maximum degree once the local rows are in place
+static void finish_dist_graph(DistGraph *graph) {
+    int local_max = 0;
+    for (int i = 0; i < graph->local_nodes; i++) {
+        int degree = graph->offsets[i + 1] - graph->offsets[i];
+        if (degree > local_max) {
+            local_max = degree;
+        }
+    }
+    MPI_Allreduce(&local_max, &graph->max_degree, 1, MPI_INT, MPI_MAX, graph->comm);
+}
+
+// Read bytes at offset with independent MPI-IO reads (count is an int per call)
+static bool read_at(MPI_File fh, MPI_Offset offset, void *buffer, size_t bytes) {
+    char *p = (char*)buffer;
+    while (bytes > 0) {
+        int piece = (bytes > (size_t)(1 << 30)) ? (1 << 30) : (int)bytes;
+        MPI_Status status;
+        int got = 0;
+        if (MPI_File_read_at(fh, offset, p, piece, MPI_BYTE, &status) != MPI_SUCCESS) {
+            return false;
+        }
+        MPI_Get_count(&status, MPI_BYTE, &got);
+        if (got <= 0) {
+            return false;
+        }
+        p += got;
+        offset += got;
+        bytes -= (size_t)got;
+    }
+    return true;
+}
+
+// Every rank must agree on failure; returns true if ok held on all ranks
+static bool all_ok(bool ok, MPI_Comm comm) {
+    int flag = ok ? 1 : 0;
+    MPI_Allreduce(MPI_IN_PLACE, &flag, 1, MPI_INT, MPI_MIN, comm);
+    return flag != 0;
+}
+
+// Build the local CSR rows from (u, v, w) triples whose u this rank owns,
+// keeping the order in which they arrive
+static bool build_local_rows(DistGraph *graph, const int *triples, int num_triples) {
+    graph->offsets = (int*)calloc((size_t)graph->local_nodes + 1, sizeof(int));
+    graph->dest = (int*)malloc((num_triples > 0 ? (size_t)num_triples : 1) * sizeof(int));
+    graph->weight = (int*)malloc((num_triples > 0 ? (size_t)num_triples : 1) * sizeof(int));
+    int *fill = (int*)malloc((graph->local_nodes > 0 ? (size_t)graph->local_nodes : 1) * sizeof(int));
+    if (!graph->offsets || !graph->dest || !graph->weight || !fill) {
+        perror("Error allocating distributed graph");
+        free(fill);
+        return false;
+    }
+    for (int k = 0; k < num_triples; k++) {
+        graph->offsets[triples[3 * k] - graph->first_node + 1]++;
+    }
+    for (int i = 0; i < graph->local_nodes; i++) {
+        graph->offsets[i + 1] += graph->offsets[i];
+    }
+    memcpy(fill, graph->offsets, (size_t)graph->local_nodes * sizeof(int));
+    for (int k = 0; k < num_triples; k++) {
+        int pos = fill[triples[3 * k] - graph->first_node]++;
+        graph->dest[pos] = triples[3 * k + 1];
+        graph->weight[pos] = triples[3 * k + 2];
+    }
+    free(fill);
+    return true;
+}
+
+// Send both directions of each valid edge to the owner of its source row
+// with one MPI_Alltoallv, then build the local rows from what arrives
+static bool redistribute_edges(DistGraph *graph, const int *edge_u, const int *edge_v, const int *edge_w,
+                               long long num_edges) {
+    int size = graph->size;
+    int *send_counts = (int*)calloc((size_t)size, sizeof(int));
+    int *send_displs = (int*)malloc((size_t)size * sizeof(int));
+    int *recv_counts = (int*)malloc((size_t)size * sizeof(int));
+    int *recv_displs = (int*)malloc((size_t)size * sizeof(int));
+    bool ok = send_counts && send_displs && recv_counts && recv_displs;
+
+    long long valid_edges = 0;
+    int max_weight = 0;
+    for (long long i = 0; ok && i < num_edges; i++) {
+        int u = edge_u[i];
+        int v = edge_v[i];
+        if (u < 0 || u >= graph->num_nodes || v < 0 || v >= graph->num_nodes) {
+            fprintf(stderr, "Error: Invalid edge (%d, %d) - nodes must be between 0 and %d\n",
+                    u, v, graph->num_nodes - 1);
+            continue;
+        }
+        send_counts[dist_graph_owner(graph, u)] += 3;
+        send_counts[dist_graph_owner(graph, v)] += 3;
+        valid_edges++;
+        if (edge_w[i] > max_weight) {
+            max_weight = edge_w[i];
+        }
+    }
+
+    size_t total_send = 0;
+    for (int r = 0; ok && r < size; r++) {
+        send_displs[r] = (int)total_send;
+        total_send += (size_t)send_counts[r];
+    }
+    int *send_buf = ok ? (int*)malloc((total_send > 0 ? total_send : 1) * sizeof(int)) : NULL;
+    ok = ok && send_buf && total_send <= INT_MAX;
+    for (long long i = 0; ok && i < num_edges; i++) {
+        int u = edge_u[i];
+        int v = edge_v[i];
+        if (u < 0 || u >= graph->num_nodes || v < 0 || v >= graph->num_nodes) {
+            continue;
+        }
+        int *out = send_buf + send_displs[dist_graph_owner(graph, u)];
+        out[0] = u;
+        out[1] = v;
+        out[2] = edge_w[i];
+        send_displs[dist_graph_owner(graph, u)] += 3;
+        out = send_buf + send_displs[dist_graph_owner(graph, v)];
+        out[0] = v;
+        out[1] = u;
+        out[2] = edge_w[i];
+        send_displs[dist_graph_owner(graph, v)] += 3;
+    }
+    for (int r = 0; ok && r < size; r++) {
+        send_displs[r] -= send_counts[r];
+    }
+    if (!all_ok(ok, graph->comm)) {
+        if (!ok) {
+            perror("Error allocating edge exchange");
+        }
+        free(send_buf);
+        free(send_counts);
+        free(send_displs);
+        free(recv_counts);
+        free(recv_displs);
+        return false;
+    }
+
+    MPI_Alltoall(send_counts, 1, MPI_INT, recv_counts, 1, MPI_INT, graph->comm);
+    size_t total_recv = 0;
+    for (int r = 0; r < size; r++) {
+        recv_displs[r] = (int)total_recv;
+        total_recv += (size_t)recv_counts[r];
+    }
+    int *recv_buf = (int*)malloc((total_recv > 0 ? total_recv : 1) * sizeof(int));
+    ok = recv_buf && total_recv <= INT_MAX;
+    if (all_ok(ok, graph->comm)) {
+        MPI_Alltoallv(send_buf, send_counts, send_displs, MPI_INT,
+                      recv_buf, recv_counts, recv_displs, MPI_INT, graph->comm);
+        ok = build_local_rows(graph, recv_buf, (int)(total_recv / 3));
+    } else if (!ok) {
+        perror("Error allocating edge exchange");
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, &valid_edges, 1, MPI_LONG_LONG, MPI_SUM, graph->comm);
+    MPI_Allreduce(&max_weight, &graph->max_weight, 1, MPI_INT, MPI_MAX, graph->comm);
+    graph->num_edges = (int)valid_edges;
+
+    free(send_buf);
+    free(recv_buf);
+    free(send_counts);
+    free(send_displs);
+    free(recv_counts);
+    free(recv_displs);
+    return all_ok(ok, graph->comm);
+}
+
+// Text input: the edge lines after the header are split into equal byte
+// ranges. A line belongs to the rank whose range holds its first byte, so
+// each rank reads one byte before its range (to see whether a line starts
+// there) and reads past its end until the line in progress is complete.
+static bool read_text_slice(DistGraph *graph, MPI_File fh, MPI_Offset file_size, MPI_Offset body_offset,
+                            int declared_edges, const char *filename) {
+    MPI_Offset body_size = file_size - body_offset;
+    MPI_Offset range_begin = body_offset + body_size * graph->rank / graph->size;
+    MPI_Offset range_end = body_offset + body_size * (graph->rank + 1) / graph->size;
+    MPI_Offset read_begin = (range_begin > body_offset) ? range_begin - 1 : range_begin;
+
+    size_t length = (size_t)(range_end - read_begin);
+    size_t capacity = length + 4096;
+    char *buffer = (char*)malloc(capacity);
+    bool ok = buffer && read_at(fh, read_begin, buffer, length);
+
+    // First line start at or after range_begin
+    size_t begin = 0;
+    if (ok && range_begin > body_offset) {
+        const char *nl = (const char*)memchr(buffer, '\n', length);
+        begin = nl ? (size_t)(nl - buffer) + 1 : length;
+    }
+    // First line start at or after range_end: the newline at or after range_end - 1
+    size_t scan_from = (range_end > read_begin) ? (size_t)(range_end - 1 - read_begin) : 0;
+    if (scan_from < begin) {
+        scan_from = begin;
+    }
+    while (ok && begin < length && !memchr(buffer + scan_from, '\n', length - scan_from) &&
+           read_begin + (MPI_Offset)length < file_size) {
+        size_t more = (size_t)(file_size - read_begin) - length;
+        if (more > 65536) {
+            more = 65536;
+        }
+        if (length + more > capacity) {
+            capacity = (length + more) * 2;
+            char *grown = (char*)realloc(buffer, capacity);
+            if (!grown) {
+                ok = false;
+                break;
+            }
+            buffer = grown;
+        }
+        scan_from = length;
+        ok = read_at(fh, read_begin + (MPI_Offset)length, buffer + length, more);
+        length += more;
+    }
+    size_t end = length;
+    if (ok && begin < length) {
+        const char *nl = (const char*)memchr(buffer + scan_from, '\n', length - scan_from);
+        end = nl ? (size_t)(nl - buffer) + 1 : length;
+    } else {
+        end = begin;
+    }
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to read '%s' on rank %d\n", filename, graph->rank);
+    }
+
+    int *edge_u = NULL;
+    int *edge_v = NULL;
+    int *edge_w = NULL;
+    long long parsed = 0;
+    bool malformed = false;
+    if (ok) {
+        parsed = parse_edge_list(buffer + begin, end - begin, INT_MAX, graph->num_threads, &edge_u, &edge_v, &edge_w,
+                                 &malformed);
+        ok = (parsed >= 0);
+    }
+    free(buffer);
+    if (!all_ok(ok, graph->comm)) {
+        free(edge_u);
+        free(edge_v);
+        free(edge_w);
+        return false;
+    }
+
+    // Edges past the declared count are ignored, as in the serial loader.
+    // The list ends at the first malformed line in file order, i.e. in the
+    // lowest rank that found one; later ranks' edges come after it.
+    int first_malformed = malformed ? graph->rank : graph->size;
+    MPI_Allreduce(MPI_IN_PLACE, &first_malformed, 1, MPI_INT, MPI_MIN, graph->comm);
+    if (graph->rank > first_malformed) {
+        parsed = 0;
+    }
+    long long first_edge = 0;
+    long long total = parsed;
+    MPI_Exscan(&parsed, &first_edge, 1, MPI_LONG_LONG, MPI_SUM, graph->comm);
+    if (graph->rank == 0) {
+        first_edge = 0;
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &total, 1, MPI_LONG_LONG, MPI_SUM, graph->comm);
+    if (total < declared_edges) {
+        if (graph->rank == 0 && first_malformed < graph->size) {
+            fprintf(stderr, "Error: Malformed edge list in '%s' (expected one 'u v w' triple per line)\n", filename);
+        } else if (graph->rank == 0) {
+            fprintf(stderr, "Error: Failed to read edge %lld\n", total);
+        }
+        free(edge_u);
+        free(edge_v);
+        free(edge_w);
+        return false;
+    }
+    long long keep = declared_edges - first_edge;
+    keep = (keep < 0) ? 0 : (keep > parsed ? parsed : keep);
+    long long negative = first_negative_weight(edge_w, keep);
+    if (negative >= 0) {
+        fprintf(stderr, "Error: Negative weight %d on edge %lld in '%s' (weights must be non-negative)\n",
+                edge_w[negative], first_edge + negative, filename);
+    }
+    if (!all_ok(negative < 0, graph->comm)) {
+        free(edge_u);
+        free(edge_v);
+        free(edge_w);
+        return false;
+    }
+
+    ok = redistribute_edges(graph, edge_u, edge_v, edge_w, keep);
+    free(edge_u);
+    free(edge_v);
+    free(edge_w);
+    return ok;
+}
+
+// Binary input: every rank reads its own slice of the offsets array and the
+// matching dest/weight ranges directly; nothing is redistributed. The
+// whole-file checksum is not verified since no rank reads the whole file,
+// but each slice is checked for consistency.
+static bool read_binary_slice(DistGraph *graph, MPI_File fh, const GraphFileHeader *header, const char *filename) {
+    size_t rows = (size_t)graph->local_nodes + 1;
+    graph->offsets = (int*)malloc(rows * sizeof(int));
+    bool ok = graph->offsets &&
+              read_at(fh, (MPI_Offset)(header->offsets_pos + (uint64_t)graph->first_node * sizeof(int)),
+                      graph->offsets, rows * sizeof(int));
+
+    int entry_base = ok ? graph->offsets[0] : 0;
+    for (size_t i = 0; ok && i < rows; i++) {
+        if (graph->offsets[i] < entry_base || (uint64_t)graph->offsets[i] > header->num_entries ||
+            (i > 0 && graph->offsets[i] < graph->offsets[i - 1])) {
+            ok = false;
+        }
+    }
+    size_t entries = ok ? (size_t)(graph->offsets[rows - 1] - entry_base) : 0;
+    size_t weight_bytes = header->weight_bytes;
+    if (ok) {
+        graph->dest = (int*)malloc((entries > 0 ? entries : 1) * sizeof(int));
+        graph->weight = (int*)malloc((entries > 0 ? entries : 1) * sizeof(int));
+        ok = graph->dest && graph->weight &&
+             read_at(fh, (MPI_Offset)(header->dest_pos + (uint64_t)entry_base * sizeof(int)),
+                     graph->dest, entries * sizeof(int)) &&
+             read_at(fh, (MPI_Offset)(header->weight_pos + (uint64_t)entry_base * weight_bytes),
+                     graph->weight, entries * weight_bytes);
+    }
+    if (ok && weight_bytes != sizeof(int)) {
+        // Widen in place from the back so narrow values are not overwritten early
+        for (size_t i = entries; i-- > 0;) {
+            graph->weight[i] = (weight_bytes == 1) ? ((const uint8_t*)graph->weight)[i]
+                                                   : ((const uint16_t*)graph->weight)[i];
+        }
+    }
+    for (size_t i = 0; ok && i < entries; i++) {
+        if (graph->dest[i] < 0 || graph->dest[i] >= graph->num_nodes) {
+            ok = false;
+        }
+    }
+    long long negative = ok ? first_negative_weight(graph->weight, (long long)entries) : -1;
+    if (negative >= 0) {
+        fprintf(stderr, "Error: '%s' has a negative edge weight (%d)\n", filename, graph->weight[negative]);
+        return all_ok(false, graph->comm);
+    }
+    if (ok) {
+        for (size_t i = 0; i < rows; i++) {
+            graph->offsets[i] -= entry_base;
+        }
+    } else {
+        fprintf(stderr, "Error: '%s' is corrupt or could not be read (rank %d)\n", filename, graph->rank);
+    }
+    return all_ok(ok, graph->comm);
+}
+
+// Reordered binary input: rank 0 reads the input id of every node, so it
+// can map the source in and the gathered distances out
+static bool read_order_section(DistGraph *graph, MPI_File fh, const GraphFileHeader *header, const char *filename) {
+    bool ok = true;
+    graph->order = (VertexOrder)header->flags;
+    if (graph->rank == 0 && header->order_pos != 0) {
+        size_t bytes = (size_t)graph->num_nodes * sizeof(int);
+        graph->original_id = (int*)malloc(bytes);
+        unsigned char *seen = (unsigned char*)calloc((size_t)graph->num_nodes, 1);
+        bool allocated = graph->original_id && seen;
+        if (!allocated) {
+            perror("Error allocating vertex order");
+        }
+        ok = allocated && read_at(fh, (MPI_Offset)header->order_pos, graph->original_id, bytes);
+        for (int v = 0; ok && v < graph->num_nodes; v++) {
+            int id = graph->original_id[v];
+            ok = id >= 0 && id < graph->num_nodes && !seen[id];
+            if (ok) {
+                seen[id] = 1;
+            }
+        }
+        if (allocated && !ok) {
+            fprintf(stderr, "Error: '%s' has an invalid order section\n", filename);
+        }
+        free(seen);
+    }
+    return all_ok(ok, graph->comm);
+}
+
+DistGraph* dist_graph_read(const char *filename, MPI_Comm comm) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+
+    MPI_File fh;
+    int open_status = MPI_File_open(comm, filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh);
+    if (open_status != MPI_SUCCESS) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: Cannot open file '%s'\n", filename);
+        }
+        return NULL;
+    }
+    MPI_Offset file_size;
+    MPI_File_get_size(fh, &file_size);
+
+    // Rank 0 looks at the start of the file: binary header or text header line.
+    // info = {status, is_binary, num_nodes, num_edges, body_offset}
+    long long info[5] = {0, 0, 0, 0, 0};
+    GraphFileHeader header;
+    memset(&header, 0, sizeof(header));
+    if (rank == 0) {
+        size_t head_size = (file_size < 4096) ? (size_t)file_size : 4096;
+        char *head = (char*)malloc(head_size > 0 ? head_size : 1);
+        if (head && read_at(fh, 0, head, head_size)) {
+            if (is_binary_graph(head, head_size)) {
+                memcpy(&header, head, sizeof(header));
+                if (check_graph_header(&header, (uint64_t)file_size, filename)) {
+                    info[0] = 1;
+                    info[1] = 1;
+                    info[2] = (long long)header.num_nodes;
+                    info[3] = (long long)header.num_edges;
+                }
+            } else {
+                int num_nodes, num_edges;
+                size_t body_offset;
+                if (parse_graph_header(head, head_size, filename, &num_nodes, &num_edges, &body_offset)) {
+                    info[0] = 1;
+                    info[2] = num_nodes;
+                    info[3] = num_edges;
+                    info[4] = (long long)body_offset;
+                }
+            }
+        } else {
+            fprintf(stderr, "Error: Failed to read first line from '%s'\n", filename);
+        }
+        free(head);
+    }
+    MPI_Bcast(info, 5, MPI_LONG_LONG, 0, comm);
+    if (!info[0]) {
+        MPI_File_close(&fh);
+        return NULL;
+    }
+    if (info[1]) {
+        MPI_Bcast(&header, (int)sizeof(header), MPI_BYTE, 0, comm);
+    }
+
+    DistGraph *graph = alloc_dist_graph((int)info[2], (int)info[3], header.max_weight, comm);
+    bool ok = all_ok(graph != NULL, comm);
+    if (ok && info[1]) {
+        ok = read_binary_slice(graph, fh, &header, filename) && read_order_section(graph, fh, &header, filename);
+    } else if (ok) {
+        ok = read_text_slice(graph, fh, file_size, (MPI_Offset)info[4], (int)info[3], filename);
+    }
+    MPI_File_close(&fh);
+
+    if (!ok) {
+        free_dist_graph(graph);
+        return NULL;
+    }
+    finish_dist_graph(graph);
+    return graph;
+}
+
+void free_dist_graph(DistGraph *graph) {
+    if (!graph) {
+        return;
+    }
+    free(graph->offsets);
+    free(graph->dest);
+    free(graph->weight);
+    free(graph->original_id);
+    free(graph);
+}
+
+int dist_graph_node(const DistGraph *graph, int input_id) {
+    int node = input_id;
+    if (graph->original_id) {
+        for (int v = 0; v < graph->num_nodes; v++) {
+            if (graph->original_id[v] == input_id) {
+                node = v;
+                break;
+            }
+        }
+    }
+    MPI_Bcast(&node, 1, MPI_INT, 0, graph->comm);
+    return node;
+}
+
+int dist_graph_default_delta(const DistGraph *graph) {
+    // Every undirected edge is stored once in each endpoint's row
+    long long num_entries = 2LL * graph->num_edges;
+    if (num_entries == 0) {
+        return 1;
+    }
+    int max_weight = (graph->max_weight > 0) ? graph->max_weight : 1;
+    int avg_degree = (int)(num_entries / graph->num_nodes);
+    int delta = (avg_degree > 0) ? max_weight / avg_degree : max_weight;
+    return (delta > 0) ? delta : 1;
+}
+
+SharedDistances* shared_distances_create(const DistGraph *graph) {
+    SharedDistances *shared = (SharedDistances*)calloc(1, sizeof(SharedDistances));
+    bool ok = shared != NULL;
+    if (!all_ok(ok, graph->comm)) {
+        perror("Error allocating shared distances");
+        free(shared);
+        return NULL;
+    }
+    MPI_Comm_split_type(graph->comm, MPI_COMM_TYPE_SHARED, graph->rank, MPI_INFO_NULL, &shared->node_comm);
+    MPI_Comm_rank(shared->node_comm, &shared->node_rank);
+    MPI_Comm_size(shared->node_comm, &shared->node_size);
+
+    // One contiguous segment per host holding every co-located rank's block
+    int *base = NULL;
+    MPI_Aint bytes = (MPI_Aint)graph->local_nodes * (MPI_Aint)sizeof(int);
+    int status = MPI_Win_allocate_shared(bytes, sizeof(int), MPI_INFO_NULL, shared->node_comm, &base, &shared->win);
+    if (!all_ok(status == MPI_SUCCESS, graph->comm)) {
+        if (graph->rank == 0) {
+            fprintf(stderr, "Error: Failed to allocate the shared-memory window\n");
+        }
+        if (status == MPI_SUCCESS) {
+            MPI_Win_free(&shared->win);
+        }
+        MPI_Comm_free(&shared->node_comm);
+        free(shared);
+        return NULL;
+    }
+
+    shared->dist = (int**)malloc((size_t)shared->node_size * sizeof(int*));
+    shared->node_rank_of = (int*)malloc((size_t)graph->size * sizeof(int));
+    int *members = (int*)malloc((size_t)shared->node_size * sizeof(int));
+    if (!shared->dist || !shared->node_rank_of || !members) {
+        perror("Error allocating shared distances");
+        MPI_Abort(graph->comm, EXIT_FAILURE);
+    }
+    for (int i = 0; i < shared->node_size; i++) {
+        MPI_Aint size;
+        int disp_unit;
+        MPI_Win_shared_query(shared->win, i, &size, &disp_unit, &shared->dist[i]);
+    }
+    MPI_Allgather(&graph->rank, 1, MPI_INT, members, 1, MPI_INT, shared->node_comm);
+    for (int r = 0; r < graph->size; r++) {
+        shared->node_rank_of[r] = -1;
+    }
+    for (int i = 0; i < shared->node_size; i++) {
+        shared->node_rank_of[members[i]] = i;
+    }
+    free(members);
+
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, shared->win);
+    return shared;
+}
+
+void shared_distances_free(SharedDistances *shared) {
+    if (!shared) {
+        return;
+    }
+    MPI_Win_unlock_all(shared->win);
+    MPI_Win_free(&shared->win);
+    MPI_Comm_free(&shared->node_comm);
+    free(shared->dist);
+    free(shared->node_rank_of);
+    free(shared);
+}
+
+void dist_graph_gather_distances(const DistGraph *graph, const int *local_distances, int *all_distances, int root) {
+    int *counts = NULL;
+    int *displs = NULL;
+    if (graph->rank == root) {
+        counts = (int*)malloc((size_t)graph->size * sizeof(int));
+        displs = (int*)malloc((size_t)graph->size * sizeof(int));
+        for (int r = 0; r < graph->size; r++) {
+            displs[r] = partition_first(graph->num_nodes, graph->size, r);
+            counts[r] = partition_first(graph->num_nodes, graph->size, r + 1) - displs[r];
+        }
+    }
+    MPI_Gatherv(local_distances, graph->local_nodes, MPI_INT,
+                all_distances, counts, displs, MPI_INT, root, graph->comm);
+    free(counts);
+    free(displs);
+}
@@ -0,0 +1,105 @@
+#ifndef DIST_GRAPH_H
+#define DIST_GRAPH_H
+
+#include <mpi.h>
+#include "graph.h"
+
+// 1-D block partition of the vertex set across the ranks of a communicator.
+// Rank r owns the contiguous range [first_node, first_node + local_nodes)
+// and stores only those rows of the CSR; dest[] keeps global node ids.
+typedef struct {
+    int num_nodes;          // global node count
+    int num_edges;          // global undirected edge count
+    int max_weight;         // global maximum edge weight
+    int max_degree;         // global maximum node degree
+    int first_node;
+    int local_nodes;
+    int *offsets;           // local_nodes + 1 entries, rebased to start at 0
+    int *dest;              // global ids of neighbors
+    int *weight;
+    int rank;
+    int size;
+    int num_threads;        // OpenMP threads per rank, 1 unless built with OpenMP
+    VertexOrder order;      // numbering of the node ids (reordered binary graphs)
+    int *original_id;       // rank 0 of a reordered graph: input id of each node, NULL otherwise
+    MPI_Comm comm;
+} DistGraph;
+
+// First node owned by rank in a partition of num_nodes nodes over size ranks
+static inline int partition_first(int num_nodes, int size, int rank) {
+    return (int)((long long)rank * num_nodes / size);
+}
+
+// Rank that owns node
+static inline int partition_owner(int num_nodes, int size, int node) {
+    return (int)(((long long)(node + 1) * size - 1) / num_nodes);
+}
+
+static inline int dist_graph_owner(const DistGraph *graph, int node) {
+    return partition_owner(graph->num_nodes, graph->size, node);
+}
+
+static inline bool dist_graph_owns(const DistGraph *graph, int node) {
+    return node >= graph->first_node && node < graph->first_node + graph->local_nodes;
+}
+
+// Read filename (text or binary) in parallel with MPI-IO: each rank reads
+// only its share of the file and ends up with its block of rows. Text edges
+// are parsed by the rank that reads them and sent to their owners. Binary
+// graphs written with a vertex order (graph_convert --reorder) keep their
+// numbering; rank 0 also reads the order section.
+// Collective over comm; returns NULL on every rank if loading fails.
+DistGraph* dist_graph_read(const char *filename, MPI_Comm comm);
+
+// Node of input id on every rank. Collective over graph->comm.
+int dist_graph_node(const DistGraph *graph, int input_id);
+
+void free_dist_graph(DistGraph *graph);
+
+// Delta-stepping bucket width for the whole graph, as default_delta() in sssp.h
+int dist_graph_default_delta(const DistGraph *graph);
+
+// Distance blocks of the ranks sharing a host, allocated together in one
+// MPI-3 shared-memory segment per host (MPI_Comm_split_type shared +
+// MPI_Win_allocate_shared), so co-located ranks update each other's
+// distances directly instead of exchanging messages.
+typedef struct {
+    MPI_Comm node_comm;
+    MPI_Win win;
+    int node_rank;
+    int node_size;
+    int *node_rank_of;      // world rank -> rank in node_comm, -1 on another host
+    int **dist;             // distance block of each co-located rank
+} SharedDistances;
+
+// Collective over graph->comm. The window stays in a passive-target
+// (lock_all) epoch until shared_distances_free.
+SharedDistances* shared_distances_create(const DistGraph *graph);
+void shared_distances_free(SharedDistances *shared);
+
+// Distance slot of node if its owner shares this host, NULL otherwise
+static inline int* shared_distance_slot(const SharedDistances *shared, const DistGraph *graph, int node) {
+    if (!shared) {
+        return NULL;
+    }
+    int owner = dist_graph_owner(graph, node);
+    int node_rank = shared->node_rank_of[owner];
+    if (node_rank < 0) {
+        return NULL;
+    }
+    return shared->dist[node_rank] + (node - partition_first(graph->num_nodes, graph->size, owner));
+}
+
+// Make this rank's stores to the window visible to co-located ranks (and
+// theirs to it); pairs with the collectives that order the phases
+static inline void shared_distances_sync(const SharedDistances *shared) {
+    if (shared) {
+        MPI_Win_sync(shared->win);
+    }
+}
+
+// Gather the owned distance blocks into a num_nodes array on root
+// (all_distances may be NULL on other ranks). Collective over graph->comm.
+void dist_graph_gather_distances(const DistGraph *graph, const int *local_distances, int *all_distances, int root);
+
+#endif
@@ -0,0 +1,507 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <omp.h>
+#include "graph.h"
+
+// Chunks smaller than this are not worth handing to another thread
+#define MIN_PARSE_CHUNK (64 * 1024)
+
+Graph* build_graph(int num_nodes, int num_edges, const int *edge_u, const int *edge_v, const int *edge_w) {
+    Graph *graph = (Graph*)malloc(sizeof(Graph));
+    if (!graph) {
+        perror("Error allocating graph");
+        return NULL;
+    }
+    graph->num_nodes = num_nodes;
+    graph->num_edges = num_edges;
+    graph->max_weight = 0;
+    graph->mapping = NULL;
+    graph->mapping_size = 0;
+    graph->weight_storage = NULL;
+    graph->order = ORDER_INPUT;
+    graph->original_id = NULL;
+    graph->reordered_id = NULL;
+    graph->offsets = (int*)calloc((size_t)num_nodes + 1, sizeof(int));
+    if (!graph->offsets) {
+        perror("Error allocating graph");
+        free(graph);
+        return NULL;
+    }
+
+    // Count degrees into offsets[u + 1], then prefix-sum into row starts
+    int valid_edges = 0;
+    for (int i = 0; i < num_edges; i++) {
+        int u = edge_u[i];
+        int v = edge_v[i];
+        if (u < 0 || u >= num_nodes || v < 0 || v >= num_nodes) {
+            fprintf(stderr, "Error: Invalid edge (%d, %d) - nodes must be between 0 and %d\n",
+                    u, v, num_nodes - 1);
+            continue;
+        }
+        graph->offsets[u + 1]++;
+        graph->offsets[v + 1]++;
+        valid_edges++;
+    }
+    graph->num_edges = valid_edges;
+    for (int i = 0; i < num_nodes; i++) {
+        graph->offsets[i + 1] += graph->offsets[i];
+    }
+
+    size_t num_entries = (size_t)graph->offsets[num_nodes];
+    graph->dest = (int*)malloc((num_entries > 0 ? num_entries : 1) * sizeof(int));
+    graph->weight = (int*)malloc((num_entries > 0 ? num_entries : 1) * sizeof(int));
+    int *fill = (int*)malloc((size_t)num_nodes * sizeof(int));
+    if (!graph->dest || !graph->weight || !fill) {
+        perror("Error allocating graph");
+        free(fill);
+        free_graph(graph);
+        return NULL;
+    }
+    memcpy(fill, graph->offsets, (size_t)num_nodes * sizeof(int));
+
+    // Scatter both directions of every edge, preserving input order per node
+    for (int i = 0; i < num_edges; i++) {
+        int u = edge_u[i];
+        int v = edge_v[i];
+        if (u < 0 || u >= num_nodes || v < 0 || v >= num_nodes) {
+            continue;
+        }
+        int pos = fill[u]++;
+        graph->dest[pos] = v;
+        graph->weight[pos] = edge_w[i];
+        pos = fill[v]++;
+        graph->dest[pos] = u;
+        graph->weight[pos] = edge_w[i];
+        if (edge_w[i] > graph->max_weight) {
+            graph->max_weight = edge_w[i];
+        }
+    }
+
+    free(fill);
+    return graph;
+}
+
+void free_graph(Graph *graph) {
+    if (!graph) {
+        return;
+    }
+    if (graph->mapping) {
+        munmap(graph->mapping, graph->mapping_size);
+        free(graph->weight_storage);
+    } else {
+        free(graph->offsets);
+        free(graph->dest);
+        free(graph->weight);
+    }
+    free(graph->original_id);
+    free(graph->reordered_id);
+    free(graph);
+}
+
+int graph_first_touch(Graph *graph, int num_threads) {
+    if (num_threads <= 0) {
+        num_threads = omp_get_max_threads();
+    }
+    int num_nodes = graph->num_nodes;
+    size_t num_entries = (size_t)graph->offsets[num_nodes];
+    int *offsets = (int*)malloc(((size_t)num_nodes + 1) * sizeof(int));
+    int *dest = (int*)malloc((num_entries > 0 ? num_entries : 1) * sizeof(int));
+    int *weight = (int*)malloc((num_entries > 0 ? num_entries : 1) * sizeof(int));
+    if (!offsets || !dest || !weight) {
+        perror("Error allocating graph copy");
+        free(offsets);
+        free(dest);
+        free(weight);
+        return -1;
+    }
+
+    // Fresh malloc'd pages get their NUMA node on first write, so each
+    // thread copies the rows of its static block of nodes
+    #pragma omp parallel for num_threads(num_threads) schedule(static)
+    for (int v = 0; v < num_nodes; v++) {
+        int begin = graph->offsets[v];
+        size_t length = (size_t)(graph->offsets[v + 1] - begin);
+        offsets[v] = begin;
+        memcpy(dest + begin, graph->dest + begin, length * sizeof(int));
+        memcpy(weight + begin, graph->weight + begin, length * sizeof(int));
+    }
+    offsets[num_nodes] = (int)num_entries;
+
+    if (graph->mapping) {
+        munmap(graph->mapping, graph->mapping_size);
+        free(graph->weight_storage);
+        graph->mapping = NULL;
+        graph->mapping_size = 0;
+        graph->weight_storage = NULL;
+    } else {
+        free(graph->offsets);
+        free(graph->dest);
+        free(graph->weight);
+    }
+    graph->offsets = offsets;
+    graph->dest = dest;
+    graph->weight = weight;
+    return 0;
+}
+
+// Read-only view of a whole input file, memory-mapped when possible
+typedef struct {
+    const char *data;
+    size_t size;
+    bool mapped;
+} FileView;
+
+static bool open_file_view(const char *filename, FileView *view) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open file '%s'\n", filename);
+        perror("open");
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        view->size = (size_t)st.st_size;
+        view->mapped = true;
+        if (view->size == 0) {
+            view->data = "";
+            close(fd);
+            return true;
+        }
+        void *addr = mmap(NULL, view->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            madvise(addr, view->size, MADV_SEQUENTIAL);
+            view->data = (const char*)addr;
+            close(fd);
+            return true;
+        }
+    }
+
+    // Not mappable (pipe, special file): fall back to reading it into memory
+    size_t capacity = 1 << 20;
+    size_t size = 0;
+    char *buffer = (char*)malloc(capacity);
+    ssize_t n;
+    while (buffer && (n = read(fd, buffer + size, capacity - size)) > 0) {
+        size += (size_t)n;
+        if (size == capacity) {
+            capacity *= 2;
+            char *grown = (char*)realloc(buffer, capacity);
+            if (!grown) {
+                free(buffer);
+            }
+            buffer = grown;
+        }
+    }
+    close(fd);
+    if (!buffer) {
+        perror("Error reading file");
+        return false;
+    }
+    view->data = buffer;
+    view->size = size;
+    view->mapped = false;
+    return true;
+}
+
+static void close_file_view(FileView *view) {
+    if (view->mapped) {
+        if (view->size > 0) {
+            munmap((void*)view->data, view->size);
+        }
+    } else {
+        free((void*)view->data);
+    }
+}
+
+static inline bool is_space(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+}
+
+// Parse one decimal integer starting at *p (leading whitespace skipped).
+// Returns false at end of input or on a character that cannot start a number.
+static inline bool parse_int(const char **p, const char *end, int *value) {
+    const char *s = *p;
+    while (s < end && is_space(*s)) {
+        s++;
+    }
+    if (s == end) {
+        *p = s;
+        return false;
+    }
+    bool negative = false;
+    if (*s == '-' || *s == '+') {
+        negative = (*s == '-');
+        s++;
+    }
+    if (s == end || (unsigned)(*s - '0') > 9) {
+        *p = s;
+        return false;
+    }
+    long long result = 0;
+    while (s < end && (unsigned)(*s - '0') <= 9) {
+        result = result * 10 + (*s - '0');
+        s++;
+    }
+    *p = s;
+    *value = (int)(negative ? -result : result);
+    return true;
+}
+
+static void report_bad_header(const char *data, size_t size, const char *filename, int fields) {
+    if (size == 0) {
+        fprintf(stderr, "Error: Failed to read first line from '%s'\n", filename);
+        return;
+    }
+    fprintf(stderr, "Error: Failed to parse graph header from '%s'\n", filename);
+    fprintf(stderr, "First line (as read): '");
+    for (size_t i = 0; i < size && i < 50; i++) {
+        unsigned char c = (unsigned char)data[i];
+        if (c >= 32 && c < 127) {
+            fprintf(stderr, "%c", c);
+        } else if (c == '\n') {
+            fprintf(stderr, "\\n");
+            break;
+        } else if (c == '\r') {
+            fprintf(stderr, "\\r");
+        } else if (c == '\t') {
+            fprintf(stderr, "\\t");
+        } else {
+            fprintf(stderr, "\\x%02x", c);
+        }
+    }
+    fprintf(stderr, "'\n");
+    fprintf(stderr, "Expected format: '<num_nodes> <num_edges>' (two integers)\n");
+    fprintf(stderr, "Parsed %d of 2 header fields\n", fields);
+}
+
+bool parse_graph_header(const char *data, size_t size, const char *filename,
+                        int *num_nodes, int *num_edges, size_t *body_offset) {
+    const char *p = data;
+    const char *end = data + size;
+
+    if (size >= 3 && (unsigned char)p[0] == 0xEF && (unsigned char)p[1] == 0xBB && (unsigned char)p[2] == 0xBF) {
+        p += 3;
+    }
+
+    int fields = 0;
+    if (parse_int(&p, end, num_nodes)) {
+        fields++;
+        if (parse_int(&p, end, num_edges)) {
+            fields++;
+        }
+    }
+    if (fields != 2) {
+        report_bad_header(data, size, filename, fields);
+        return false;
+    }
+
+    if (*num_nodes <= 0 || *num_edges < 0) {
+        fprintf(stderr, "Error: Invalid graph size: %d nodes, %d edges\n", *num_nodes, *num_edges);
+        return false;
+    }
+    *body_offset = (size_t)(p - data);
+    return true;
+}
+
+long long parse_edge_list(const char *body, size_t size, int max_edges, int num_threads,
+                          int **edge_u_out, int **edge_v_out, int **edge_w_out, bool *malformed_out) {
+    int num_chunks = (num_threads > 0) ? num_threads : omp_get_max_threads();
+    if ((size_t)num_chunks > size / MIN_PARSE_CHUNK) {
+        num_chunks = (int)(size / MIN_PARSE_CHUNK);
+    }
+    if (num_chunks < 1) {
+        num_chunks = 1;
+    }
+
+    // Chunk c covers [bounds[c], bounds[c + 1]); interior bounds sit just after a newline
+    size_t *bounds = (size_t*)malloc(((size_t)num_chunks + 1) * sizeof(size_t));
+    long long *line_offsets = (long long*)calloc((size_t)num_chunks + 1, sizeof(long long));
+    long long *parsed = (long long*)calloc((size_t)num_chunks, sizeof(long long));
+    bool *malformed = (bool*)calloc((size_t)num_chunks, sizeof(bool));
+    if (!bounds || !line_offsets || !parsed || !malformed) {
+        perror("Error allocating parser state");
+        free(bounds);
+        free(line_offsets);
+        free(parsed);
+        free(malformed);
+        return -1;
+    }
+    bounds[0] = 0;
+    for (int c = 1; c < num_chunks; c++) {
+        size_t pos = size / num_chunks * c;
+        if (pos < bounds[c - 1]) {
+            pos = bounds[c - 1];
+        }
+        const char *nl = (const char*)memchr(body + pos, '\n', size - pos);
+        bounds[c] = nl ? (size_t)(nl - body) + 1 : size;
+    }
+    bounds[num_chunks] = size;
+
+    // Pass 1: an upper bound on the edges in each chunk is its line count
+    #pragma omp parallel for num_threads(num_chunks)
+    for (int c = 0; c < num_chunks; c++) {
+        const char *p = body + bounds[c];
+        const char *end = body + bounds[c + 1];
+        long long lines = 0;
+        while (p < end) {
+            const char *nl = (const char*)memchr(p, '\n', (size_t)(end - p));
+            lines++;
+            p = nl ? nl + 1 : end;
+        }
+        line_offsets[c + 1] = lines;
+    }
+    for (int c = 0; c < num_chunks; c++) {
+        line_offsets[c + 1] += line_offsets[c];
+    }
+
+    size_t capacity = line_offsets[num_chunks] > 0 ? (size_t)line_offsets[num_chunks] : 1;
+    int *edge_u = (int*)malloc(capacity * sizeof(int));
+    int *edge_v = (int*)malloc(capacity * sizeof(int));
+    int *edge_w = (int*)malloc(capacity * sizeof(int));
+    if (!edge_u || !edge_v || !edge_w) {
+        perror("Error allocating edge list");
+        free(edge_u);
+        free(edge_v);
+        free(edge_w);
+        free(bounds);
+        free(line_offsets);
+        free(parsed);
+        free(malformed);
+        return -1;
+    }
+
+    // Pass 2: parse each chunk into its reserved slice of the edge arrays,
+    // stopping at the chunk's first malformed line
+    #pragma omp parallel for num_threads(num_chunks)
+    for (int c = 0; c < num_chunks; c++) {
+        const char *p = body + bounds[c];
+        const char *end = body + bounds[c + 1];
+        long long out = line_offsets[c];
+        long long limit = line_offsets[c + 1];
+        int u, v, w;
+        while (out < limit && parse_int(&p, end, &u)) {
+            if (!parse_int(&p, end, &v) || !parse_int(&p, end, &w)) {
+                malformed[c] = true;
+                break;
+            }
+            edge_u[out] = u;
+            edge_v[out] = v;
+            edge_w[out] = w;
+            out++;
+        }
+        while (p < end && is_space(*p)) {
+            p++;
+        }
+        if (p < end) {
+            malformed[c] = true;    // stray token: more than one edge on a line or garbage
+        }
+        parsed[c] = out - line_offsets[c];
+    }
+
+    // Close gaps left by blank lines so edges are contiguous in file order.
+    // Only the first max_edges edges are read: anything after them, even a
+    // malformed line, is ignored, and edges after a malformed line are dropped.
+    long long total = 0;
+    *malformed_out = false;
+    for (int c = 0; c < num_chunks && total < max_edges; c++) {
+        if (total != line_offsets[c] && parsed[c] > 0) {
+            memmove(edge_u + total, edge_u + line_offsets[c], (size_t)parsed[c] * sizeof(int));
+            memmove(edge_v + total, edge_v + line_offsets[c], (size_t)parsed[c] * sizeof(int));
+            memmove(edge_w + total, edge_w + line_offsets[c], (size_t)parsed[c] * sizeof(int));
+        }
+        total += parsed[c];
+        if (malformed[c] && total < max_edges) {
+            *malformed_out = true;
+            break;
+        }
+    }
+
+    free(bounds);
+    free(line_offsets);
+    free(parsed);
+    free(malformed);
+
+    *edge_u_out = edge_u;
+    *edge_v_out = edge_v;
+    *edge_w_out = edge_w;
+    return (total > max_edges) ? max_edges : total;
+}
+
+long long first_negative_weight(const int *weight, long long count) {
+    for (long long i = 0; i < count; i++) {
+        if (weight[i] < 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+Graph* read_graph_from_file(const char *filename) {
+    FileView view;
+    if (!open_file_view(filename, &view)) {
+        return NULL;
+    }
+
+    if (is_binary_graph(view.data, view.size)) {
+        // Hand a mapped file over to the graph so the arrays are used in place
+        void *mapping = view.mapped ? (void*)view.data : NULL;
+        Graph *graph = load_graph_binary(view.data, view.size, filename, mapping, view.size);
+        if (!view.mapped || !graph) {
+            close_file_view(&view);
+        }
+        return graph;
+    }
+
+    int num_nodes, num_edges;
+    size_t body_offset;
+    if (!parse_graph_header(view.data, view.size, filename, &num_nodes, &num_edges, &body_offset)) {
+        close_file_view(&view);
+        return NULL;
+    }
+
+    int *edge_u = NULL;
+    int *edge_v = NULL;
+    int *edge_w = NULL;
+    bool malformed = false;
+    long long parsed = parse_edge_list(view.data + body_offset, view.size - body_offset, num_edges, 0,
+                                       &edge_u, &edge_v, &edge_w, &malformed);
+    close_file_view(&view);
+
+    if (parsed < 0) {
+        return NULL;
+    }
+    if (parsed < num_edges) {
+        if (malformed) {
+            fprintf(stderr, "Error: Malformed edge list in '%s' (expected one 'u v w' triple per line)\n", filename);
+        } else {
+            fprintf(stderr, "Error: Failed to read edge %lld\n", parsed);
+        }
+        free(edge_u);
+        free(edge_v);
+        free(edge_w);
+        return NULL;
+    }
+
+    long long negative = first_negative_weight(edge_w, num_edges);
+    if (negative >= 0) {
+        fprintf(stderr, "Error: Negative weight %d on edge %lld in '%s' (weights must be non-negative)\n",
+                edge_w[negative], negative, filename);
+        free(edge_u);
+        free(edge_v);
+        free(edge_w);
+        return NULL;
+    }
+
+    Graph *graph = build_graph(num_nodes, num_edges, edge_u, edge_v, edge_w);
+
+    free(edge_u);
+    free(edge_v);
+    free(edge_w);
+    return graph;
+}
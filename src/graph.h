@@ -0,0 +1,222 @@
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define INF INT_MAX
+
+// Node numberings (graph_reorder.c). Input ids are arbitrary, so the
+// neighbors of a node sit at random places in per-node arrays such as
+// distances[]; renumbering nodes that are close in the graph to nearby ids
+// turns relaxation into mostly local accesses.
+typedef enum {
+    ORDER_INPUT,    // ids as in the input file
+    ORDER_RCM,      // reverse Cuthill-McKee: BFS from a pseudo-peripheral node, neighbors by increasing degree, reversed
+    ORDER_BFS,      // BFS from the lowest unnumbered id, neighbors in adjacency order
+    ORDER_DEGREE    // decreasing degree, so the hubs share a few cache lines
+} VertexOrder;
+
+// Undirected weighted graph in compressed sparse row (CSR) form.
+// The neighbors of node u are dest[offsets[u]] .. dest[offsets[u + 1] - 1],
+// with the matching edge weights at the same positions in weight[].
+// Every input edge is stored twice (once per endpoint).
+typedef struct {
+    int num_nodes;
+    int num_edges;    // number of valid undirected edges read from the input
+    int max_weight;   // largest edge weight, 0 for an edgeless graph
+    int *offsets;     // num_nodes + 1 entries
+    int *dest;        // offsets[num_nodes] entries
+    int *weight;      // offsets[num_nodes] entries
+    void *mapping;    // mmap'd binary file the arrays point into, NULL if heap-allocated
+    size_t mapping_size;
+    int *weight_storage;  // widened copy of narrow on-disk weights (mapped graphs only)
+    VertexOrder order;    // numbering of the node ids
+    int *original_id;     // reordered graphs: input id of each node, NULL otherwise
+    int *reordered_id;    // reordered graphs: node of each input id, NULL otherwise
+} Graph;
+
+// Build a CSR graph from an edge list of num_edges (u, v, w) triples.
+// Edges whose endpoints fall outside [0, num_nodes) are reported and skipped.
+Graph* build_graph(int num_nodes, int num_edges, const int *edge_u, const int *edge_v, const int *edge_w);
+
+// Read a graph in either the binary format below or the
+// "<num_nodes> <num_edges>" + "u v w" per line text format.
+// A leading UTF-8 BOM is skipped. Returns NULL on error.
+Graph* read_graph_from_file(const char *filename);
+
+// Parse the "<num_nodes> <num_edges>" header at the start of a text graph
+// (after an optional BOM) and validate it. On success the edge lines start
+// at data + *body_offset; on failure the problem is reported and false returned.
+bool parse_graph_header(const char *data, size_t size, const char *filename,
+                        int *num_nodes, int *num_edges, size_t *body_offset);
+
+// Parse the "u v w" lines in body[0, size) on num_threads threads (<= 0 for
+// omp_get_max_threads()). The body is split into newline-aligned chunks; each
+// thread counts the lines in its chunk, and after a prefix sum parses its
+// edges straight into the shared arrays. Returns the number of edges parsed
+// (at most max_edges), or -1 on allocation failure; the arrays are allocated
+// with malloc and owned by the caller. Input after the first max_edges edges
+// is ignored. A malformed line before that point sets *malformed and ends
+// the list: the count returned is then the number of edges before it.
+long long parse_edge_list(const char *body, size_t size, int max_edges, int num_threads,
+                          int **edge_u_out, int **edge_v_out, int **edge_w_out, bool *malformed);
+
+// The engines need non-negative weights (Dial and the radix heap index
+// buckets by distance), so every loader rejects a negative one: returns the
+// index of the first negative weight in weight[0, count), or -1 if none
+long long first_negative_weight(const int *weight, long long count);
+
+// Binary graph container (graph_binary.c), native byte order:
+//   GraphFileHeader, then the offsets, dest and weight arrays, each starting
+//   on a GRAPH_FILE_ALIGN boundary and zero-padded to the next one.
+// The checksum covers every byte after the header. Loading maps the file and
+// uses the arrays in place, so startup cost does not grow with parse work.
+// A reordered graph records its VertexOrder in flags and the input id of
+// every node in a section at order_pos; it is written as version
+// GRAPH_FILE_VERSION_ORDERED so older readers reject it instead of
+// reporting renumbered ids.
+#define GRAPH_FILE_MAGIC "DJKGRAPH"
+#define GRAPH_FILE_VERSION 1
+#define GRAPH_FILE_VERSION_ORDERED 2
+#define GRAPH_FILE_ALIGN 64
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t weight_bytes;    // 1, 2 or 4
+    uint64_t num_nodes;
+    uint64_t num_edges;       // undirected edges
+    uint64_t num_entries;     // CSR entries, normally 2 * num_edges
+    uint64_t offsets_pos;     // byte offsets of the arrays in the file
+    uint64_t dest_pos;
+    uint64_t weight_pos;
+    uint64_t file_size;
+    uint64_t checksum;
+    int32_t max_weight;
+    uint32_t flags;           // VertexOrder of the node ids, 0 (ORDER_INPUT) for input ids
+    uint64_t level_pos;       // hierarchy files: per-node level section, 0 otherwise
+    uint64_t order_pos;       // reordered graphs: original_id section, 0 otherwise
+    uint8_t reserved[24];
+} GraphFileHeader;
+
+bool is_binary_graph(const void *data, size_t size);
+
+// Validate the version, vertex order, weight width, sizes and section layout of a header
+// read from a file of size bytes (the checksum is not checked). Reports and
+// returns false on a mismatch.
+bool check_graph_header(const GraphFileHeader *header, uint64_t size, const char *filename);
+
+// Build a graph from a binary image of size bytes. When mapping is non-NULL
+// the image lives in that mapping and the graph takes ownership of it (the
+// arrays are used in place); otherwise the arrays are copied.
+Graph* load_graph_binary(const void *data, size_t size, const char *filename, void *mapping, size_t mapping_size);
+
+// Write graph in the binary format (with its order section if it was
+// reordered); weight_bytes is 1, 2 or 4. Returns 0 on success, -1 on error.
+int write_graph_binary(const Graph *graph, const char *filename, int weight_bytes);
+
+// Write graph as a text edge list (each undirected edge once, with input
+// ids if it was reordered). Returns 0 on success.
+int write_graph_text(const Graph *graph, const char *filename);
+
+void free_graph(Graph *graph);
+
+// Move the CSR arrays to fresh heap memory, copying the rows of each
+// schedule(static) block of nodes on the thread that owns the block, so on
+// NUMA systems a row lives on the node of the thread that scans it (pin the
+// threads first, see bind_threads). Mapped binary graphs become
+// heap-allocated. num_threads <= 0 uses omp_get_max_threads(). Returns 0 on
+// success, -1 on allocation failure (the graph is left unchanged).
+int graph_first_touch(Graph *graph, int num_threads);
+
+// Map "input" / "rcm" / "bfs" / "degree" to an order; returns false for unknown names
+bool parse_vertex_order(const char *name, VertexOrder *order);
+const char* vertex_order_name(VertexOrder order);
+
+// Renumber the nodes of graph in the given order, computed on its current
+// adjacency (ORDER_INPUT restores the input ids). The CSR arrays are
+// replaced by permuted heap copies, built on num_threads threads (<= 0 for
+// omp_get_max_threads()), so mapped binary graphs become heap-allocated;
+// original_id and reordered_id record the renumbering. Returns 0 on
+// success, -1 on allocation failure (the graph is left unchanged).
+int reorder_graph(Graph *graph, VertexOrder order, int num_threads);
+
+// Node of input id in graph, and the input id of node
+static inline int graph_node(const Graph *graph, int input_id) {
+    return graph->reordered_id ? graph->reordered_id[input_id] : input_id;
+}
+
+static inline int graph_input_id(const Graph *graph, int node) {
+    return graph->original_id ? graph->original_id[node] : node;
+}
+
+// Permute a per-node array of a reordered graph, such as distances, from
+// node order to input order in place: values[original_id[v]] receives the
+// old values[v]. Does nothing when original_id is NULL. Returns 0 on
+// success, -1 on allocation failure.
+int restore_input_order(int *values, const int *original_id, int num_nodes, int num_threads);
+
+// Landmark distance tables for ALT queries, stored node-major so the
+// distances of one node to every landmark are contiguous:
+// dist[node * num_landmarks + l] is the distance from landmarks[l] to node.
+typedef struct {
+    int num_landmarks;
+    int num_nodes;
+    int *landmarks;
+    int *dist;
+} LandmarkTable;
+
+// Landmark files use the binary graph container with magic
+// LANDMARK_FILE_MAGIC: num_nodes, num_edges and flags (its VertexOrder)
+// describe the graph the tables belong to, num_entries is the landmark count, the offsets section
+// holds the landmark ids and the dest section the distance table (the
+// weight section is empty). Returns 0 on success, -1 on error.
+#define LANDMARK_FILE_MAGIC "DJKLANDM"
+
+int write_landmarks_binary(const LandmarkTable *table, const Graph *graph, const char *filename);
+// Read tables for graph, rejecting files built for a different graph
+// (node or edge count or vertex order mismatch) or failing the checksum.
+// NULL on error.
+LandmarkTable* read_landmarks_binary(const char *filename, const Graph *graph);
+void free_landmarks(LandmarkTable *table);
+
+// Distance dumps use the binary graph container with magic
+// DISTANCE_FILE_MAGIC: num_entries is num_nodes, the offsets section holds
+// the source id and the dest section the num_nodes distances as 4-byte
+// ints (INF = INT_MAX), so a reader can map the file and index the array
+// in place. Returns 0 on success, -1 on error.
+#define DISTANCE_FILE_MAGIC "DJKDISTS"
+
+int write_distances_binary(const int *distances, int num_nodes, int source, const char *filename);
+
+// Contraction hierarchy (see contract_graph in sssp.h). up holds, for
+// every node, its edges and shortcuts to nodes contracted later; level[v] is
+// the round in which v was contracted, or CH_CORE_LEVEL for nodes left in
+// the uncontracted core, whose edges to each other appear in both directions.
+#define CH_CORE_LEVEL INT_MAX
+
+typedef struct {
+    Graph *up;
+    int *level;
+} ContractionHierarchy;
+
+// Hierarchy files use the binary graph container with magic
+// HIERARCHY_FILE_MAGIC and 4-byte weights for the upward graph, followed by
+// the level section at level_pos. num_nodes, num_edges and flags are those
+// of the graph it was built from; num_entries counts the upward edges.
+#define HIERARCHY_FILE_MAGIC "DJKCHIER"
+
+int write_hierarchy_binary(const ContractionHierarchy *ch, const char *filename);
+// Read the hierarchy for graph, rejecting files built for a different graph
+// or failing the checksum. NULL on error.
+ContractionHierarchy* read_hierarchy_binary(const char *filename, const Graph *graph);
+void free_hierarchy(ContractionHierarchy *ch);
+
+static inline int graph_degree(const Graph *graph, int node) {
+    return graph->offsets[node + 1] - graph->offsets[node];
+}
+
+#endif
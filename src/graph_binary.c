@@ -0,0 +1,643 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "graph.h"
+
+#define CHECKSUM_SEED  0xcbf29ce484222325ULL
+#define CHECKSUM_PRIME 0x100000001b3ULL
+
+_Static_assert(sizeof(GraphFileHeader) == 128, "GraphFileHeader must stay 128 bytes");
+
+static inline uint64_t align_up(uint64_t value) {
+    return (value + GRAPH_FILE_ALIGN - 1) & ~(uint64_t)(GRAPH_FILE_ALIGN - 1);
+}
+
+// FNV-1a over 64-bit little-endian words; bytes must be a multiple of 8
+static uint64_t checksum_words(uint64_t hash, const void *data, size_t bytes) {
+    const unsigned char *p = (const unsigned char*)data;
+    for (size_t i = 0; i < bytes; i += 8) {
+        uint64_t word;
+        memcpy(&word, p + i, sizeof(word));
+        hash = (hash ^ word) * CHECKSUM_PRIME;
+    }
+    return hash;
+}
+
+bool is_binary_graph(const void *data, size_t size) {
+    return size >= sizeof(GraphFileHeader) && memcmp(data, GRAPH_FILE_MAGIC, 8) == 0;
+}
+
+bool check_graph_header(const GraphFileHeader *header, uint64_t size, const char *filename) {
+    if (header->version != GRAPH_FILE_VERSION && header->version != GRAPH_FILE_VERSION_ORDERED) {
+        fprintf(stderr, "Error: '%s' has binary format version %u (expected %d or %d)\n",
+                filename, header->version, GRAPH_FILE_VERSION, GRAPH_FILE_VERSION_ORDERED);
+        return false;
+    }
+    // Only reordered graphs carry an order section, and only in the newer version
+    bool ordered = header->version == GRAPH_FILE_VERSION_ORDERED;
+    if (header->flags > ORDER_DEGREE || ordered != (header->order_pos != 0) ||
+        (ordered && header->flags == ORDER_INPUT)) {
+        fprintf(stderr, "Error: '%s' has an invalid vertex order (flags %u)\n", filename, header->flags);
+        return false;
+    }
+    if (header->weight_bytes != 1 && header->weight_bytes != 2 && header->weight_bytes != 4) {
+        fprintf(stderr, "Error: '%s' has unsupported weight width %u\n", filename, header->weight_bytes);
+        return false;
+    }
+    if (header->num_nodes == 0 || header->num_nodes >= INT_MAX || header->num_edges > INT_MAX ||
+        header->num_entries >= INT_MAX) {
+        fprintf(stderr, "Error: Invalid graph size in '%s': %llu nodes, %llu edges\n", filename,
+                (unsigned long long)header->num_nodes, (unsigned long long)header->num_edges);
+        return false;
+    }
+    uint64_t offsets_end = header->offsets_pos + (header->num_nodes + 1) * sizeof(int);
+    uint64_t dest_end = header->dest_pos + header->num_entries * sizeof(int);
+    uint64_t weight_end = header->weight_pos + header->num_entries * header->weight_bytes;
+    uint64_t order_end = header->order_pos + header->num_nodes * sizeof(int);
+    if (header->file_size != size || header->offsets_pos < sizeof(GraphFileHeader) ||
+        header->offsets_pos % GRAPH_FILE_ALIGN || header->dest_pos % GRAPH_FILE_ALIGN ||
+        header->weight_pos % GRAPH_FILE_ALIGN || header->order_pos % GRAPH_FILE_ALIGN ||
+        (size - sizeof(GraphFileHeader)) % 8 || offsets_end > size || dest_end > size || weight_end > size ||
+        (header->order_pos != 0 && order_end > size)) {
+        fprintf(stderr, "Error: '%s' is truncated or has an inconsistent layout\n", filename);
+        return false;
+    }
+    return true;
+}
+
+// Copy the original_id section of a reordered graph and build its inverse,
+// rejecting a section that is not a permutation of the node ids
+static bool load_order_section(Graph *graph, const int *section, const char *filename) {
+    size_t bytes = (size_t)graph->num_nodes * sizeof(int);
+    graph->original_id = (int*)malloc(bytes);
+    graph->reordered_id = (int*)malloc(bytes);
+    if (!graph->original_id || !graph->reordered_id) {
+        perror("Error allocating vertex order");
+        return false;
+    }
+    memcpy(graph->original_id, section, bytes);
+    for (int v = 0; v < graph->num_nodes; v++) {
+        graph->reordered_id[v] = -1;
+    }
+    for (int v = 0; v < graph->num_nodes; v++) {
+        int id = graph->original_id[v];
+        if (id < 0 || id >= graph->num_nodes || graph->reordered_id[id] >= 0) {
+            fprintf(stderr, "Error: '%s' has an invalid order section\n", filename);
+            return false;
+        }
+        graph->reordered_id[id] = v;
+    }
+    return true;
+}
+
+// Build a graph from a CSR image whose magic the caller has already checked
+static Graph* load_csr_image(const void *data, size_t size, const char *filename, void *mapping, size_t mapping_size) {
+    GraphFileHeader header;
+    memcpy(&header, data, sizeof(header));
+
+    if (!check_graph_header(&header, size, filename)) {
+        return NULL;
+    }
+
+    const unsigned char *base = (const unsigned char*)data;
+    uint64_t checksum = checksum_words(CHECKSUM_SEED, base + sizeof(GraphFileHeader),
+                                       size - sizeof(GraphFileHeader));
+    if (checksum != header.checksum) {
+        fprintf(stderr, "Error: Checksum mismatch in '%s' (file is corrupt)\n", filename);
+        return NULL;
+    }
+
+    const int *offsets_check = (const int*)(base + header.offsets_pos);
+    if (offsets_check[0] != 0 || (uint64_t)offsets_check[header.num_nodes] != header.num_entries) {
+        fprintf(stderr, "Error: '%s' has an inconsistent offsets array\n", filename);
+        return NULL;
+    }
+
+    Graph *graph = (Graph*)calloc(1, sizeof(Graph));
+    if (!graph) {
+        perror("Error allocating graph");
+        return NULL;
+    }
+    graph->num_nodes = (int)header.num_nodes;
+    graph->num_edges = (int)header.num_edges;
+    graph->max_weight = header.max_weight;
+    graph->order = (VertexOrder)header.flags;
+    if (header.order_pos != 0 && !load_order_section(graph, (const int*)(base + header.order_pos), filename)) {
+        free_graph(graph);
+        return NULL;
+    }
+
+    size_t num_entries = (size_t)header.num_entries;
+    size_t offsets_bytes = ((size_t)header.num_nodes + 1) * sizeof(int);
+    size_t dest_bytes = num_entries * sizeof(int);
+    const void *offsets_src = base + header.offsets_pos;
+    const void *dest_src = base + header.dest_pos;
+    const void *weight_src = base + header.weight_pos;
+
+    // Narrower weights are stored unsigned
+    long long negative = (header.weight_bytes == sizeof(int))
+                         ? first_negative_weight((const int*)weight_src, (long long)num_entries) : -1;
+    if (negative >= 0) {
+        fprintf(stderr, "Error: '%s' has a negative edge weight (%d)\n", filename, ((const int*)weight_src)[negative]);
+        free_graph(graph);
+        return NULL;
+    }
+
+    int *weight = NULL;
+    if (header.weight_bytes != sizeof(int)) {
+        weight = (int*)malloc((num_entries > 0 ? num_entries : 1) * sizeof(int));
+        if (!weight) {
+            perror("Error allocating weights");
+            free_graph(graph);
+            return NULL;
+        }
+        for (size_t i = 0; i < num_entries; i++) {
+            weight[i] = (header.weight_bytes == 1) ? ((const uint8_t*)weight_src)[i]
+                                                   : ((const uint16_t*)weight_src)[i];
+        }
+    }
+
+    if (mapping) {
+        // Zero-copy: the arrays stay in the mapped file
+        graph->mapping = mapping;
+        graph->mapping_size = mapping_size;
+        graph->offsets = (int*)offsets_src;
+        graph->dest = (int*)dest_src;
+        graph->weight = weight ? weight : (int*)weight_src;
+        graph->weight_storage = weight;
+        madvise(mapping, mapping_size, MADV_NORMAL);
+        return graph;
+    }
+
+    graph->offsets = (int*)malloc(offsets_bytes);
+    graph->dest = (int*)malloc(dest_bytes > 0 ? dest_bytes : sizeof(int));
+    graph->weight = weight ? weight : (int*)malloc(dest_bytes > 0 ? dest_bytes : sizeof(int));
+    if (!graph->offsets || !graph->dest || !graph->weight) {
+        perror("Error allocating graph");
+        free_graph(graph);
+        return NULL;
+    }
+    memcpy(graph->offsets, offsets_src, offsets_bytes);
+    memcpy(graph->dest, dest_src, dest_bytes);
+    if (!weight) {
+        memcpy(graph->weight, weight_src, dest_bytes);
+    }
+    return graph;
+}
+
+Graph* load_graph_binary(const void *data, size_t size, const char *filename, void *mapping, size_t mapping_size) {
+    if (!is_binary_graph(data, size)) {
+        fprintf(stderr, "Error: '%s' is not a binary graph file\n", filename);
+        return NULL;
+    }
+    return load_csr_image(data, size, filename, mapping, mapping_size);
+}
+
+// Write bytes of data followed by zero padding up to padded_bytes, updating the checksum
+static int write_section(FILE *file, const void *data, size_t bytes, size_t padded_bytes, uint64_t *checksum) {
+    static const unsigned char zeros[GRAPH_FILE_ALIGN] = {0};
+    size_t whole = bytes & ~(size_t)7;
+    if (fwrite(data, 1, bytes, file) != bytes) {
+        return -1;
+    }
+    *checksum = checksum_words(*checksum, data, whole);
+    if (whole < bytes) {
+        unsigned char tail[8] = {0};
+        memcpy(tail, (const unsigned char*)data + whole, bytes - whole);
+        *checksum = checksum_words(*checksum, tail, sizeof(tail));
+        whole += 8;
+    }
+    size_t padding = padded_bytes - bytes;
+    if (padding > 0 && fwrite(zeros, 1, padding, file) != padding) {
+        return -1;
+    }
+    *checksum = checksum_words(*checksum, zeros, padded_bytes - whole);
+    return 0;
+}
+
+// Write graph as a CSR image tagged with magic, followed by a per-node
+// level section when level is non-NULL and the order section when the
+// graph was reordered
+static int write_csr_image(const Graph *graph, const int *level, const char *filename, int weight_bytes,
+                           const char *magic) {
+    if (weight_bytes != 1 && weight_bytes != 2 && weight_bytes != 4) {
+        fprintf(stderr, "Error: Weight width must be 1, 2 or 4 bytes\n");
+        return -1;
+    }
+    size_t num_entries = (size_t)graph->offsets[graph->num_nodes];
+    if (weight_bytes < 4) {
+        int limit = (weight_bytes == 1) ? UINT8_MAX : UINT16_MAX;
+        for (size_t i = 0; i < num_entries; i++) {
+            if (graph->weight[i] < 0 || graph->weight[i] > limit) {
+                fprintf(stderr, "Error: Weight %d does not fit in %d byte(s)\n", graph->weight[i], weight_bytes);
+                return -1;
+            }
+        }
+    }
+
+    GraphFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, magic, 8);
+    header.version = GRAPH_FILE_VERSION;
+    header.weight_bytes = (uint32_t)weight_bytes;
+    header.num_nodes = (uint64_t)graph->num_nodes;
+    header.num_edges = (uint64_t)graph->num_edges;
+    header.num_entries = num_entries;
+    header.max_weight = graph->max_weight;
+    header.flags = (uint32_t)graph->order;
+
+    size_t offsets_bytes = ((size_t)graph->num_nodes + 1) * sizeof(int);
+    size_t dest_bytes = num_entries * sizeof(int);
+    size_t weight_data_bytes = num_entries * (size_t)weight_bytes;
+    header.offsets_pos = align_up(sizeof(GraphFileHeader));
+    header.dest_pos = align_up(header.offsets_pos + offsets_bytes);
+    header.weight_pos = align_up(header.dest_pos + dest_bytes);
+    header.file_size = align_up(header.weight_pos + weight_data_bytes);
+    size_t level_bytes = level ? offsets_bytes - sizeof(int) : 0;
+    if (level) {
+        header.level_pos = header.file_size;
+        header.file_size = align_up(header.level_pos + level_bytes);
+    }
+    size_t order_bytes = graph->original_id ? offsets_bytes - sizeof(int) : 0;
+    if (graph->original_id) {
+        header.version = GRAPH_FILE_VERSION_ORDERED;
+        header.order_pos = header.file_size;
+        header.file_size = align_up(header.order_pos + order_bytes);
+    }
+
+    // Narrow weights are packed into a temporary buffer before writing
+    const void *weight_data = graph->weight;
+    void *packed = NULL;
+    if (weight_bytes < 4) {
+        packed = malloc(weight_data_bytes > 0 ? weight_data_bytes : 1);
+        if (!packed) {
+            perror("Error allocating weights");
+            return -1;
+        }
+        for (size_t i = 0; i < num_entries; i++) {
+            if (weight_bytes == 1) {
+                ((uint8_t*)packed)[i] = (uint8_t)graph->weight[i];
+            } else {
+                ((uint16_t*)packed)[i] = (uint16_t)graph->weight[i];
+            }
+        }
+        weight_data = packed;
+    }
+
+    FILE *file = fopen(filename, "wb");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot open file '%s' for writing\n", filename);
+        perror("fopen");
+        free(packed);
+        return -1;
+    }
+
+    // Header goes out first with a zero checksum and is rewritten at the end
+    uint64_t checksum = CHECKSUM_SEED;
+    int status = 0;
+    if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+        write_section(file, graph->offsets, offsets_bytes, header.dest_pos - header.offsets_pos, &checksum) != 0 ||
+        write_section(file, graph->dest, dest_bytes, header.weight_pos - header.dest_pos, &checksum) != 0 ||
+        write_section(file, weight_data, weight_data_bytes, align_up(weight_data_bytes), &checksum) != 0 ||
+        (level && write_section(file, level, level_bytes, align_up(level_bytes), &checksum) != 0) ||
+        (graph->original_id &&
+         write_section(file, graph->original_id, order_bytes, align_up(order_bytes), &checksum) != 0)) {
+        status = -1;
+    }
+    if (status == 0) {
+        header.checksum = checksum;
+        if (fseek(file, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, file) != 1) {
+            status = -1;
+        }
+    }
+    if (fclose(file) != 0) {
+        status = -1;
+    }
+    if (status != 0) {
+        fprintf(stderr, "Error: Failed to write '%s'\n", filename);
+    }
+    free(packed);
+    return status;
+}
+
+int write_graph_binary(const Graph *graph, const char *filename, int weight_bytes) {
+    return write_csr_image(graph, NULL, filename, weight_bytes, GRAPH_FILE_MAGIC);
+}
+
+int write_landmarks_binary(const LandmarkTable *table, const Graph *graph, const char *filename) {
+    GraphFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LANDMARK_FILE_MAGIC, 8);
+    header.version = GRAPH_FILE_VERSION;
+    header.weight_bytes = sizeof(int);
+    header.num_nodes = (uint64_t)graph->num_nodes;
+    header.num_edges = (uint64_t)graph->num_edges;
+    header.num_entries = (uint64_t)table->num_landmarks;
+    header.max_weight = graph->max_weight;
+    header.flags = (uint32_t)graph->order;
+
+    size_t ids_bytes = (size_t)table->num_landmarks * sizeof(int);
+    size_t table_bytes = (size_t)table->num_nodes * table->num_landmarks * sizeof(int);
+    header.offsets_pos = align_up(sizeof(GraphFileHeader));
+    header.dest_pos = align_up(header.offsets_pos + ids_bytes);
+    header.weight_pos = align_up(header.dest_pos + table_bytes);
+    header.file_size = header.weight_pos;
+
+    FILE *file = fopen(filename, "wb");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot open file '%s' for writing\n", filename);
+        perror("fopen");
+        return -1;
+    }
+
+    uint64_t checksum = CHECKSUM_SEED;
+    int status = 0;
+    if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+        write_section(file, table->landmarks, ids_bytes, header.dest_pos - header.offsets_pos, &checksum) != 0 ||
+        write_section(file, table->dist, table_bytes, header.weight_pos - header.dest_pos, &checksum) != 0) {
+        status = -1;
+    }
+    if (status == 0) {
+        header.checksum = checksum;
+        if (fseek(file, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, file) != 1) {
+            status = -1;
+        }
+    }
+    if (fclose(file) != 0) {
+        status = -1;
+    }
+    if (status != 0) {
+        fprintf(stderr, "Error: Failed to write '%s'\n", filename);
+    }
+    return status;
+}
+
+int write_distances_binary(const int *distances, int num_nodes, int source, const char *filename) {
+    GraphFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DISTANCE_FILE_MAGIC, 8);
+    header.version = GRAPH_FILE_VERSION;
+    header.weight_bytes = sizeof(int);
+    header.num_nodes = (uint64_t)num_nodes;
+    header.num_entries = (uint64_t)num_nodes;
+
+    size_t dist_bytes = (size_t)num_nodes * sizeof(int);
+    header.offsets_pos = align_up(sizeof(GraphFileHeader));
+    header.dest_pos = align_up(header.offsets_pos + sizeof(int));
+    header.weight_pos = align_up(header.dest_pos + dist_bytes);
+    header.file_size = header.weight_pos;
+
+    FILE *file = fopen(filename, "wb");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot open file '%s' for writing\n", filename);
+        perror("fopen");
+        return -1;
+    }
+
+    uint64_t checksum = CHECKSUM_SEED;
+    int status = 0;
+    if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+        write_section(file, &source, sizeof(int), header.dest_pos - header.offsets_pos, &checksum) != 0 ||
+        write_section(file, distances, dist_bytes, header.weight_pos - header.dest_pos, &checksum) != 0) {
+        status = -1;
+    }
+    if (status == 0) {
+        header.checksum = checksum;
+        if (fseek(file, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, file) != 1) {
+            status = -1;
+        }
+    }
+    if (fclose(file) != 0) {
+        status = -1;
+    }
+    if (status != 0) {
+        fprintf(stderr, "Error: Failed to write '%s'\n", filename);
+    }
+    return status;
+}
+
+// Validate a landmark file header against graph; reports and returns false on a mismatch
+static bool check_landmark_header(const GraphFileHeader *header, const Graph *graph, const char *filename) {
+    if (memcmp(header->magic, LANDMARK_FILE_MAGIC, 8) != 0) {
+        fprintf(stderr, "Error: '%s' is not a landmark file\n", filename);
+        return false;
+    }
+    if (header->version != GRAPH_FILE_VERSION || header->weight_bytes != sizeof(int)) {
+        fprintf(stderr, "Error: '%s' has binary format version %u (expected %d)\n",
+                filename, header->version, GRAPH_FILE_VERSION);
+        return false;
+    }
+    if (header->num_nodes != (uint64_t)graph->num_nodes || header->num_edges != (uint64_t)graph->num_edges) {
+        fprintf(stderr, "Error: '%s' was built for a graph with %llu nodes and %llu edges\n", filename,
+                (unsigned long long)header->num_nodes, (unsigned long long)header->num_edges);
+        return false;
+    }
+    if (header->flags != (uint32_t)graph->order) {
+        fprintf(stderr, "Error: '%s' was built for the %s vertex order, the graph uses %s\n", filename,
+                vertex_order_name((VertexOrder)header->flags), vertex_order_name(graph->order));
+        return false;
+    }
+    uint64_t num_landmarks = header->num_entries;
+    uint64_t ids_end = header->offsets_pos + num_landmarks * sizeof(int);
+    uint64_t table_end = header->dest_pos + num_landmarks * header->num_nodes * sizeof(int);
+    if (num_landmarks == 0 || num_landmarks >= INT_MAX / header->num_nodes ||
+        header->offsets_pos != align_up(sizeof(GraphFileHeader)) || header->dest_pos != align_up(ids_end) ||
+        header->file_size != align_up(table_end)) {
+        fprintf(stderr, "Error: '%s' is truncated or has an inconsistent layout\n", filename);
+        return false;
+    }
+    return true;
+}
+
+LandmarkTable* read_landmarks_binary(const char *filename, const Graph *graph) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot open file '%s'\n", filename);
+        return NULL;
+    }
+    GraphFileHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1) {
+        fprintf(stderr, "Error: '%s' is not a landmark file\n", filename);
+        fclose(file);
+        return NULL;
+    }
+    if (!check_landmark_header(&header, graph, filename)) {
+        fclose(file);
+        return NULL;
+    }
+
+    // Read the body into a buffer so the checksum is verified before use
+    size_t body_bytes = header.file_size - sizeof(header);
+    unsigned char *body = (unsigned char*)malloc(body_bytes);
+    if (!body) {
+        perror("Error allocating landmark tables");
+        fclose(file);
+        return NULL;
+    }
+    bool complete = fread(body, 1, body_bytes, file) == body_bytes && fgetc(file) == EOF;
+    fclose(file);
+    if (!complete) {
+        fprintf(stderr, "Error: '%s' is truncated or has an inconsistent layout\n", filename);
+        free(body);
+        return NULL;
+    }
+    if (checksum_words(CHECKSUM_SEED, body, body_bytes) != header.checksum) {
+        fprintf(stderr, "Error: Checksum mismatch in '%s' (file is corrupt)\n", filename);
+        free(body);
+        return NULL;
+    }
+
+    size_t ids_bytes = header.num_entries * sizeof(int);
+    size_t table_bytes = header.num_entries * header.num_nodes * sizeof(int);
+    LandmarkTable *table = (LandmarkTable*)calloc(1, sizeof(LandmarkTable));
+    if (table) {
+        table->num_landmarks = (int)header.num_entries;
+        table->num_nodes = graph->num_nodes;
+        table->landmarks = (int*)malloc(ids_bytes);
+        table->dist = (int*)malloc(table_bytes);
+    }
+    if (!table || !table->landmarks || !table->dist) {
+        perror("Error allocating landmark tables");
+        free_landmarks(table);
+        free(body);
+        return NULL;
+    }
+    memcpy(table->landmarks, body + (header.offsets_pos - sizeof(header)), ids_bytes);
+    memcpy(table->dist, body + (header.dest_pos - sizeof(header)), table_bytes);
+    free(body);
+
+    for (int l = 0; l < table->num_landmarks; l++) {
+        if (table->landmarks[l] < 0 || table->landmarks[l] >= graph->num_nodes) {
+            fprintf(stderr, "Error: '%s' has an invalid landmark id %d\n", filename, table->landmarks[l]);
+            free_landmarks(table);
+            return NULL;
+        }
+    }
+    return table;
+}
+
+void free_landmarks(LandmarkTable *table) {
+    if (!table) {
+        return;
+    }
+    free(table->landmarks);
+    free(table->dist);
+    free(table);
+}
+
+int write_hierarchy_binary(const ContractionHierarchy *ch, const char *filename) {
+    return write_csr_image(ch->up, ch->level, filename, sizeof(int), HIERARCHY_FILE_MAGIC);
+}
+
+ContractionHierarchy* read_hierarchy_binary(const char *filename, const Graph *graph) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot open file '%s'\n", filename);
+        return NULL;
+    }
+    GraphFileHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, HIERARCHY_FILE_MAGIC, 8) != 0) {
+        fprintf(stderr, "Error: '%s' is not a contraction hierarchy file\n", filename);
+        fclose(file);
+        return NULL;
+    }
+    if (header.num_nodes != (uint64_t)graph->num_nodes || header.num_edges != (uint64_t)graph->num_edges) {
+        fprintf(stderr, "Error: '%s' was built for a graph with %llu nodes and %llu edges\n", filename,
+                (unsigned long long)header.num_nodes, (unsigned long long)header.num_edges);
+        fclose(file);
+        return NULL;
+    }
+    if (header.flags != (uint32_t)graph->order) {
+        fprintf(stderr, "Error: '%s' was built for the %s vertex order, the graph uses %s\n", filename,
+                vertex_order_name((VertexOrder)header.flags), vertex_order_name(graph->order));
+        fclose(file);
+        return NULL;
+    }
+    if (!check_graph_header(&header, header.file_size, filename)) {
+        fclose(file);
+        return NULL;
+    }
+    size_t level_bytes = (size_t)header.num_nodes * sizeof(int);
+    if (header.weight_bytes != sizeof(int) || header.level_pos % GRAPH_FILE_ALIGN ||
+        header.level_pos < header.weight_pos + header.num_entries * sizeof(int) ||
+        header.level_pos + level_bytes > header.file_size) {
+        fprintf(stderr, "Error: '%s' is truncated or has an inconsistent layout\n", filename);
+        fclose(file);
+        return NULL;
+    }
+
+    // The image is read rather than mapped: it is small next to the graph
+    unsigned char *data = (unsigned char*)malloc(header.file_size);
+    if (!data) {
+        perror("Error allocating contraction hierarchy");
+        fclose(file);
+        return NULL;
+    }
+    memcpy(data, &header, sizeof(header));
+    size_t body_bytes = header.file_size - sizeof(header);
+    bool complete = fread(data + sizeof(header), 1, body_bytes, file) == body_bytes && fgetc(file) == EOF;
+    fclose(file);
+    if (!complete) {
+        fprintf(stderr, "Error: '%s' is truncated or has an inconsistent layout\n", filename);
+        free(data);
+        return NULL;
+    }
+
+    ContractionHierarchy *ch = (ContractionHierarchy*)calloc(1, sizeof(ContractionHierarchy));
+    if (ch) {
+        ch->level = (int*)malloc(level_bytes);
+    }
+    if (!ch || !ch->level) {
+        perror("Error allocating contraction hierarchy");
+        free_hierarchy(ch);
+        free(data);
+        return NULL;
+    }
+    ch->up = load_csr_image(data, header.file_size, filename, NULL, 0);
+    memcpy(ch->level, data + header.level_pos, level_bytes);
+    free(data);
+    if (!ch->up) {
+        free_hierarchy(ch);
+        return NULL;
+    }
+    return ch;
+}
+
+void free_hierarchy(ContractionHierarchy *ch) {
+    if (!ch) {
+        return;
+    }
+    free_graph(ch->up);
+    free(ch->level);
+    free(ch);
+}
+
+int write_graph_text(const Graph *graph, const char *filename) {
+    FILE *file = fopen(filename, "w");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot open file '%s' for writing\n", filename);
+        perror("fopen");
+        return -1;
+    }
+    fprintf(file, "%d %d\n", graph->num_nodes, graph->num_edges);
+    // Each undirected edge appears in both endpoint rows; emit it from the
+    // lower endpoint. A self-loop appears twice in its own row, so emit every other copy.
+    // Reordered graphs are written with their input ids, the lower one first.
+    for (int u = 0; u < graph->num_nodes; u++) {
+        int self_loops = 0;
+        for (int i = graph->offsets[u]; i < graph->offsets[u + 1]; i++) {
+            int v = graph->dest[i];
+            if (u < v || (u == v && (self_loops++ % 2) == 0)) {
+                int a = graph_input_id(graph, u);
+                int b = graph_input_id(graph, v);
+                fprintf(file, "%d %d %d\n", a < b ? a : b, a < b ? b : a, graph->weight[i]);
+            }
+        }
+    }
+    if (fclose(file) != 0) {
+        fprintf(stderr, "Error: Failed to write '%s'\n", filename);
+        return -1;
+    }
+    return 0;
+}
@@ -1,97 +1,584 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <getopt.h>
+#include <omp.h>
+#include "graph.h"
+#include "output.h"
 
-// Hash function to encode edges as unique integers
-long long encode_edge(int u, int v) {
-    return (long long)(u < v ? u : v) * 1000000000LL + (u > v ? u : v);
+// Topology models
+typedef enum {
+    MODEL_RANDOM,   // Erdos-Renyi G(n, m): endpoints drawn uniformly
+    MODEL_GRID,     // road-like: edges between lattice neighbors (right, down) and a few diagonals
+    MODEL_RMAT      // R-MAT: recursive quadrant choice, power-law degrees
+} GraphModel;
+
+// R-MAT quadrant probabilities (Graph500 values); d = 1 - a - b - c
+#define RMAT_A 0.57
+#define RMAT_B 0.19
+#define RMAT_C 0.19
+
+// Edges per formatted text chunk; a line "u v w\n" is at most 33 bytes
+#define TEXT_CHUNK_EDGES 65536
+#define TEXT_LINE_MAX 36
+
+// Sampling rounds in a row that may add no edge before giving up
+#define MAX_EMPTY_ROUNDS 16
+
+typedef struct {
+    GraphModel model;
+    int num_nodes;
+    int width;          // grid columns
+    int scale;          // R-MAT draws ids from [0, 2^scale)
+    uint64_t seed;
+    int max_weight;
+} Generator;
+
+static inline uint64_t mix64(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
 }
 
-// Function to generate a random weighted graph in edge list format
-void generate_random_weighted_graph(int num_nodes, int num_edges, int max_weight, const char *filename) {
-    // Check if the number of edges exceeds the maximum possible
-    int max_possible_edges = num_nodes * (num_nodes - 1) / 2;
-    if (num_edges > max_possible_edges) {
-        fprintf(stderr, "Error: Too many edges for the given number of nodes.\n");
-        exit(EXIT_FAILURE);
+// splitmix64 stream
+static inline uint64_t next_random(uint64_t *state) {
+    *state += 0x9e3779b97f4a7c15ULL;
+    return mix64(*state);
+}
+
+// Uniform integer in [0, n)
+static inline int random_below(uint64_t *state, int n) {
+    return (int)(((next_random(state) >> 32) * (uint64_t)n) >> 32);
+}
+
+static inline double random_unit(uint64_t *state) {
+    return (double)(next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// An undirected edge u < v is the key u * num_nodes + v, so sorted keys are
+// sorted by (u, v); num_nodes^2 marks a rejected candidate
+static inline uint64_t edge_key(const Generator *gen, int u, int v) {
+    if (u == v) {
+        return (uint64_t)gen->num_nodes * (uint64_t)gen->num_nodes;
+    }
+    int lo = u < v ? u : v;
+    int hi = u < v ? v : u;
+    return (uint64_t)lo * (uint64_t)gen->num_nodes + (uint64_t)hi;
+}
+
+// Candidate edge number index. Every candidate has its own random stream
+// (64 draws apart), so the generated graph depends only on the seed and
+// not on the number of threads.
+static uint64_t candidate_edge(const Generator *gen, uint64_t index) {
+    uint64_t state = gen->seed + (index << 6) * 0x9e3779b97f4a7c15ULL;
+    int n = gen->num_nodes;
+    switch (gen->model) {
+        case MODEL_GRID: {
+            int u = random_below(&state, n);
+            int col = u % gen->width;
+            int direction = random_below(&state, 10);
+            int v;
+            if (direction < 4) {
+                v = (col + 1 < gen->width) ? u + 1 : u;
+            } else if (direction < 8) {
+                v = u + gen->width;
+            } else if (direction == 8) {
+                v = (col + 1 < gen->width) ? u + gen->width + 1 : u;
+            } else {
+                v = (col > 0) ? u + gen->width - 1 : u;
+            }
+            return edge_key(gen, u, v < n ? v : u);
+        }
+        case MODEL_RMAT: {
+            int u = 0;
+            int v = 0;
+            for (int level = 0; level < gen->scale; level++) {
+                double r = random_unit(&state);
+                u <<= 1;
+                v <<= 1;
+                if (r < RMAT_A) {
+                    // top-left quadrant
+                } else if (r < RMAT_A + RMAT_B) {
+                    v |= 1;
+                } else if (r < RMAT_A + RMAT_B + RMAT_C) {
+                    u |= 1;
+                } else {
+                    u |= 1;
+                    v |= 1;
+                }
+            }
+            if (u >= n || v >= n) {
+                return edge_key(gen, 0, 0);
+            }
+            return edge_key(gen, u, v);
+        }
+        case MODEL_RANDOM:
+        default: {
+            int u = random_below(&state, n);
+            int v = random_below(&state, n);
+            return edge_key(gen, u, v);
+        }
     }
+}
 
-    // Open the output file
-    FILE *file = fopen(filename, "w");
-    if (!file) {
-        perror("Error opening file");
-        exit(EXIT_FAILURE);
+// Weights depend on the edge alone, not on when it was sampled
+static inline int edge_weight(const Generator *gen, uint64_t key) {
+    return (int)(mix64(key ^ mix64(gen->seed)) % (uint64_t)gen->max_weight) + 1;
+}
+
+// Number of distinct edges the model can produce
+static long long max_model_edges(const Generator *gen) {
+    long long n = gen->num_nodes;
+    if (gen->model != MODEL_GRID) {
+        return n * (n - 1) / 2;
+    }
+    long long count = 0;
+    int w = gen->width;
+    #pragma omp parallel for reduction(+:count)
+    for (int u = 0; u < gen->num_nodes; u++) {
+        int col = u % w;
+        count += (col + 1 < w && u + 1 < n);
+        count += (u + w < n);
+        count += (col + 1 < w && u + w + 1 < n);
+        count += (col > 0 && u + w - 1 < n);
     }
+    return count;
+}
+
+// Stable LSD radix sort of keys (and payload, if not NULL) on their low
+// key_bits bits, 8 bits per pass with per-thread histograms
+static bool radix_sort(uint64_t *keys, uint32_t *payload, size_t n, int key_bits, int num_threads) {
+    uint64_t *key_buffer = (uint64_t*)malloc((n > 0 ? n : 1) * sizeof(uint64_t));
+    uint32_t *payload_buffer = payload ? (uint32_t*)malloc((n > 0 ? n : 1) * sizeof(uint32_t)) : NULL;
+    size_t *counts = (size_t*)malloc((size_t)num_threads * 256 * sizeof(size_t));
+    if (!key_buffer || (payload && !payload_buffer) || !counts) {
+        perror("Error allocating sort buffers");
+        free(key_buffer);
+        free(payload_buffer);
+        free(counts);
+        return false;
+    }
+
+    uint64_t *src_keys = keys;
+    uint64_t *dst_keys = key_buffer;
+    uint32_t *src_payload = payload;
+    uint32_t *dst_payload = payload_buffer;
+    for (int shift = 0; shift < key_bits; shift += 8) {
+        #pragma omp parallel num_threads(num_threads)
+        {
+            int t = omp_get_thread_num();
+            int nt = omp_get_num_threads();
+            size_t first = n * (size_t)t / (size_t)nt;
+            size_t last = n * (size_t)(t + 1) / (size_t)nt;
+            size_t *count = counts + (size_t)t * 256;
+            memset(count, 0, 256 * sizeof(size_t));
+            for (size_t i = first; i < last; i++) {
+                count[(src_keys[i] >> shift) & 255]++;
+            }
+            #pragma omp barrier
+            #pragma omp single
+            {
+                // Digit-major, then thread order keeps the sort stable
+                size_t sum = 0;
+                for (int digit = 0; digit < 256; digit++) {
+                    for (int k = 0; k < nt; k++) {
+                        size_t c = counts[(size_t)k * 256 + digit];
+                        counts[(size_t)k * 256 + digit] = sum;
+                        sum += c;
+                    }
+                }
+            }
+            for (size_t i = first; i < last; i++) {
+                size_t pos = count[(src_keys[i] >> shift) & 255]++;
+                dst_keys[pos] = src_keys[i];
+                if (src_payload) {
+                    dst_payload[pos] = src_payload[i];
+                }
+            }
+        }
+        uint64_t *swap_keys = src_keys;
+        src_keys = dst_keys;
+        dst_keys = swap_keys;
+        uint32_t *swap_payload = src_payload;
+        src_payload = dst_payload;
+        dst_payload = swap_payload;
+    }
+    if (src_keys != keys) {
+        memcpy(keys, src_keys, n * sizeof(uint64_t));
+        if (payload) {
+            memcpy(payload, src_payload, n * sizeof(uint32_t));
+        }
+    }
+
+    free(key_buffer);
+    free(payload_buffer);
+    free(counts);
+    return true;
+}
 
-    // Allocate memory for tracking edges using a hash set
-    long long *edge_set = (long long *)malloc(num_edges * sizeof(long long));
-    int edge_count = 0;
+static bool contains_key(const uint64_t *keys, size_t count, uint64_t key) {
+    size_t lo = 0;
+    size_t hi = count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (keys[mid] < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < count && keys[lo] == key;
+}
 
-    // Seed the random number generator
-    srand(time(NULL));
+// Sample exactly num_edges distinct edges. Each round draws a batch of
+// candidates in parallel, sorts them, drops rejects, duplicates and edges
+// already chosen, and keeps the first new edges in candidate order up to
+// the deficit, so the result does not depend on the thread count. Batches
+// are oversized by the acceptance rate of the previous round. Returns the
+// sorted edge keys, or NULL on error.
+static uint64_t* sample_edges(const Generator *gen, int num_edges, int num_threads, int *num_rounds) {
+    uint64_t rejected = (uint64_t)gen->num_nodes * (uint64_t)gen->num_nodes;
+    int key_bits = 0;
+    while (key_bits < 64 && (rejected >> key_bits) != 0) {
+        key_bits++;
+    }
 
-    // Write the number of nodes and edges to the file
-    fprintf(file, "%d %d\n", num_nodes, num_edges);
+    uint64_t *edges = (uint64_t*)malloc((size_t)num_edges * sizeof(uint64_t));
+    uint64_t *merged = (uint64_t*)malloc((size_t)num_edges * sizeof(uint64_t));
+    if (!edges || !merged) {
+        perror("Error allocating edge keys");
+        free(edges);
+        free(merged);
+        return NULL;
+    }
 
-    // Generate random edges with weights
-    while (edge_count < num_edges) {
-        int u = rand() % num_nodes;
-        int v = rand() % num_nodes;
+    size_t have = 0;
+    uint64_t next_index = 0;
+    double acceptance = 1.0;
+    int empty_rounds = 0;
+    *num_rounds = 0;
+    bool ok = true;
+    while (ok && have < (size_t)num_edges) {
+        size_t deficit = (size_t)num_edges - have;
+        double wanted = (double)deficit / acceptance * 1.25 + 1024.0;
+        double cap = 4.0 * (double)num_edges + 1048576.0;
+        size_t batch = (size_t)(wanted < cap ? wanted : cap);
+        if (batch > UINT32_MAX) {
+            batch = UINT32_MAX;
+        }
 
-        // Ensure no self-loops
-        if (u == v) {
-            continue;
+        uint64_t *keys = (uint64_t*)malloc(batch * sizeof(uint64_t));
+        uint32_t *order = (uint32_t*)malloc(batch * sizeof(uint32_t));
+        unsigned char *fresh = (unsigned char*)calloc(batch, 1);
+        ok = keys && order && fresh;
+        if (!ok) {
+            perror("Error allocating candidate batch");
         }
 
-        // Encode the edge
-        long long edge = encode_edge(u, v);
+        if (ok) {
+            #pragma omp parallel for num_threads(num_threads) schedule(static)
+            for (size_t i = 0; i < batch; i++) {
+                keys[i] = candidate_edge(gen, next_index + i);
+                order[i] = (uint32_t)i;
+            }
+            ok = radix_sort(keys, order, batch, key_bits, num_threads);
+        }
 
-        // Check for duplicates
-        int is_duplicate = 0;
-        for (int i = 0; i < edge_count; i++) {
-            if (edge_set[i] == edge) {
-                is_duplicate = 1;
-                break;
+        if (ok) {
+            // First occurrence of each new key, marked at its candidate index
+            #pragma omp parallel for num_threads(num_threads) schedule(static)
+            for (size_t i = 0; i < batch; i++) {
+                if (keys[i] != rejected && (i == 0 || keys[i] != keys[i - 1]) &&
+                    !contains_key(edges, have, keys[i])) {
+                    fresh[order[i]] = 1;
+                }
+            }
+
+            // Candidate index below which the first deficit new edges lie
+            size_t accepted = 0;
+            size_t cutoff = 0;
+            while (cutoff < batch && accepted < deficit) {
+                accepted += fresh[cutoff];
+                cutoff++;
+            }
+
+            // Keys are sorted, so the accepted ones come out sorted; merge them in
+            size_t a = 0;
+            size_t out = 0;
+            for (size_t i = 0; i < batch; i++) {
+                if (!fresh[order[i]] || order[i] >= cutoff) {
+                    continue;
+                }
+                while (a < have && edges[a] < keys[i]) {
+                    merged[out++] = edges[a++];
+                }
+                merged[out++] = keys[i];
+            }
+            while (a < have) {
+                merged[out++] = edges[a++];
+            }
+            uint64_t *swap = edges;
+            edges = merged;
+            merged = swap;
+            have = out;
+
+            acceptance = (double)accepted / (double)cutoff;
+            if (acceptance < 1e-6) {
+                acceptance = 1e-6;
+            }
+            next_index += batch;
+            (*num_rounds)++;
+            empty_rounds = (accepted == 0) ? empty_rounds + 1 : 0;
+            if (empty_rounds >= MAX_EMPTY_ROUNDS) {
+                fprintf(stderr, "Error: Found only %zu distinct edges after %d rounds; use fewer edges\n",
+                        have, *num_rounds);
+                ok = false;
             }
         }
 
-        if (!is_duplicate) {
-            // Add the edge to the hash set
-            edge_set[edge_count++] = edge;
+        free(keys);
+        free(order);
+        free(fresh);
+    }
 
-            // Generate a random weight
-            int weight = (rand() % max_weight) + 1; // Random weight between 1 and max_weight
+    free(merged);
+    if (!ok) {
+        free(edges);
+        return NULL;
+    }
+    return edges;
+}
 
-            // Write the edge to the file
-            fprintf(file, "%d %d %d\n", u, v, weight);
+// Text edge list, formatted in parallel chunks and written in order
+static int write_edges_text(const Generator *gen, const uint64_t *edges, int num_edges, const char *filename,
+                            int num_threads) {
+    FILE *file = open_output_stream(filename);
+    if (!file) {
+        return -1;
+    }
+    fprintf(file, "%d %d\n", gen->num_nodes, num_edges);
+
+    uint64_t n = (uint64_t)gen->num_nodes;
+    int num_chunks = (num_edges + TEXT_CHUNK_EDGES - 1) / TEXT_CHUNK_EDGES;
+    bool failed = false;
+    #pragma omp parallel num_threads(num_threads)
+    {
+        char *buffer = (char*)malloc((size_t)TEXT_CHUNK_EDGES * TEXT_LINE_MAX);
+        if (!buffer) {
+            #pragma omp atomic write
+            failed = true;
+        }
+        #pragma omp for ordered schedule(static, 1)
+        for (int c = 0; c < num_chunks; c++) {
+            char *p = buffer;
+            if (buffer) {
+                int first = c * TEXT_CHUNK_EDGES;
+                int last = (num_edges - first > TEXT_CHUNK_EDGES) ? first + TEXT_CHUNK_EDGES : num_edges;
+                for (int e = first; e < last; e++) {
+                    p = format_uint(p, (unsigned)(edges[e] / n));
+                    *p++ = ' ';
+                    p = format_uint(p, (unsigned)(edges[e] % n));
+                    *p++ = ' ';
+                    p = format_uint(p, (unsigned)edge_weight(gen, edges[e]));
+                    *p++ = '\n';
+                }
+            }
+            #pragma omp ordered
+            {
+                size_t length = (size_t)(p - buffer);
+                if (buffer && fwrite(buffer, 1, length, file) != length) {
+                    failed = true;
+                }
+            }
         }
+        free(buffer);
     }
+    if (close_output_stream(file, filename) != 0) {
+        return -1;
+    }
+    return failed ? -1 : 0;
+}
 
-    // Free the hash set memory
-    free(edge_set);
+// Binary CSR: expand the keys into an edge list and let build_graph lay it out
+static int write_edges_binary(const Generator *gen, uint64_t *edges, int num_edges, const char *filename,
+                              int num_threads) {
+    int *edge_u = (int*)malloc((size_t)num_edges * sizeof(int));
+    int *edge_v = (int*)malloc((size_t)num_edges * sizeof(int));
+    int *edge_w = (int*)malloc((size_t)num_edges * sizeof(int));
+    if (!edge_u || !edge_v || !edge_w) {
+        perror("Error allocating edge list");
+        free(edge_u);
+        free(edge_v);
+        free(edge_w);
+        return -1;
+    }
+    uint64_t n = (uint64_t)gen->num_nodes;
+    #pragma omp parallel for num_threads(num_threads) schedule(static)
+    for (int e = 0; e < num_edges; e++) {
+        edge_u[e] = (int)(edges[e] / n);
+        edge_v[e] = (int)(edges[e] % n);
+        edge_w[e] = edge_weight(gen, edges[e]);
+    }
 
-    // Close the file
-    fclose(file);
-    printf("Weighted graph with %d nodes and %d edges generated in %s.\n", num_nodes, num_edges, filename);
+    Graph *graph = build_graph(gen->num_nodes, num_edges, edge_u, edge_v, edge_w);
+    free(edge_u);
+    free(edge_v);
+    free(edge_w);
+    int status = graph ? write_graph_binary(graph, filename, 4) : -1;
+    free_graph(graph);
+    return status;
+}
+
+static bool parse_model(const char *name, GraphModel *model) {
+    if (strcmp(name, "random") == 0) {
+        *model = MODEL_RANDOM;
+    } else if (strcmp(name, "grid") == 0) {
+        *model = MODEL_GRID;
+    } else if (strcmp(name, "rmat") == 0) {
+        *model = MODEL_RMAT;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static const char* model_name(GraphModel model) {
+    switch (model) {
+        case MODEL_GRID:
+            return "grid";
+        case MODEL_RMAT:
+            return "rmat";
+        case MODEL_RANDOM:
+        default:
+            return "random";
+    }
+}
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--model random|grid|rmat] [--width <columns>] [--seed <n>] [--threads <n>] [--binary]\n", prog);
+    fprintf(stderr, "       <num_nodes> <num_edges> <max_weight> <output_file>\n");
+    fprintf(stderr, "Models: random (Erdos-Renyi, default), grid (road-like lattice, --width columns,\n");
+    fprintf(stderr, "default sqrt(num_nodes)), rmat (power-law). The same seed gives the same graph.\n");
+    fprintf(stderr, "Example: %s --model grid --seed 7 1000000 1500000 100 road.txt\n", prog);
 }
 
 int main(int argc, char *argv[]) {
-    if (argc != 5) {
-        fprintf(stderr, "Usage: %s <num_nodes> <num_edges> <max_weight> <output_file>\n", argv[0]);
+    GraphModel model = MODEL_RANDOM;
+    bool binary = false;
+    int width = 0;
+    unsigned long long seed = 1;
+    int num_threads = 0;
+
+    static const struct option long_options[] = {
+        {"model", required_argument, NULL, 'm'},
+        {"width", required_argument, NULL, 'w'},
+        {"seed", required_argument, NULL, 's'},
+        {"threads", required_argument, NULL, 't'},
+        {"binary", no_argument, NULL, 'b'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "m:w:s:t:b", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'm':
+                if (!parse_model(optarg, &model)) {
+                    fprintf(stderr, "Error: Unknown model '%s'\n", optarg);
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'w':
+                width = atoi(optarg);
+                if (width <= 0) {
+                    fprintf(stderr, "Error: Grid width must be positive\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 's':
+                seed = strtoull(optarg, NULL, 10);
+                break;
+            case 't':
+                num_threads = atoi(optarg);
+                if (num_threads <= 0) {
+                    fprintf(stderr, "Error: Number of threads must be positive\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'b':
+                binary = true;
+                break;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (argc - optind != 4) {
+        print_usage(argv[0]);
         return EXIT_FAILURE;
     }
 
-    int num_nodes = atoi(argv[1]);
-    int num_edges = atoi(argv[2]);
-    int max_weight = atoi(argv[3]);
-    const char *filename = argv[4];
+    int num_nodes = atoi(argv[optind]);
+    int num_edges = atoi(argv[optind + 1]);
+    int max_weight = atoi(argv[optind + 2]);
+    const char *filename = argv[optind + 3];
 
     if (num_nodes <= 0 || num_edges <= 0 || max_weight <= 0) {
         fprintf(stderr, "Number of nodes, edges, and max weight must be positive integers.\n");
         return EXIT_FAILURE;
     }
+    if (num_threads <= 0) {
+        num_threads = omp_get_max_threads();
+    }
+
+    Generator gen;
+    gen.model = model;
+    gen.num_nodes = num_nodes;
+    gen.width = width;
+    if (model == MODEL_GRID && width <= 0) {
+        gen.width = 1;
+        while ((long long)gen.width * gen.width < num_nodes) {
+            gen.width++;
+        }
+    }
+    gen.scale = 0;
+    while ((1LL << gen.scale) < num_nodes) {
+        gen.scale++;
+    }
+    gen.seed = mix64((uint64_t)seed);
+    gen.max_weight = max_weight;
+
+    // Check if the number of edges exceeds the maximum possible
+    long long max_edges = max_model_edges(&gen);
+    if (num_edges > max_edges) {
+        fprintf(stderr, "Error: Too many edges for the given number of nodes (at most %lld for model %s).\n",
+                max_edges, model_name(model));
+        return EXIT_FAILURE;
+    }
 
-    generate_random_weighted_graph(num_nodes, num_edges, max_weight, filename);
+    double start = omp_get_wtime();
+    int num_rounds = 0;
+    uint64_t *edges = sample_edges(&gen, num_edges, num_threads, &num_rounds);
+    if (!edges) {
+        return EXIT_FAILURE;
+    }
+    double sample_time = omp_get_wtime() - start;
+
+    start = omp_get_wtime();
+    int status = binary ? write_edges_binary(&gen, edges, num_edges, filename, num_threads)
+                        : write_edges_text(&gen, edges, num_edges, filename, num_threads);
+    double write_time = omp_get_wtime() - start;
+    free(edges);
+    if (status != 0) {
+        return EXIT_FAILURE;
+    }
+
+    printf("Weighted graph with %d nodes and %d edges generated in %s.\n", num_nodes, num_edges, filename);
+    printf("Model %s, seed %llu: %d sampling rounds in %.3f seconds, written in %.3f seconds (%d threads)\n",
+           model_name(model), seed, num_rounds, sample_time, write_time, num_threads);
 
     return EXIT_SUCCESS;
 }
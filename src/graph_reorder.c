@@ -0,0 +1,351 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <omp.h>
+#include "graph.h"
+
+// Pseudo-peripheral node search: at most this many BFS sweeps per component
+#define MAX_PERIPHERAL_SWEEPS 8
+
+bool parse_vertex_order(const char *name, VertexOrder *order) {
+    if (strcmp(name, "input") == 0) {
+        *order = ORDER_INPUT;
+    } else if (strcmp(name, "rcm") == 0) {
+        *order = ORDER_RCM;
+    } else if (strcmp(name, "bfs") == 0) {
+        *order = ORDER_BFS;
+    } else if (strcmp(name, "degree") == 0) {
+        *order = ORDER_DEGREE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* vertex_order_name(VertexOrder order) {
+    switch (order) {
+        case ORDER_RCM:
+            return "rcm";
+        case ORDER_BFS:
+            return "bfs";
+        case ORDER_DEGREE:
+            return "degree";
+        case ORDER_INPUT:
+        default:
+            return "input";
+    }
+}
+
+// Nodes sorted by degree (counting sort, ties by id), increasing or decreasing
+static int* nodes_by_degree(const Graph *graph, bool decreasing) {
+    int num_nodes = graph->num_nodes;
+    int max_degree = 0;
+    for (int v = 0; v < num_nodes; v++) {
+        if (graph_degree(graph, v) > max_degree) {
+            max_degree = graph_degree(graph, v);
+        }
+    }
+    int *start = (int*)calloc((size_t)max_degree + 2, sizeof(int));
+    int *sorted = (int*)malloc((size_t)num_nodes * sizeof(int));
+    if (!start || !sorted) {
+        perror("Error allocating vertex order");
+        free(start);
+        free(sorted);
+        return NULL;
+    }
+    for (int v = 0; v < num_nodes; v++) {
+        int key = decreasing ? max_degree - graph_degree(graph, v) : graph_degree(graph, v);
+        start[key + 1]++;
+    }
+    for (int d = 0; d <= max_degree; d++) {
+        start[d + 1] += start[d];
+    }
+    for (int v = 0; v < num_nodes; v++) {
+        int key = decreasing ? max_degree - graph_degree(graph, v) : graph_degree(graph, v);
+        sorted[start[key]++] = v;
+    }
+    free(start);
+    return sorted;
+}
+
+// BFS from root over nodes not yet numbered, recording each reached node's
+// level; queue receives the reached nodes in visit order. Returns the number
+// of nodes reached and the eccentricity of root in *depth.
+static int bfs_levels(const Graph *graph, int root, const unsigned char *numbered, int *level, int *queue, int *depth) {
+    int head = 0;
+    int tail = 0;
+    queue[tail++] = root;
+    level[root] = 0;
+    *depth = 0;
+    while (head < tail) {
+        int u = queue[head++];
+        for (int i = graph->offsets[u]; i < graph->offsets[u + 1]; i++) {
+            int v = graph->dest[i];
+            if (!numbered[v] && level[v] < 0) {
+                level[v] = level[u] + 1;
+                *depth = level[v];
+                queue[tail++] = v;
+            }
+        }
+    }
+    return tail;
+}
+
+// George-Liu: move the root to a minimum-degree node of the last BFS level
+// as long as that increases the eccentricity
+static int pseudo_peripheral_node(const Graph *graph, int root, const unsigned char *numbered, int *level, int *queue) {
+    int depth;
+    int reached = bfs_levels(graph, root, numbered, level, queue, &depth);
+    for (int sweep = 1; sweep < MAX_PERIPHERAL_SWEEPS; sweep++) {
+        int candidate = -1;
+        for (int i = reached - 1; i >= 0 && level[queue[i]] == depth; i--) {
+            if (candidate < 0 || graph_degree(graph, queue[i]) < graph_degree(graph, candidate)) {
+                candidate = queue[i];
+            }
+        }
+        for (int i = 0; i < reached; i++) {
+            level[queue[i]] = -1;
+        }
+        int candidate_depth;
+        reached = bfs_levels(graph, candidate, numbered, level, queue, &candidate_depth);
+        if (candidate_depth <= depth) {
+            break;
+        }
+        root = candidate;
+        depth = candidate_depth;
+    }
+    for (int i = 0; i < reached; i++) {
+        level[queue[i]] = -1;
+    }
+    return root;
+}
+
+typedef struct {
+    int degree;
+    int node;
+} DegreeKey;
+
+static int compare_degree_keys(const void *a, const void *b) {
+    const DegreeKey *x = (const DegreeKey*)a;
+    const DegreeKey *y = (const DegreeKey*)b;
+    if (x->degree != y->degree) {
+        return x->degree < y->degree ? -1 : 1;
+    }
+    return x->node - y->node;
+}
+
+// Breadth-first sequence of every component. Cuthill-McKee (cuthill_mckee set)
+// starts each component at a pseudo-peripheral node and enqueues neighbors
+// by increasing degree; plain BFS starts at the lowest unnumbered id and
+// keeps adjacency order.
+static int* bfs_sequence(const Graph *graph, bool cuthill_mckee) {
+    int num_nodes = graph->num_nodes;
+    int *sequence = (int*)malloc((size_t)num_nodes * sizeof(int));
+    unsigned char *numbered = (unsigned char*)calloc((size_t)num_nodes, 1);
+    int *starts = cuthill_mckee ? nodes_by_degree(graph, false) : NULL;
+    int *level = NULL;
+    int *queue = NULL;
+    DegreeKey *keys = NULL;
+    bool ok = sequence && numbered && (starts || !cuthill_mckee);
+    if (ok && cuthill_mckee) {
+        int max_degree = 0;
+        for (int v = 0; v < num_nodes; v++) {
+            if (graph_degree(graph, v) > max_degree) {
+                max_degree = graph_degree(graph, v);
+            }
+        }
+        level = (int*)malloc((size_t)num_nodes * sizeof(int));
+        queue = (int*)malloc((size_t)num_nodes * sizeof(int));
+        keys = (DegreeKey*)malloc(((size_t)max_degree + 1) * sizeof(DegreeKey));
+        ok = level && queue && keys;
+        for (int v = 0; ok && v < num_nodes; v++) {
+            level[v] = -1;
+        }
+    }
+    if (!ok) {
+        perror("Error allocating vertex order");
+        free(sequence);
+        sequence = NULL;
+    }
+
+    // sequence doubles as the BFS queue: [head, count) is the frontier
+    int count = 0;
+    for (int s = 0; sequence && s < num_nodes; s++) {
+        int root = cuthill_mckee ? starts[s] : s;
+        if (numbered[root]) {
+            continue;
+        }
+        if (cuthill_mckee) {
+            root = pseudo_peripheral_node(graph, root, numbered, level, queue);
+        }
+        int head = count;
+        sequence[count++] = root;
+        numbered[root] = 1;
+        while (head < count) {
+            int u = sequence[head++];
+            int first = count;
+            for (int i = graph->offsets[u]; i < graph->offsets[u + 1]; i++) {
+                int v = graph->dest[i];
+                if (!numbered[v]) {
+                    numbered[v] = 1;
+                    sequence[count++] = v;
+                }
+            }
+            if (cuthill_mckee && count - first > 1) {
+                int n = count - first;
+                for (int k = 0; k < n; k++) {
+                    keys[k].degree = graph_degree(graph, sequence[first + k]);
+                    keys[k].node = sequence[first + k];
+                }
+                qsort(keys, (size_t)n, sizeof(DegreeKey), compare_degree_keys);
+                for (int k = 0; k < n; k++) {
+                    sequence[first + k] = keys[k].node;
+                }
+            }
+        }
+    }
+
+    free(numbered);
+    free(starts);
+    free(level);
+    free(queue);
+    free(keys);
+    return sequence;
+}
+
+// Current node ids in their new order: sequence[i] becomes node i
+static int* order_sequence(const Graph *graph, VertexOrder order) {
+    int num_nodes = graph->num_nodes;
+    int *sequence = NULL;
+    switch (order) {
+        case ORDER_DEGREE:
+            return nodes_by_degree(graph, true);
+        case ORDER_BFS:
+            return bfs_sequence(graph, false);
+        case ORDER_RCM:
+            sequence = bfs_sequence(graph, true);
+            for (int i = 0, j = num_nodes - 1; sequence && i < j; i++, j--) {
+                int swap = sequence[i];
+                sequence[i] = sequence[j];
+                sequence[j] = swap;
+            }
+            return sequence;
+        case ORDER_INPUT:
+        default:
+            // Node v goes back to position original_id[v]
+            sequence = (int*)malloc((size_t)num_nodes * sizeof(int));
+            if (!sequence) {
+                perror("Error allocating vertex order");
+                return NULL;
+            }
+            for (int v = 0; v < num_nodes; v++) {
+                sequence[graph_input_id(graph, v)] = v;
+            }
+            return sequence;
+    }
+}
+
+int reorder_graph(Graph *graph, VertexOrder order, int num_threads) {
+    if (num_threads <= 0) {
+        num_threads = omp_get_max_threads();
+    }
+    if (order == ORDER_INPUT && !graph->original_id) {
+        return 0;
+    }
+    int num_nodes = graph->num_nodes;
+    size_t num_entries = (size_t)graph->offsets[num_nodes];
+    int *sequence = order_sequence(graph, order);
+    int *new_id = (int*)malloc((size_t)num_nodes * sizeof(int));
+    int *offsets = (int*)malloc(((size_t)num_nodes + 1) * sizeof(int));
+    int *dest = (int*)malloc((num_entries > 0 ? num_entries : 1) * sizeof(int));
+    int *weight = (int*)malloc((num_entries > 0 ? num_entries : 1) * sizeof(int));
+    int *original_id = NULL;
+    int *reordered_id = NULL;
+    if (order != ORDER_INPUT) {
+        original_id = (int*)malloc((size_t)num_nodes * sizeof(int));
+        reordered_id = (int*)malloc((size_t)num_nodes * sizeof(int));
+    }
+    if (!sequence || !new_id || !offsets || !dest || !weight ||
+        (order != ORDER_INPUT && (!original_id || !reordered_id))) {
+        if (sequence) {
+            perror("Error allocating reordered graph");
+        }
+        free(sequence);
+        free(new_id);
+        free(offsets);
+        free(dest);
+        free(weight);
+        free(original_id);
+        free(reordered_id);
+        return -1;
+    }
+
+    offsets[0] = 0;
+    for (int i = 0; i < num_nodes; i++) {
+        new_id[sequence[i]] = i;
+        offsets[i + 1] = offsets[i] + graph_degree(graph, sequence[i]);
+    }
+    #pragma omp parallel for num_threads(num_threads) schedule(static)
+    for (int i = 0; i < num_nodes; i++) {
+        int old = sequence[i];
+        int begin = graph->offsets[old];
+        int length = graph->offsets[old + 1] - begin;
+        for (int k = 0; k < length; k++) {
+            dest[offsets[i] + k] = new_id[graph->dest[begin + k]];
+            weight[offsets[i] + k] = graph->weight[begin + k];
+        }
+        if (original_id) {
+            original_id[i] = graph_input_id(graph, old);
+        }
+    }
+    if (original_id) {
+        for (int i = 0; i < num_nodes; i++) {
+            reordered_id[original_id[i]] = i;
+        }
+    }
+    free(sequence);
+    free(new_id);
+
+    if (graph->mapping) {
+        munmap(graph->mapping, graph->mapping_size);
+        free(graph->weight_storage);
+        graph->mapping = NULL;
+        graph->mapping_size = 0;
+        graph->weight_storage = NULL;
+    } else {
+        free(graph->offsets);
+        free(graph->dest);
+        free(graph->weight);
+    }
+    free(graph->original_id);
+    free(graph->reordered_id);
+    graph->offsets = offsets;
+    graph->dest = dest;
+    graph->weight = weight;
+    graph->order = order;
+    graph->original_id = original_id;
+    graph->reordered_id = reordered_id;
+    return 0;
+}
+
+int restore_input_order(int *values, const int *original_id, int num_nodes, int num_threads) {
+    if (!original_id) {
+        return 0;
+    }
+    if (num_threads <= 0) {
+        num_threads = omp_get_max_threads();
+    }
+    int *copy = (int*)malloc((size_t)num_nodes * sizeof(int));
+    if (!copy) {
+        perror("Error allocating distances");
+        return -1;
+    }
+    memcpy(copy, values, (size_t)num_nodes * sizeof(int));
+    #pragma omp parallel for num_threads(num_threads) schedule(static)
+    for (int v = 0; v < num_nodes; v++) {
+        values[original_id[v]] = copy[v];
+    }
+    free(copy);
+    return 0;
+}
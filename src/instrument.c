@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "instrument.h"
+
+InstrSlot instr_slots[INSTR_MAX_THREADS];
+
+static const char *phase_names[INSTR_NUM_PHASES] = {"select", "relax", "sync", "comm"};
+static const char *counter_names[INSTR_NUM_COUNTERS] = {"settled", "edges", "decreases", "q.push", "q.decrease", "q.pop"};
+static const char *collective_names[INSTR_NUM_COLLECTIVES] = {
+    "Allreduce", "Bcast", "Gather", "Scatter", "Scatterv", "Alltoall", "Alltoallv"
+};
+
+void instr_reset(void) {
+    memset(instr_slots, 0, sizeof(instr_slots));
+}
+
+static bool slot_used(const InstrSlot *slot) {
+    for (int p = 0; p < INSTR_NUM_PHASES; p++) {
+        if (slot->phase_time[p] != 0.0) {
+            return true;
+        }
+    }
+    for (int c = 0; c < INSTR_NUM_COUNTERS; c++) {
+        if (slot->counts[c] != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void print_row(FILE *out, const char *name, const InstrSlot *slot) {
+    fprintf(out, "%-8s", name);
+    for (int p = 0; p < INSTR_NUM_PHASES; p++) {
+        fprintf(out, " %12.6f", slot->phase_time[p]);
+    }
+    for (int c = 0; c < INSTR_NUM_COUNTERS; c++) {
+        fprintf(out, " %12lld", slot->counts[c]);
+    }
+    fputc('\n', out);
+}
+
+void instr_report(FILE *out, const char *label, const InstrSlot *slots) {
+    InstrSlot total;
+    memset(&total, 0, sizeof(total));
+    int threads = 0;
+
+    fprintf(out, "\nInstrumentation (%s), phase times in seconds:\n", label);
+    fprintf(out, "%-8s", "thread");
+    for (int p = 0; p < INSTR_NUM_PHASES; p++) {
+        fprintf(out, " %12s", phase_names[p]);
+    }
+    for (int c = 0; c < INSTR_NUM_COUNTERS; c++) {
+        fprintf(out, " %12s", counter_names[c]);
+    }
+    fputc('\n', out);
+    for (int t = 0; t < INSTR_MAX_THREADS; t++) {
+        const InstrSlot *slot = &slots[t];
+        bool used = slot_used(slot);
+        for (int k = 0; k < INSTR_NUM_COLLECTIVES; k++) {
+            used = used || slot->comm_calls[k] > 0;
+            total.comm_calls[k] += slot->comm_calls[k];
+            total.comm_bytes[k] += slot->comm_bytes[k];
+            total.comm_time[k] += slot->comm_time[k];
+        }
+        if (!used) {
+            continue;
+        }
+        char name[16];
+        snprintf(name, sizeof(name), "%d", t);
+        print_row(out, name, slot);
+        for (int p = 0; p < INSTR_NUM_PHASES; p++) {
+            total.phase_time[p] += slot->phase_time[p];
+        }
+        for (int c = 0; c < INSTR_NUM_COUNTERS; c++) {
+            total.counts[c] += slot->counts[c];
+        }
+        threads++;
+    }
+    if (threads > 1) {
+        print_row(out, "total", &total);
+    }
+
+    for (int k = 0; k < INSTR_NUM_COLLECTIVES; k++) {
+        if (total.comm_calls[k] > 0) {
+            fprintf(out, "  MPI_%-10s %10lld calls %14lld bytes %12.6f seconds\n", collective_names[k],
+                    total.comm_calls[k], total.comm_bytes[k], total.comm_time[k]);
+        }
+    }
+}
@@ -0,0 +1,110 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include <stdio.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Hot-path instrumentation (instrument.c). The INSTR_* macros below expand
+// to nothing unless the sources are compiled with -DSSSP_INSTRUMENT
+// (make INSTRUMENT=1), so default builds carry no counters or timers.
+// Every OpenMP thread accumulates into its own cache-line aligned slot,
+// indexed by omp_get_thread_num(), and the report lists one row per thread.
+
+// Where an engine's time goes; each phase is the cumulative wall time a
+// thread spent in it
+typedef enum {
+    INSTR_SELECT,   // picking the next node or bucket (min-scan, bucket search)
+    INSTR_RELAX,    // relaxing the edges of settled / frontier nodes
+    INSTR_SYNC,     // waiting in OpenMP barriers
+    INSTR_COMM,     // inside MPI collectives (sum over the table below)
+    INSTR_NUM_PHASES
+} InstrPhase;
+
+typedef enum {
+    INSTR_SETTLED,      // nodes settled, or frontier entries processed by delta-stepping
+    INSTR_EDGES,        // adjacency entries scanned by relaxation loops
+    INSTR_DECREASES,    // relaxations that lowered a tentative distance
+    INSTR_QUEUE_PUSH,   // heap / bucket inserts
+    INSTR_QUEUE_DECREASE,
+    INSTR_QUEUE_POP,    // including stale radix heap entries
+    INSTR_NUM_COUNTERS
+} InstrCounter;
+
+// MPI collectives used on the distributed hot paths
+typedef enum {
+    INSTR_MPI_ALLREDUCE,
+    INSTR_MPI_BCAST,
+    INSTR_MPI_GATHER,
+    INSTR_MPI_SCATTER,
+    INSTR_MPI_SCATTERV,
+    INSTR_MPI_ALLTOALL,
+    INSTR_MPI_ALLTOALLV,
+    INSTR_NUM_COLLECTIVES
+} InstrCollective;
+
+// Threads beyond this share the last slot
+#define INSTR_MAX_THREADS 256
+
+typedef struct {
+    double phase_time[INSTR_NUM_PHASES];
+    long long counts[INSTR_NUM_COUNTERS];
+    long long comm_calls[INSTR_NUM_COLLECTIVES];
+    long long comm_bytes[INSTR_NUM_COLLECTIVES];    // bytes sent plus received by this rank
+    double comm_time[INSTR_NUM_COLLECTIVES];
+} __attribute__((aligned(64))) InstrSlot;
+
+extern InstrSlot instr_slots[INSTR_MAX_THREADS];
+
+static inline InstrSlot* instr_slot(void) {
+#ifdef _OPENMP
+    int tid = omp_get_thread_num();
+    return &instr_slots[tid < INSTR_MAX_THREADS ? tid : INSTR_MAX_THREADS - 1];
+#else
+    return &instr_slots[0];
+#endif
+}
+
+static inline double instr_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Zero every slot, e.g. after loading and before the timed run
+void instr_reset(void);
+// Print the per-thread table of slots (instr_slots, or a copy gathered from
+// another rank) under the given heading; threads that recorded nothing are
+// skipped
+void instr_report(FILE *out, const char *label, const InstrSlot *slots);
+
+#ifdef SSSP_INSTRUMENT
+#define INSTR_COUNT(counter, n) (instr_slot()->counts[counter] += (long long)(n))
+// Declares var; pair with INSTR_PHASE_END in the same scope
+#define INSTR_PHASE_BEGIN(var) double var = instr_now()
+#define INSTR_PHASE_END(phase, var) (instr_slot()->phase_time[phase] += instr_now() - (var))
+#define INSTR_RESET() instr_reset()
+#define INSTR_REPORT(out, label) instr_report(out, label, instr_slots)
+// Run the collective call, charging its time, one call and bytes to collective
+#define INSTR_MPI(collective, bytes, ...) do { \
+        double instr_start_ = instr_now(); \
+        __VA_ARGS__; \
+        double instr_elapsed_ = instr_now() - instr_start_; \
+        InstrSlot *instr_self_ = instr_slot(); \
+        instr_self_->phase_time[INSTR_COMM] += instr_elapsed_; \
+        instr_self_->comm_time[collective] += instr_elapsed_; \
+        instr_self_->comm_calls[collective]++; \
+        instr_self_->comm_bytes[collective] += (long long)(bytes); \
+    } while (0)
+#else
+#define INSTR_COUNT(counter, n) ((void)0)
+#define INSTR_PHASE_BEGIN(var) ((void)0)
+#define INSTR_PHASE_END(phase, var) ((void)0)
+#define INSTR_RESET() ((void)0)
+#define INSTR_REPORT(out, label) ((void)0)
+#define INSTR_MPI(collective, bytes, ...) __VA_ARGS__
+#endif
+
+#endif
@@ -0,0 +1,315 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <omp.h>
+#include "output.h"
+
+// Nodes per text chunk; each thread formats one chunk at a time into a
+// buffer of OUTPUT_CHUNK_NODES * OUTPUT_LINE_MAX bytes
+#define OUTPUT_CHUNK_NODES 65536
+
+static const char digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+bool parse_output_format(const char *name, OutputFormat *format) {
+    if (strcmp(name, "text") == 0) {
+        *format = OUTPUT_TEXT;
+    } else if (strcmp(name, "binary") == 0) {
+        *format = OUTPUT_BINARY;
+    } else if (strcmp(name, "summary") == 0) {
+        *format = OUTPUT_SUMMARY;
+    } else if (strcmp(name, "quiet") == 0) {
+        *format = OUTPUT_QUIET;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* output_format_name(OutputFormat format) {
+    switch (format) {
+        case OUTPUT_BINARY:
+            return "binary";
+        case OUTPUT_SUMMARY:
+            return "summary";
+        case OUTPUT_QUIET:
+            return "quiet";
+        case OUTPUT_TEXT:
+        default:
+            return "text";
+    }
+}
+
+static inline int count_digits(unsigned value) {
+    int digits = 1;
+    while (value >= 100) {
+        value /= 100;
+        digits += 2;
+    }
+    return digits + (value >= 10);
+}
+
+// Write value in decimal at p, two digits per step from the end; returns the end
+static inline char* write_uint(char *p, unsigned value) {
+    char *end = p + count_digits(value);
+    char *q = end;
+    while (value >= 100) {
+        q -= 2;
+        memcpy(q, digit_pairs + (value % 100) * 2, 2);
+        value /= 100;
+    }
+    if (value >= 10) {
+        memcpy(q - 2, digit_pairs + value * 2, 2);
+    } else {
+        q[-1] = (char)('0' + value);
+    }
+    return end;
+}
+
+char* format_uint(char *p, unsigned value) {
+    return write_uint(p, value);
+}
+
+// Loads reject negative weights, but the lines match printf's %d for any
+// distance, so a negative one prints with its sign
+static inline unsigned distance_magnitude(int distance) {
+    return distance < 0 ? 0u - (unsigned)distance : (unsigned)distance;
+}
+
+static inline size_t line_length(int node, int distance) {
+    // "Node " + node + ": " + distance + "\n"
+    size_t distance_length = distance == INF ? 3 : (distance < 0) + count_digits(distance_magnitude(distance));
+    return 8 + count_digits((unsigned)node) + distance_length;
+}
+
+size_t format_distance_lines(char *buffer, const int *distances, int first, int last) {
+    char *p = buffer;
+    for (int v = first; v < last; v++) {
+        memcpy(p, "Node ", 5);
+        p = write_uint(p + 5, (unsigned)v);
+        *p++ = ':';
+        *p++ = ' ';
+        if (distances[v] == INF) {
+            memcpy(p, "INF", 3);
+            p += 3;
+        } else {
+            if (distances[v] < 0) {
+                *p++ = '-';
+            }
+            p = write_uint(p, distance_magnitude(distances[v]));
+        }
+        *p++ = '\n';
+    }
+    return (size_t)(p - buffer);
+}
+
+// splitmix64 finalizer over the packed (node, distance) pair
+static inline unsigned long long mix_pair(int node, int distance) {
+    unsigned long long x = ((unsigned long long)(unsigned)node << 32) | (unsigned)distance;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+DistanceSummary summarize_distances(const int *distances, int num_nodes, int num_threads) {
+    if (num_threads <= 0) {
+        num_threads = omp_get_max_threads();
+    }
+    int reachable = 0;
+    int max_distance = 0;
+    unsigned long long checksum = 0;
+    #pragma omp parallel for num_threads(num_threads) reduction(+:reachable, checksum) reduction(max:max_distance)
+    for (int v = 0; v < num_nodes; v++) {
+        int d = distances[v];
+        checksum += mix_pair(v, d);
+        if (d != INF) {
+            reachable++;
+            if (d > max_distance) {
+                max_distance = d;
+            }
+        }
+    }
+    DistanceSummary summary = {reachable, max_distance, checksum};
+    return summary;
+}
+
+void print_distance_summary(FILE *out, int source, const DistanceSummary *summary, int num_nodes) {
+    fprintf(out, "Summary for node %d: reachable %d of %d, max distance %d, checksum %016llx\n",
+            source, summary->reachable, num_nodes, summary->max_distance, summary->checksum);
+}
+
+FILE* open_output_stream(const char *filename) {
+    if (!filename) {
+        return stdout;
+    }
+    FILE *out = fopen(filename, "w");
+    if (!out) {
+        fprintf(stderr, "Error: Cannot open file '%s' for writing\n", filename);
+        perror("fopen");
+    }
+    return out;
+}
+
+int close_output_stream(FILE *out, const char *filename) {
+    int status = filename ? fclose(out) : fflush(out);
+    if (status != 0) {
+        fprintf(stderr, "Error: Failed to write '%s'\n", filename ? filename : "standard output");
+        return -1;
+    }
+    return 0;
+}
+
+// Text to a stream: chunks are formatted in parallel and written in order
+static int write_text_stream(FILE *out, const int *distances, int num_nodes, int num_chunks, int num_threads) {
+    bool failed = false;
+    #pragma omp parallel num_threads(num_threads)
+    {
+        char *buffer = (char*)malloc((size_t)OUTPUT_CHUNK_NODES * OUTPUT_LINE_MAX);
+        if (!buffer) {
+            #pragma omp atomic write
+            failed = true;
+        }
+        #pragma omp for ordered schedule(static, 1)
+        for (int c = 0; c < num_chunks; c++) {
+            size_t length = 0;
+            if (buffer) {
+                int first = c * OUTPUT_CHUNK_NODES;
+                int last = (num_nodes - first > OUTPUT_CHUNK_NODES) ? first + OUTPUT_CHUNK_NODES : num_nodes;
+                length = format_distance_lines(buffer, distances, first, last);
+            }
+            #pragma omp ordered
+            {
+                if (buffer && fwrite(buffer, 1, length, out) != length) {
+                    failed = true;
+                }
+            }
+        }
+        free(buffer);
+    }
+    return failed ? -1 : 0;
+}
+
+static bool write_at(int fd, const char *data, size_t length, off_t offset) {
+    while (length > 0) {
+        ssize_t written = pwrite(fd, data, length, offset);
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        length -= (size_t)written;
+        offset += written;
+    }
+    return true;
+}
+
+// Text to a file: the byte length of every chunk follows from digit counts,
+// so after a prefix sum each thread formats its chunks and writes them at
+// their final offsets independently
+static int write_text_file(const char *filename, const char *header, const int *distances, int num_nodes,
+                           int num_chunks, int num_threads) {
+    off_t *offsets = (off_t*)malloc(((size_t)num_chunks + 1) * sizeof(off_t));
+    if (!offsets) {
+        perror("Error allocating output offsets");
+        return -1;
+    }
+    #pragma omp parallel for num_threads(num_threads) schedule(static)
+    for (int c = 0; c < num_chunks; c++) {
+        int first = c * OUTPUT_CHUNK_NODES;
+        int last = (num_nodes - first > OUTPUT_CHUNK_NODES) ? first + OUTPUT_CHUNK_NODES : num_nodes;
+        off_t bytes = 0;
+        for (int v = first; v < last; v++) {
+            bytes += (off_t)line_length(v, distances[v]);
+        }
+        offsets[c + 1] = bytes;
+    }
+    offsets[0] = (off_t)strlen(header);
+    for (int c = 0; c < num_chunks; c++) {
+        offsets[c + 1] += offsets[c];
+    }
+
+    int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open file '%s' for writing\n", filename);
+        perror("open");
+        free(offsets);
+        return -1;
+    }
+    bool failed = ftruncate(fd, offsets[num_chunks]) != 0 || !write_at(fd, header, strlen(header), 0);
+
+    #pragma omp parallel num_threads(num_threads)
+    {
+        char *buffer = (char*)malloc((size_t)OUTPUT_CHUNK_NODES * OUTPUT_LINE_MAX);
+        if (!buffer) {
+            #pragma omp atomic write
+            failed = true;
+        }
+        #pragma omp for schedule(dynamic, 1)
+        for (int c = 0; c < num_chunks; c++) {
+            if (!buffer) {
+                continue;
+            }
+            int first = c * OUTPUT_CHUNK_NODES;
+            int last = (num_nodes - first > OUTPUT_CHUNK_NODES) ? first + OUTPUT_CHUNK_NODES : num_nodes;
+            size_t length = format_distance_lines(buffer, distances, first, last);
+            if (!write_at(fd, buffer, length, offsets[c])) {
+                #pragma omp atomic write
+                failed = true;
+            }
+        }
+        free(buffer);
+    }
+
+    if (close(fd) != 0) {
+        failed = true;
+    }
+    if (failed) {
+        fprintf(stderr, "Error: Failed to write '%s'\n", filename);
+    }
+    free(offsets);
+    return failed ? -1 : 0;
+}
+
+int write_distances(const int *distances, int num_nodes, int source, OutputFormat format,
+                    const char *filename, int num_threads) {
+    if (num_threads <= 0) {
+        num_threads = omp_get_max_threads();
+    }
+    if (format == OUTPUT_QUIET) {
+        return 0;
+    }
+    if (format == OUTPUT_BINARY) {
+        if (!filename) {
+            fprintf(stderr, "Error: Binary output needs an output file\n");
+            return -1;
+        }
+        return write_distances_binary(distances, num_nodes, source, filename);
+    }
+
+    char header[64];
+    snprintf(header, sizeof(header), "Shortest distances from node %d:\n", source);
+    int num_chunks = (num_nodes + OUTPUT_CHUNK_NODES - 1) / OUTPUT_CHUNK_NODES;
+    if (format == OUTPUT_TEXT && filename) {
+        return write_text_file(filename, header, distances, num_nodes, num_chunks, num_threads);
+    }
+
+    FILE *out = open_output_stream(filename);
+    if (!out) {
+        return -1;
+    }
+    int status = 0;
+    if (format == OUTPUT_SUMMARY) {
+        DistanceSummary summary = summarize_distances(distances, num_nodes, num_threads);
+        print_distance_summary(out, source, &summary, num_nodes);
+    } else {
+        fputs(header, out);
+        status = write_text_stream(out, distances, num_nodes, num_chunks, num_threads);
+    }
+    if (close_output_stream(out, filename) != 0) {
+        status = -1;
+    }
+    return status;
+}
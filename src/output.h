@@ -0,0 +1,55 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "graph.h"
+
+// Result output shared by the engines (output.c)
+typedef enum {
+    OUTPUT_TEXT,      // "Shortest distances from node <s>:", then one "Node <v>: <d>" line per node
+    OUTPUT_BINARY,    // raw distance array in the binary container (see write_distances_binary)
+    OUTPUT_SUMMARY,   // one line: reachable count, largest distance and checksum
+    OUTPUT_QUIET      // no distances, only the timing lines
+} OutputFormat;
+
+// Map "text" / "binary" / "summary" / "quiet" to a format; returns false for unknown names
+bool parse_output_format(const char *name, OutputFormat *format);
+const char* output_format_name(OutputFormat format);
+
+// Write value in decimal at p (at most 10 bytes, no terminator); returns the end
+char* format_uint(char *p, unsigned value);
+
+// Longest "Node <v>: <d>\n" line; a buffer for count lines needs count * OUTPUT_LINE_MAX bytes
+#define OUTPUT_LINE_MAX 32
+
+// Format the lines of nodes [first, last) into buffer; returns the bytes written
+size_t format_distance_lines(char *buffer, const int *distances, int first, int last);
+
+// Aggregates of one distance array. The checksum is a sum of hashed
+// (node, distance) pairs, so it is computed in parallel and matches
+// between any two runs that found the same distances.
+typedef struct {
+    int reachable;
+    int max_distance;     // largest finite distance, 0 if only the source is reachable
+    unsigned long long checksum;
+} DistanceSummary;
+
+DistanceSummary summarize_distances(const int *distances, int num_nodes, int num_threads);
+void print_distance_summary(FILE *out, int source, const DistanceSummary *summary, int num_nodes);
+
+// Open filename for writing, or return stdout when it is NULL; reports and
+// returns NULL on error. Close with close_output_stream.
+FILE* open_output_stream(const char *filename);
+// Returns 0 on success, -1 if buffered output could not be written
+int close_output_stream(FILE *out, const char *filename);
+
+// Write the distances from source in the given format to filename, or to
+// stdout when filename is NULL (binary output needs a file). Text is
+// formatted in chunks on num_threads threads (<= 0: all threads); chunks
+// go to a file with positioned writes at precomputed offsets, to stdout in
+// order. Returns 0 on success, -1 on error.
+int write_distances(const int *distances, int num_nodes, int source, OutputFormat format,
+                    const char *filename, int num_threads);
+
+#endif
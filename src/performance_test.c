@@ -1,272 +1,820 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <limits.h>
 #include <stdbool.h>
+#include <string.h>
+#include <math.h>
 #include <time.h>
+#include <unistd.h>
+#include <getopt.h>
 #include <omp.h>
+#include "sssp.h"
+#include "affinity.h"
 
-#define INF INT_MAX
+// Benchmark driver: every selected engine x thread count x source, with
+// warmup runs and repeated timed runs summarized as min/median/p95/mean/stddev
+
+#define DEFAULT_ENGINES "heap,dial,radix,dijkstra,persistent,delta,multi,batch"
+#define DEFAULT_NUM_SOURCES 4
+#define DEFAULT_WARMUP 1
+#define DEFAULT_REPS 5
+
+typedef enum {
+    KIND_SEQUENTIAL,    // one source per run, always one thread
+    KIND_PARALLEL,      // one source per run, swept over thread counts
+    KIND_MULTI,         // all sources per run in lockstep passes of MULTI_SOURCE_LANES
+    KIND_BATCH          // all sources per run, one per thread (run_sssp_batch)
+} EngineKind;
 
 typedef struct {
-    int dest;
-    int weight;
-} Edge;
+    const char *name;
+    EngineKind kind;
+    SequentialEngine sequential;
+    ParallelEngine parallel;
+} BenchEngine;
+
+static const BenchEngine bench_engines[] = {
+    {"scan", KIND_SEQUENTIAL, ENGINE_SCAN, PARALLEL_ENGINE_DIJKSTRA},
+    {"heap", KIND_SEQUENTIAL, ENGINE_HEAP, PARALLEL_ENGINE_DIJKSTRA},
+    {"dial", KIND_SEQUENTIAL, ENGINE_DIAL, PARALLEL_ENGINE_DIJKSTRA},
+    {"radix", KIND_SEQUENTIAL, ENGINE_RADIX, PARALLEL_ENGINE_DIJKSTRA},
+    {"dijkstra", KIND_PARALLEL, ENGINE_AUTO, PARALLEL_ENGINE_DIJKSTRA},
+    {"persistent", KIND_PARALLEL, ENGINE_AUTO, PARALLEL_ENGINE_PERSISTENT},
+    {"delta", KIND_PARALLEL, ENGINE_AUTO, PARALLEL_ENGINE_DELTA},
+    {"multi", KIND_MULTI, ENGINE_AUTO, PARALLEL_ENGINE_DIJKSTRA},
+    {"batch", KIND_BATCH, ENGINE_AUTO, PARALLEL_ENGINE_DIJKSTRA}
+};
+#define NUM_BENCH_ENGINES ((int)(sizeof(bench_engines) / sizeof(bench_engines[0])))
 
 typedef struct {
-    int num_nodes;
-    int num_edges;
-    Edge **adj_list;
-    int *adj_size;
-} Graph;
+    double min;
+    double median;
+    double p95;
+    double mean;
+    double stddev;
+} SampleStats;
 
-Graph* create_graph(int num_nodes, int num_edges) {
-    Graph *graph = (Graph*)malloc(sizeof(Graph));
-    graph->num_nodes = num_nodes;
-    graph->num_edges = num_edges;
-    graph->adj_list = (Edge**)malloc(num_nodes * sizeof(Edge*));
-    graph->adj_size = (int*)calloc(num_nodes, sizeof(int));
-    
-    for (int i = 0; i < num_nodes; i++) {
-        graph->adj_list[i] = (Edge*)malloc(sizeof(Edge));
-    }
-    
-    return graph;
-}
+// Source -1 stands for "all sources" (multi and batch); times are per query
+typedef struct {
+    const BenchEngine *engine;
+    int threads;
+    int source;
+    SampleStats stats;
+    double speedup;     // baseline median / median, 0 if there is no baseline
+    bool verified;      // every checked run matched the reference
+} BenchResult;
 
-void add_edge(Graph *graph, int u, int v, int weight) {
-    int u_size = graph->adj_size[u];
-    int v_size = graph->adj_size[v];
-    
-    graph->adj_list[u] = (Edge*)realloc(graph->adj_list[u], (u_size + 1) * sizeof(Edge));
-    graph->adj_list[u][u_size].dest = v;
-    graph->adj_list[u][u_size].weight = weight;
-    graph->adj_size[u]++;
-    
-    graph->adj_list[v] = (Edge*)realloc(graph->adj_list[v], (v_size + 1) * sizeof(Edge));
-    graph->adj_list[v][v_size].dest = u;
-    graph->adj_list[v][v_size].weight = weight;
-    graph->adj_size[v]++;
+typedef struct {
+    const Graph *graph;
+    int delta;
+    SequentialEngine batch_engine;
+    const int *sources;         // node ids the engines start from
+    const int *input_sources;   // the same sources as input ids (differ on reordered graphs)
+    int num_sources;
+    const DistanceSummary *reference;   // per source
+    const DistanceSummary *input_reference; // the same by input id, as batch reports them
+    DistanceSummary *batch_summaries;
+    int *distances;
+    int *multi_distances[MULTI_SOURCE_LANES];
+    SsspWorkspace *workspaces[NUM_BENCH_ENGINES];
+} Bench;
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--engines <list>] [--threads <list>] [--num-sources <k> | --sources <file> | --source-range <first>:<last>]\n", prog);
+    fprintf(stderr, "       [--warmup <n>] [--reps <n>] [--delta <width>] [--bind none|close|spread] [--numa]\n");
+    fprintf(stderr, "       [--reorder input|rcm|bfs|degree]\n");
+    fprintf(stderr, "       [--csv <file>] [--json <file>] <input_file> [num_threads]\n");
+    fprintf(stderr, "Engines: scan, heap, dial, radix (sequential), dijkstra, persistent, delta (OpenMP),\n");
+    fprintf(stderr, "multi (lockstep multi-source), batch (one source per thread); default %s\n", DEFAULT_ENGINES);
+    fprintf(stderr, "Threads: comma-separated counts, default powers of two up to the OpenMP maximum\n");
+    fprintf(stderr, "--numa re-places the graph with parallel first-touch for the largest count (--bind spread unless given)\n");
+    fprintf(stderr, "--reorder renumbers the nodes for locality before the runs; sources stay input ids\n");
+    fprintf(stderr, "Example: %s --threads 1,2,4,8 --reps 10 --csv results.csv weighted_graph.bin\n", prog);
 }
 
-void free_graph(Graph *graph) {
-    for (int i = 0; i < graph->num_nodes; i++) {
-        free(graph->adj_list[i]);
+static const BenchEngine* find_engine(const char *name, size_t length) {
+    for (int i = 0; i < NUM_BENCH_ENGINES; i++) {
+        if (strlen(bench_engines[i].name) == length && strncmp(bench_engines[i].name, name, length) == 0) {
+            return &bench_engines[i];
+        }
     }
-    free(graph->adj_list);
-    free(graph->adj_size);
-    free(graph);
+    return NULL;
 }
 
-// Sequential Dijkstra's algorithm
-void dijkstra_sequential(Graph *graph, int source, int *distances) {
-    bool *visited = (bool*)calloc(graph->num_nodes, sizeof(bool));
-    
-    for (int i = 0; i < graph->num_nodes; i++) {
-        distances[i] = INF;
-    }
-    distances[source] = 0;
-    
-    for (int count = 0; count < graph->num_nodes; count++) {
-        int min_dist = INF;
-        int min_node = -1;
-        
-        for (int v = 0; v < graph->num_nodes; v++) {
-            if (!visited[v] && distances[v] < min_dist) {
-                min_dist = distances[v];
-                min_node = v;
-            }
+// Parse a comma-separated engine list into engines; returns the count, 0 on error
+static int parse_engine_list(const char *list, const BenchEngine **engines) {
+    int count = 0;
+    const char *p = list;
+    while (*p) {
+        size_t length = strcspn(p, ",");
+        const BenchEngine *engine = find_engine(p, length);
+        if (!engine) {
+            fprintf(stderr, "Error: Unknown engine '%.*s'\n", (int)length, p);
+            return 0;
         }
-        
-        if (min_node == -1) {
-            break;
+        bool duplicate = false;
+        for (int i = 0; i < count; i++) {
+            duplicate = duplicate || engines[i] == engine;
         }
-        
-        visited[min_node] = true;
-        
-        for (int i = 0; i < graph->adj_size[min_node]; i++) {
-            int neighbor = graph->adj_list[min_node][i].dest;
-            int weight = graph->adj_list[min_node][i].weight;
-            
-            if (!visited[neighbor] && distances[min_node] != INF) {
-                int new_dist = distances[min_node] + weight;
-                if (new_dist < distances[neighbor]) {
-                    distances[neighbor] = new_dist;
-                }
-            }
+        if (!duplicate) {
+            engines[count++] = engine;
+        }
+        p += length;
+        if (*p == ',') {
+            p++;
         }
     }
-    
-    free(visited);
+    return count;
 }
 
-// Parallel Dijkstra's algorithm
-void dijkstra_parallel(Graph *graph, int source, int *distances, int num_threads) {
-    bool *visited = (bool*)calloc(graph->num_nodes, sizeof(bool));
-    
-    #pragma omp parallel for num_threads(num_threads)
-    for (int i = 0; i < graph->num_nodes; i++) {
-        distances[i] = INF;
+// Parse a comma-separated list of positive integers; returns a malloc'd
+// array and its length in *count, or NULL if the list is malformed
+static int* parse_thread_list(const char *list, int *count) {
+    int capacity = 1;
+    for (const char *p = list; *p; p++) {
+        capacity += (*p == ',');
     }
-    distances[source] = 0;
-    
-    for (int count = 0; count < graph->num_nodes; count++) {
-        int min_dist = INF;
-        int min_node = -1;
-        
-        #pragma omp parallel num_threads(num_threads)
-        {
-            int local_min_dist = INF;
-            int local_min_node = -1;
-            
-            #pragma omp for nowait
-            for (int v = 0; v < graph->num_nodes; v++) {
-                if (!visited[v] && distances[v] < local_min_dist) {
-                    local_min_dist = distances[v];
-                    local_min_node = v;
-                }
-            }
-            
-            #pragma omp critical
-            {
-                if (local_min_dist < min_dist) {
-                    min_dist = local_min_dist;
-                    min_node = local_min_node;
-                }
-            }
+    int *values = (int*)malloc((size_t)capacity * sizeof(int));
+    if (!values) {
+        perror("Error allocating thread list");
+        return NULL;
+    }
+    int n = 0;
+    const char *p = list;
+    while (*p) {
+        char *end;
+        long value = strtol(p, &end, 10);
+        if (end == p || value <= 0 || value > 4096 || (*end != ',' && *end != '\0')) {
+            fprintf(stderr, "Error: Invalid thread list '%s'\n", list);
+            free(values);
+            return NULL;
         }
-        
-        if (min_dist == INF || min_node == -1) {
-            break;
+        values[n++] = (int)value;
+        p = (*end == ',') ? end + 1 : end;
+    }
+    if (n == 0) {
+        fprintf(stderr, "Error: Empty thread list\n");
+        free(values);
+        return NULL;
+    }
+    *count = n;
+    return values;
+}
+
+// Powers of two up to max_threads, plus max_threads itself
+static int* default_thread_list(int max_threads, int *count) {
+    int *values = (int*)malloc(34 * sizeof(int));
+    if (!values) {
+        perror("Error allocating thread list");
+        return NULL;
+    }
+    int n = 0;
+    for (int t = 1; t < max_threads; t *= 2) {
+        values[n++] = t;
+    }
+    values[n++] = max_threads;
+    *count = n;
+    return values;
+}
+
+// k sources spread evenly over the node ids
+static int* spread_sources(int num_nodes, int k, int *count) {
+    if (k > num_nodes) {
+        k = num_nodes;
+    }
+    int *sources = (int*)malloc((size_t)k * sizeof(int));
+    if (!sources) {
+        perror("Error allocating sources");
+        return NULL;
+    }
+    for (int i = 0; i < k; i++) {
+        sources[i] = (int)((long long)i * num_nodes / k);
+    }
+    *count = k;
+    return sources;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Sorts samples in place. p95 is the nearest-rank percentile; stddev is
+// the sample standard deviation (0 for a single sample).
+static SampleStats compute_stats(double *samples, int n) {
+    qsort(samples, (size_t)n, sizeof(double), compare_doubles);
+    SampleStats stats;
+    stats.min = samples[0];
+    stats.median = (n % 2) ? samples[n / 2] : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+    int rank = (int)ceil(0.95 * n);
+    stats.p95 = samples[rank > 0 ? rank - 1 : 0];
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        sum += samples[i];
+    }
+    stats.mean = sum / n;
+    double squares = 0.0;
+    for (int i = 0; i < n; i++) {
+        squares += (samples[i] - stats.mean) * (samples[i] - stats.mean);
+    }
+    stats.stddev = (n > 1) ? sqrt(squares / (n - 1)) : 0.0;
+    return stats;
+}
+
+static bool same_summary(const DistanceSummary *a, const DistanceSummary *b) {
+    return a->reachable == b->reachable && a->max_distance == b->max_distance && a->checksum == b->checksum;
+}
+
+static bool matches_reference(const Bench *bench, int k, const int *distances) {
+    DistanceSummary summary = summarize_distances(distances, bench->graph->num_nodes, 1);
+    return same_summary(&summary, &bench->reference[k]);
+}
+
+// The timed batch runs write nothing, so each configuration is checked by
+// one extra untimed run that collects the summary of every source
+static bool verify_batch(Bench *bench, int threads, bool *verified) {
+    if (run_sssp_batch(bench->graph, bench->batch_engine, bench->input_sources, bench->num_sources, threads,
+                       NULL, OUTPUT_QUIET, bench->batch_summaries) < 0) {
+        return false;
+    }
+    for (int k = 0; k < bench->num_sources; k++) {
+        *verified = *verified && same_summary(&bench->batch_summaries[k], &bench->input_reference[k]);
+    }
+    return true;
+}
+
+// One timed run of engine. k indexes the source (ignored by multi and
+// batch). Returns the seconds per query, or a negative value on error;
+// *verified is cleared if the distances differ from the reference (batch
+// runs are checked by verify_batch instead).
+static double run_once(Bench *bench, const BenchEngine *engine, int threads, int k, bool *verified) {
+    const Graph *graph = bench->graph;
+    double start;
+    double elapsed;
+    switch (engine->kind) {
+        case KIND_SEQUENTIAL: {
+            SsspWorkspace *ws = bench->workspaces[engine - bench_engines];
+            start = omp_get_wtime();
+            if (sssp_workspace_run(ws, bench->sources[k], bench->distances) != 0) {
+                return -1.0;
+            }
+            elapsed = omp_get_wtime() - start;
+            *verified = *verified && matches_reference(bench, k, bench->distances);
+            return elapsed;
         }
-        
-        visited[min_node] = true;
-        
-        int adj_size = graph->adj_size[min_node];
-        int base_dist = distances[min_node];
-        
-        #pragma omp parallel for num_threads(num_threads)
-        for (int i = 0; i < adj_size; i++) {
-            int neighbor = graph->adj_list[min_node][i].dest;
-            int weight = graph->adj_list[min_node][i].weight;
-            
-            if (!visited[neighbor] && base_dist != INF) {
-                int new_dist = base_dist + weight;
-                #pragma omp critical
-                {
-                    if (new_dist < distances[neighbor]) {
-                        distances[neighbor] = new_dist;
-                    }
+        case KIND_PARALLEL:
+            start = omp_get_wtime();
+            if (run_parallel_engine(engine->parallel, graph, bench->sources[k], bench->distances, threads,
+                                    bench->delta) != 0) {
+                return -1.0;
+            }
+            elapsed = omp_get_wtime() - start;
+            *verified = *verified && matches_reference(bench, k, bench->distances);
+            return elapsed;
+        case KIND_MULTI:
+            elapsed = 0.0;
+            for (int first = 0; first < bench->num_sources; first += MULTI_SOURCE_LANES) {
+                int lanes = bench->num_sources - first;
+                if (lanes > MULTI_SOURCE_LANES) {
+                    lanes = MULTI_SOURCE_LANES;
+                }
+                start = omp_get_wtime();
+                if (dijkstra_multi_source(graph, bench->sources + first, lanes, bench->multi_distances,
+                                          bench->delta) != 0) {
+                    return -1.0;
+                }
+                elapsed += omp_get_wtime() - start;
+                for (int lane = 0; lane < lanes; lane++) {
+                    *verified = *verified && matches_reference(bench, first + lane, bench->multi_distances[lane]);
                 }
             }
-        }
+            return elapsed / bench->num_sources;
+        case KIND_BATCH:
+        default:
+            elapsed = run_sssp_batch(graph, bench->batch_engine, bench->input_sources, bench->num_sources, threads,
+                                     NULL, OUTPUT_QUIET, NULL);
+            return elapsed < 0 ? elapsed : elapsed / bench->num_sources;
     }
-    
-    free(visited);
 }
 
-bool verify_results(int *dist1, int *dist2, int num_nodes) {
-    for (int i = 0; i < num_nodes; i++) {
-        if (dist1[i] != dist2[i]) {
+// Warmup plus timed repetitions for one configuration
+static bool measure(Bench *bench, const BenchEngine *engine, int threads, int k, int warmup, int reps,
+                    double *samples, BenchResult *result) {
+    bool verified = true;
+    if (engine->kind == KIND_BATCH && !verify_batch(bench, threads, &verified)) {
+        return false;
+    }
+    for (int i = 0; i < warmup + reps; i++) {
+        double seconds = run_once(bench, engine, threads, k, &verified);
+        if (seconds < 0) {
             return false;
         }
+        if (i >= warmup) {
+            samples[i - warmup] = seconds;
+        }
     }
+    result->engine = engine;
+    result->threads = threads;
+    result->source = (engine->kind == KIND_MULTI || engine->kind == KIND_BATCH) ? -1 : bench->input_sources[k];
+    result->stats = compute_stats(samples, reps);
+    result->speedup = 0.0;
+    result->verified = verified;
     return true;
 }
 
-Graph* read_graph_from_file(const char *filename) {
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        perror("Error opening file");
-        return NULL;
+static const char* verified_name(bool verified) {
+    return verified ? "PASSED" : "FAILED";
+}
+
+static void print_result(const BenchResult *r) {
+    char source[16];
+    if (r->source < 0) {
+        snprintf(source, sizeof(source), "all");
+    } else {
+        snprintf(source, sizeof(source), "%d", r->source);
     }
-    
-    int first = fgetc(file);
-    int second = fgetc(file);
-    int third = fgetc(file);
-    
-    if (first == 0xEF && second == 0xBB && third == 0xBF) {
+    char speedup[16];
+    if (r->speedup > 0) {
+        snprintf(speedup, sizeof(speedup), "%.3fx", r->speedup);
     } else {
-        rewind(file);
+        snprintf(speedup, sizeof(speedup), "-");
     }
-    
-    int num_nodes, num_edges;
-    fscanf(file, "%d %d", &num_nodes, &num_edges);
-    
-    Graph *graph = create_graph(num_nodes, num_edges);
-    
-    for (int i = 0; i < num_edges; i++) {
-        int u, v, weight;
-        fscanf(file, "%d %d %d", &u, &v, &weight);
-        add_edge(graph, u, v, weight);
+    printf("%-11s %7d %8s %12.4f %12.4f %12.4f %12.4f %9s %8s\n", r->engine->name, r->threads, source,
+           r->stats.median * 1e3, r->stats.p95 * 1e3, r->stats.min * 1e3, r->stats.stddev * 1e3, speedup,
+           verified_name(r->verified));
+}
+
+typedef struct {
+    const char *filename;
+    const Graph *graph;
+    double load_time;
+    double reorder_time;
+    char timestamp[32];
+    char host[64];
+    int max_threads;
+    int warmup;
+    int reps;
+    int delta;
+    const char *format;     // "binary" or "text", as loaded
+    ThreadBinding binding;
+    bool first_touch;
+    const char *baseline;   // NULL without a sequential engine
+} BenchInfo;
+
+static int write_csv(const char *path, const BenchInfo *info, const BenchResult *results, int count) {
+    FILE *out = open_output_stream(path);
+    if (!out) {
+        return -1;
     }
-    
-    fclose(file);
-    return graph;
+    fprintf(out, "timestamp,host,graph,nodes,edges,max_weight,engine,threads,source,warmup,reps,"
+                 "min,median,p95,mean,stddev,speedup,verified\n");
+    for (int i = 0; i < count; i++) {
+        const BenchResult *r = &results[i];
+        fprintf(out, "%s,\"%s\",\"%s\",%d,%d,%d,%s,%d,%d,%d,%d,%.9f,%.9f,%.9f,%.9f,%.9f,%.6f,%s\n",
+                info->timestamp, info->host, info->filename, info->graph->num_nodes, info->graph->num_edges,
+                info->graph->max_weight, r->engine->name, r->threads, r->source, info->warmup, info->reps,
+                r->stats.min, r->stats.median, r->stats.p95, r->stats.mean, r->stats.stddev, r->speedup,
+                verified_name(r->verified));
+    }
+    return close_output_stream(out, path);
+}
+
+// Strings written to JSON are file names and host names; escape quotes,
+// backslashes and control characters
+static void write_json_string(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            fprintf(out, "\\%c", c);
+        } else if (c < 0x20) {
+            fprintf(out, "\\u%04x", c);
+        } else {
+            fputc(c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static int write_json(const char *path, const BenchInfo *info, const BenchResult *results, int count) {
+    FILE *out = open_output_stream(path);
+    if (!out) {
+        return -1;
+    }
+    const Graph *graph = info->graph;
+    fprintf(out, "{\n  \"graph\": {\"file\": ");
+    write_json_string(out, info->filename);
+    fprintf(out, ", \"nodes\": %d, \"edges\": %d, \"max_weight\": %d, \"format\": \"%s\", \"load_seconds\": %.6f, "
+                 "\"order\": \"%s\", \"reorder_seconds\": %.6f},\n",
+            graph->num_nodes, graph->num_edges, graph->max_weight, info->format, info->load_time,
+            vertex_order_name(graph->order), info->reorder_time);
+    fprintf(out, "  \"run\": {\"timestamp\": \"%s\", \"host\": ", info->timestamp);
+    write_json_string(out, info->host);
+    fprintf(out, ", \"max_threads\": %d, \"warmup\": %d, \"reps\": %d, \"delta\": %d, \"binding\": \"%s\", "
+                 "\"first_touch\": %s, \"baseline\": ",
+            info->max_threads, info->warmup, info->reps, info->delta, thread_binding_name(info->binding),
+            info->first_touch ? "true" : "false");
+    if (info->baseline) {
+        write_json_string(out, info->baseline);
+    } else {
+        fprintf(out, "null");
+    }
+    fprintf(out, "},\n  \"results\": [\n");
+    for (int i = 0; i < count; i++) {
+        const BenchResult *r = &results[i];
+        fprintf(out, "    {\"engine\": \"%s\", \"threads\": %d, \"source\": %d, \"min\": %.9f, \"median\": %.9f, "
+                     "\"p95\": %.9f, \"mean\": %.9f, \"stddev\": %.9f, \"speedup\": %.6f, \"verified\": %s}%s\n",
+                r->engine->name, r->threads, r->source, r->stats.min, r->stats.median, r->stats.p95, r->stats.mean,
+                r->stats.stddev, r->speedup, r->verified ? "true" : "false",
+                i + 1 < count ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+    return close_output_stream(out, path);
 }
 
 int main(int argc, char *argv[]) {
-    if (argc < 2) {
-        fprintf(stderr, "Usage: %s <input_file> [num_threads]\n", argv[0]);
-        fprintf(stderr, "Example: %s weighted_graph.txt 4\n", argv[0]);
+    const char *engine_list = DEFAULT_ENGINES;
+    const char *thread_list = NULL;
+    int num_spread = DEFAULT_NUM_SOURCES;
+    const char *source_file = NULL;
+    const char *source_range = NULL;
+    int warmup = DEFAULT_WARMUP;
+    int reps = DEFAULT_REPS;
+    int delta = 0;
+    const char *csv_file = NULL;
+    const char *json_file = NULL;
+    ThreadBinding binding = BIND_NONE;
+    bool binding_given = false;
+    bool first_touch = false;
+    VertexOrder reorder;
+    bool reorder_given = false;
+    bool engines_given = false;
+    
+    static const struct option long_options[] = {
+        {"engines", required_argument, NULL, 'e'},
+        {"threads", required_argument, NULL, 't'},
+        {"num-sources", required_argument, NULL, 'n'},
+        {"sources", required_argument, NULL, 'S'},
+        {"source-range", required_argument, NULL, 'R'},
+        {"warmup", required_argument, NULL, 'w'},
+        {"reps", required_argument, NULL, 'r'},
+        {"delta", required_argument, NULL, 'd'},
+        {"csv", required_argument, NULL, 'c'},
+        {"json", required_argument, NULL, 'j'},
+        {"bind", required_argument, NULL, 'b'},
+        {"numa", no_argument, NULL, 'N'},
+        {"reorder", required_argument, NULL, 'o'},
+        {NULL, 0, NULL, 0}
+    };
+    
+    int opt;
+    while ((opt = getopt_long(argc, argv, "e:t:n:S:R:w:r:d:c:j:b:No:", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'e':
+                engine_list = optarg;
+                engines_given = true;
+                break;
+            case 't':
+                thread_list = optarg;
+                break;
+            case 'n':
+                num_spread = atoi(optarg);
+                if (num_spread <= 0) {
+                    fprintf(stderr, "Error: Number of sources must be positive\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'S':
+                source_file = optarg;
+                break;
+            case 'R':
+                source_range = optarg;
+                break;
+            case 'w':
+                warmup = atoi(optarg);
+                if (warmup < 0) {
+                    fprintf(stderr, "Error: Warmup runs must not be negative\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'r':
+                reps = atoi(optarg);
+                if (reps <= 0) {
+                    fprintf(stderr, "Error: Repetitions must be positive\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'd':
+                delta = atoi(optarg);
+                if (delta <= 0) {
+                    fprintf(stderr, "Error: Delta must be positive\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'c':
+                csv_file = optarg;
+                break;
+            case 'j':
+                json_file = optarg;
+                break;
+            case 'b':
+                if (!parse_thread_binding(optarg, &binding)) {
+                    fprintf(stderr, "Error: Unknown binding '%s' (use none, close or spread)\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                binding_given = true;
+                break;
+            case 'N':
+                first_touch = true;
+                break;
+            case 'o':
+                if (!parse_vertex_order(optarg, &reorder)) {
+                    fprintf(stderr, "Error: Unknown vertex order '%s'\n", optarg);
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                reorder_given = true;
+                break;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    
+    if (argc - optind < 1 || argc - optind > 2 || (source_file && source_range)) {
+        print_usage(argv[0]);
         return EXIT_FAILURE;
     }
     
-    const char *filename = argv[1];
-    int num_threads = (argc >= 3) ? atoi(argv[2]) : 4;
-    int source = 0;
+    const BenchEngine *engines[NUM_BENCH_ENGINES];
+    int num_engines = parse_engine_list(engine_list, engines);
+    if (num_engines == 0) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
     
-    if (num_threads <= 0) {
-        num_threads = 4;
+    // A trailing thread count (the old interface) runs that single count
+    int max_threads = omp_get_max_threads();
+    int num_counts = 0;
+    int *thread_counts;
+    if (thread_list) {
+        thread_counts = parse_thread_list(thread_list, &num_counts);
+    } else if (argc - optind == 2) {
+        thread_counts = parse_thread_list(argv[optind + 1], &num_counts);
+    } else {
+        thread_counts = default_thread_list(max_threads, &num_counts);
+    }
+    if (!thread_counts) {
+        return EXIT_FAILURE;
     }
     
-    omp_set_num_threads(num_threads);
+    // Threads are pinned and the graph placed for the widest count of the
+    // sweep; narrower teams reuse the first threads of that placement
+    int widest = 1;
+    for (int c = 0; c < num_counts; c++) {
+        if (thread_counts[c] > widest) {
+            widest = thread_counts[c];
+        }
+    }
+    if (first_touch && !binding_given) {
+        binding = BIND_SPREAD;
+    }
+    if (!bind_threads(binding, widest)) {
+        free(thread_counts);
+        return EXIT_FAILURE;
+    }
     
+    const char *filename = argv[optind];
+    double load_start = omp_get_wtime();
     Graph *graph = read_graph_from_file(filename);
-    if (!graph) {
+    double load_time = omp_get_wtime() - load_start;
+    const char *graph_format = (graph && graph->mapping) ? "binary" : "text";
+    double reorder_start = omp_get_wtime();
+    bool reordered = graph && (!reorder_given || reorder_graph(graph, reorder, widest) == 0);
+    double reorder_time = reorder_given ? omp_get_wtime() - reorder_start : 0.0;
+    if (!reordered || (first_touch && graph_first_touch(graph, widest) != 0)) {
+        free(thread_counts);
+        free_graph(graph);
+        return EXIT_FAILURE;
+    }
+    
+    int num_sources = 0;
+    int *sources;
+    if (source_file) {
+        sources = read_source_list(source_file, &num_sources);
+    } else if (source_range) {
+        sources = parse_source_range(source_range, &num_sources);
+    } else {
+        sources = spread_sources(graph->num_nodes, num_spread, &num_sources);
+    }
+    int *source_nodes = NULL;
+    if (sources && check_sources(sources, num_sources, graph->num_nodes)) {
+        source_nodes = (int*)malloc((size_t)num_sources * sizeof(int));
+        if (!source_nodes) {
+            perror("Error allocating source list");
+        }
+    }
+    if (!source_nodes) {
+        free(sources);
+        free(thread_counts);
+        free_graph(graph);
         return EXIT_FAILURE;
     }
     
-    printf("Graph loaded: %d nodes, %d edges\n", graph->num_nodes, graph->num_edges);
-    printf("Testing with source node: %d\n", source);
-    printf("Number of threads: %d\n\n", num_threads);
+    if (delta <= 0) {
+        delta = default_delta(graph);
+    }
     
-    int *dist_seq = (int*)malloc(graph->num_nodes * sizeof(int));
-    int *dist_par = (int*)malloc(graph->num_nodes * sizeof(int));
+    // The default list leaves out sequential engines this graph rules out
+    // (dial on heavy weights); an engine named with --engines fails instead
+    const BenchEngine *skipped[NUM_BENCH_ENGINES];
+    int num_skipped = 0;
+    if (!engines_given) {
+        int kept = 0;
+        for (int i = 0; i < num_engines; i++) {
+            if (engines[i]->kind == KIND_SEQUENTIAL && !sequential_engine_supported(engines[i]->sequential, graph)) {
+                skipped[num_skipped++] = engines[i];
+            } else {
+                engines[kept++] = engines[i];
+            }
+        }
+        num_engines = kept;
+    }
     
-    printf("Running sequential Dijkstra...\n");
-    double start_seq = omp_get_wtime();
-    dijkstra_sequential(graph, source, dist_seq);
-    double end_seq = omp_get_wtime();
-    double time_seq = end_seq - start_seq;
+    // Reference distances (as summaries) from the automatic sequential engine
+    Bench bench;
+    memset(&bench, 0, sizeof(bench));
+    bench.graph = graph;
+    bench.delta = delta;
+    bench.batch_engine = resolve_sequential_engine(ENGINE_AUTO, graph);
+    for (int k = 0; k < num_sources; k++) {
+        source_nodes[k] = graph_node(graph, sources[k]);
+    }
+    bench.sources = source_nodes;
+    bench.input_sources = sources;
+    bench.num_sources = num_sources;
+    DistanceSummary *reference = (DistanceSummary*)malloc((size_t)num_sources * sizeof(DistanceSummary));
+    DistanceSummary *input_reference = (DistanceSummary*)malloc((size_t)num_sources * sizeof(DistanceSummary));
+    bench.batch_summaries = (DistanceSummary*)malloc((size_t)num_sources * sizeof(DistanceSummary));
+    bench.distances = (int*)malloc((size_t)graph->num_nodes * sizeof(int));
+    bool ok = reference && input_reference && bench.batch_summaries && bench.distances;
+    for (int lane = 0; ok && lane < MULTI_SOURCE_LANES; lane++) {
+        bench.multi_distances[lane] = (int*)malloc((size_t)graph->num_nodes * sizeof(int));
+        ok = bench.multi_distances[lane] != NULL;
+    }
+    if (!ok) {
+        perror("Error allocating benchmark buffers");
+    }
+    // Workspace failures are reported by sssp_workspace_create
+    for (int i = 0; ok && i < num_engines; i++) {
+        if (engines[i]->kind == KIND_SEQUENTIAL) {
+            int e = (int)(engines[i] - bench_engines);
+            bench.workspaces[e] = sssp_workspace_create(graph, engines[i]->sequential);
+            ok = bench.workspaces[e] != NULL;
+        }
+    }
+    SsspWorkspace *reference_ws = ok ? sssp_workspace_create(graph, bench.batch_engine) : NULL;
+    ok = ok && reference_ws;
+    for (int k = 0; ok && k < num_sources; k++) {
+        ok = sssp_workspace_run(reference_ws, source_nodes[k], bench.distances) == 0;
+        reference[k] = summarize_distances(bench.distances, graph->num_nodes, 0);
+        input_reference[k] = reference[k];
+        if (ok && graph->original_id) {
+            ok = restore_input_order(bench.distances, graph->original_id, graph->num_nodes, 0) == 0;
+            input_reference[k] = summarize_distances(bench.distances, graph->num_nodes, 0);
+        }
+    }
+    sssp_workspace_free(reference_ws);
+    bench.reference = reference;
+    bench.input_reference = input_reference;
     
-    printf("Running parallel Dijkstra...\n");
-    double start_par = omp_get_wtime();
-    dijkstra_parallel(graph, source, dist_par, num_threads);
-    double end_par = omp_get_wtime();
-    double time_par = end_par - start_par;
+    // Every engine runs each configuration's thread count or, if sequential, once
+    int capacity = num_engines * num_counts * num_sources;
+    BenchResult *results = ok ? (BenchResult*)malloc((size_t)capacity * sizeof(BenchResult)) : NULL;
+    double *samples = ok ? (double*)malloc((size_t)reps * sizeof(double)) : NULL;
+    if (ok && (!results || !samples)) {
+        perror("Error allocating benchmark buffers");
+        ok = false;
+    }
     
-    bool correct = verify_results(dist_seq, dist_par, graph->num_nodes);
+    BenchInfo info;
+    info.filename = filename;
+    info.graph = graph;
+    info.load_time = load_time;
+    info.reorder_time = reorder_time;
+    time_t now = time(NULL);
+    strftime(info.timestamp, sizeof(info.timestamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    if (gethostname(info.host, sizeof(info.host)) != 0) {
+        snprintf(info.host, sizeof(info.host), "unknown");
+    }
+    info.host[sizeof(info.host) - 1] = '\0';
+    info.max_threads = max_threads;
+    info.warmup = warmup;
+    info.reps = reps;
+    info.delta = delta;
+    info.format = graph_format;
+    info.binding = binding;
+    info.first_touch = first_touch;
+    info.baseline = NULL;
     
-    printf("\n=== Performance Results ===\n");
-    printf("Sequential time:  %.6f seconds\n", time_seq);
-    printf("Parallel time:    %.6f seconds\n", time_par);
-    printf("Speedup:          %.4fx\n", time_seq / time_par);
-    printf("Efficiency:       %.2f%%\n", (time_seq / time_par) / num_threads * 100);
-    printf("Correctness:      %s\n\n", correct ? "PASSED" : "FAILED");
+    if (ok) {
+        printf("Graph loaded: %d nodes, %d edges, max weight %d (%.6f seconds)\n",
+               graph->num_nodes, graph->num_edges, graph->max_weight, load_time);
+        if (graph->order != ORDER_INPUT || reorder_given) {
+            printf("Vertex order: %s (reorder time %.6f seconds)\n", vertex_order_name(graph->order), reorder_time);
+        }
+        printf("Sources: %d, warmup runs: %d, timed runs: %d, delta: %d, threads:", num_sources, warmup, reps, delta);
+        for (int c = 0; c < num_counts; c++) {
+            printf(" %d", thread_counts[c]);
+        }
+        printf("\n");
+        if (num_skipped > 0) {
+            printf("Skipped for edge weights above %d:", DIAL_MAX_WEIGHT);
+            for (int i = 0; i < num_skipped; i++) {
+                printf(" %s", skipped[i]->name);
+            }
+            printf("\n");
+        }
+        if (binding != BIND_NONE || first_touch) {
+            print_thread_placement(stdout, binding, widest);
+            if (first_touch) {
+                print_memory_placement(stdout, "adjacency", graph->dest,
+                                       (size_t)graph->offsets[graph->num_nodes] * sizeof(int));
+            }
+        }
+        printf("Times are milliseconds per query (seconds in CSV/JSON); speedup is against the first sequential engine listed\n\n");
+        printf("%-11s %7s %8s %12s %12s %12s %12s %9s %8s\n",
+               "engine", "threads", "source", "median", "p95", "min", "stddev", "speedup", "check");
+    }
     
-    printf("Sample distances (first 10 nodes):\n");
-    for (int i = 0; i < (graph->num_nodes < 10 ? graph->num_nodes : 10); i++) {
-        if (dist_seq[i] == INF) {
-            printf("  Node %d: INF\n", i);
-        } else {
-            printf("  Node %d: %d\n", i, dist_seq[i]);
+    int count = 0;
+    bool correct = true;
+    for (int i = 0; ok && i < num_engines; i++) {
+        const BenchEngine *engine = engines[i];
+        bool threaded = engine->kind == KIND_PARALLEL || engine->kind == KIND_BATCH;
+        bool per_source = engine->kind == KIND_SEQUENTIAL || engine->kind == KIND_PARALLEL;
+        for (int c = 0; ok && c < (threaded ? num_counts : 1); c++) {
+            int threads = threaded ? thread_counts[c] : 1;
+            for (int k = 0; ok && k < (per_source ? num_sources : 1); k++) {
+                BenchResult *r = &results[count];
+                ok = measure(&bench, engine, threads, k, warmup, reps, samples, r);
+                if (!ok) {
+                    break;
+                }
+                if (!info.baseline && engine->kind == KIND_SEQUENTIAL) {
+                    info.baseline = engine->name;
+                }
+                // Baseline: the first sequential engine's run on the same source,
+                // or the mean of its runs for the all-source engines
+                double base = 0.0;
+                int base_runs = 0;
+                for (int j = 0; info.baseline && j < count; j++) {
+                    if (strcmp(results[j].engine->name, info.baseline) == 0 &&
+                        (r->source < 0 || results[j].source == r->source)) {
+                        base += results[j].stats.median;
+                        base_runs++;
+                    }
+                }
+                if (info.baseline && strcmp(engine->name, info.baseline) == 0) {
+                    r->speedup = 1.0;
+                } else if (base_runs > 0) {
+                    r->speedup = (base / base_runs) / r->stats.median;
+                }
+                correct = correct && r->verified;
+                print_result(r);
+                fflush(stdout);
+                count++;
+            }
         }
     }
     
-    free(dist_seq);
-    free(dist_par);
+    int status = ok ? 0 : -1;
+    if (ok) {
+        printf("\nCorrectness: %s\n", correct ? "PASSED" : "FAILED");
+        if (csv_file && write_csv(csv_file, &info, results, count) != 0) {
+            status = -1;
+        }
+        if (json_file && write_json(json_file, &info, results, count) != 0) {
+            status = -1;
+        }
+    }
+    
+    for (int i = 0; i < NUM_BENCH_ENGINES; i++) {
+        sssp_workspace_free(bench.workspaces[i]);
+    }
+    for (int lane = 0; lane < MULTI_SOURCE_LANES; lane++) {
+        free(bench.multi_distances[lane]);
+    }
+    free(bench.distances);
+    free(reference);
+    free(input_reference);
+    free(bench.batch_summaries);
+    free(results);
+    free(samples);
+    free(source_nodes);
+    free(sources);
+    free(thread_counts);
     free_graph(graph);
     
-    return correct ? EXIT_SUCCESS : EXIT_FAILURE;
+    return (status == 0 && correct) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
-
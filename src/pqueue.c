@@ -0,0 +1,375 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "pqueue.h"
+#include "instrument.h"
+
+#define HEAP_ARITY 4
+
+IndexedHeap* heap_create(int capacity) {
+    IndexedHeap *h = (IndexedHeap*)malloc(sizeof(IndexedHeap));
+    if (!h) {
+        perror("Error allocating heap");
+        return NULL;
+    }
+    h->heap = (int*)malloc((size_t)capacity * sizeof(int));
+    h->pos = (int*)malloc((size_t)capacity * sizeof(int));
+    h->key = (int*)malloc((size_t)capacity * sizeof(int));
+    if (!h->heap || !h->pos || !h->key) {
+        perror("Error allocating heap");
+        heap_free(h);
+        return NULL;
+    }
+    for (int i = 0; i < capacity; i++) {
+        h->pos[i] = -1;
+    }
+    h->size = 0;
+    h->capacity = capacity;
+    return h;
+}
+
+void heap_free(IndexedHeap *h) {
+    if (!h) {
+        return;
+    }
+    free(h->heap);
+    free(h->pos);
+    free(h->key);
+    free(h);
+}
+
+static void sift_up(IndexedHeap *h, int slot) {
+    int node = h->heap[slot];
+    int key = h->key[node];
+    while (slot > 0) {
+        int parent = (slot - 1) / HEAP_ARITY;
+        int parent_node = h->heap[parent];
+        if (h->key[parent_node] <= key) {
+            break;
+        }
+        h->heap[slot] = parent_node;
+        h->pos[parent_node] = slot;
+        slot = parent;
+    }
+    h->heap[slot] = node;
+    h->pos[node] = slot;
+}
+
+static void sift_down(IndexedHeap *h, int slot) {
+    int node = h->heap[slot];
+    int key = h->key[node];
+    for (;;) {
+        int first_child = slot * HEAP_ARITY + 1;
+        if (first_child >= h->size) {
+            break;
+        }
+        int last_child = first_child + HEAP_ARITY;
+        if (last_child > h->size) {
+            last_child = h->size;
+        }
+        int best = first_child;
+        int best_key = h->key[h->heap[first_child]];
+        for (int c = first_child + 1; c < last_child; c++) {
+            int child_key = h->key[h->heap[c]];
+            if (child_key < best_key) {
+                best = c;
+                best_key = child_key;
+            }
+        }
+        if (best_key >= key) {
+            break;
+        }
+        h->heap[slot] = h->heap[best];
+        h->pos[h->heap[slot]] = slot;
+        slot = best;
+    }
+    h->heap[slot] = node;
+    h->pos[node] = slot;
+}
+
+bool heap_push_or_decrease(IndexedHeap *h, int node, int key) {
+    int slot = h->pos[node];
+    if (slot == -1) {
+        slot = h->size++;
+        h->heap[slot] = node;
+        h->key[node] = key;
+        sift_up(h, slot);
+        INSTR_COUNT(INSTR_QUEUE_PUSH, 1);
+        return true;
+    }
+    if (key >= h->key[node]) {
+        return false;
+    }
+    h->key[node] = key;
+    sift_up(h, slot);
+    INSTR_COUNT(INSTR_QUEUE_DECREASE, 1);
+    return true;
+}
+
+int heap_pop(IndexedHeap *h) {
+    if (h->size == 0) {
+        return -1;
+    }
+    int top = h->heap[0];
+    INSTR_COUNT(INSTR_QUEUE_POP, 1);
+    h->pos[top] = -1;
+    h->size--;
+    if (h->size > 0) {
+        h->heap[0] = h->heap[h->size];
+        sift_down(h, 0);
+    }
+    return top;
+}
+
+void heap_clear(IndexedHeap *h) {
+    for (int i = 0; i < h->size; i++) {
+        h->pos[h->heap[i]] = -1;
+    }
+    h->size = 0;
+}
+
+DialQueue* dial_create(int capacity, int max_weight) {
+    DialQueue *q = (DialQueue*)malloc(sizeof(DialQueue));
+    if (!q) {
+        perror("Error allocating bucket queue");
+        return NULL;
+    }
+    q->num_buckets = max_weight + 1;
+    q->head = (int*)malloc((size_t)q->num_buckets * sizeof(int));
+    q->next = (int*)malloc((size_t)capacity * sizeof(int));
+    q->prev = (int*)malloc((size_t)capacity * sizeof(int));
+    q->key = (int*)malloc((size_t)capacity * sizeof(int));
+    if (!q->head || !q->next || !q->prev || !q->key) {
+        perror("Error allocating bucket queue");
+        dial_free(q);
+        return NULL;
+    }
+    for (int b = 0; b < q->num_buckets; b++) {
+        q->head[b] = -1;
+    }
+    for (int i = 0; i < capacity; i++) {
+        q->prev[i] = -2;
+    }
+    q->cursor = 0;
+    q->size = 0;
+    return q;
+}
+
+void dial_free(DialQueue *q) {
+    if (!q) {
+        return;
+    }
+    free(q->head);
+    free(q->next);
+    free(q->prev);
+    free(q->key);
+    free(q);
+}
+
+static void dial_unlink(DialQueue *q, int node) {
+    int b = q->key[node] % q->num_buckets;
+    if (q->prev[node] == -1) {
+        q->head[b] = q->next[node];
+    } else {
+        q->next[q->prev[node]] = q->next[node];
+    }
+    if (q->next[node] != -1) {
+        q->prev[q->next[node]] = q->prev[node];
+    }
+    q->prev[node] = -2;
+    q->size--;
+}
+
+bool dial_push_or_decrease(DialQueue *q, int node, int key) {
+    if (q->prev[node] != -2) {
+        if (key >= q->key[node]) {
+            return false;
+        }
+        dial_unlink(q, node);
+        INSTR_COUNT(INSTR_QUEUE_DECREASE, 1);
+    } else {
+        INSTR_COUNT(INSTR_QUEUE_PUSH, 1);
+    }
+    int b = key % q->num_buckets;
+    q->key[node] = key;
+    q->prev[node] = -1;
+    q->next[node] = q->head[b];
+    if (q->head[b] != -1) {
+        q->prev[q->head[b]] = node;
+    }
+    q->head[b] = node;
+    q->size++;
+    return true;
+}
+
+int dial_pop(DialQueue *q) {
+    if (q->size == 0) {
+        return -1;
+    }
+    // Queued keys lie in [cursor, cursor + max_weight], so at most one lap is needed
+    while (q->head[q->cursor % q->num_buckets] == -1) {
+        q->cursor++;
+    }
+    int node = q->head[q->cursor % q->num_buckets];
+    dial_unlink(q, node);
+    INSTR_COUNT(INSTR_QUEUE_POP, 1);
+    return node;
+}
+
+void dial_clear(DialQueue *q) {
+    while (q->size > 0) {
+        dial_pop(q);
+    }
+    q->cursor = 0;
+}
+
+RadixHeap* radix_create(void) {
+    RadixHeap *h = (RadixHeap*)calloc(1, sizeof(RadixHeap));
+    if (!h) {
+        perror("Error allocating radix heap");
+    }
+    return h;
+}
+
+void radix_free(RadixHeap *h) {
+    if (!h) {
+        return;
+    }
+    for (int b = 0; b < RADIX_BUCKETS; b++) {
+        free(h->buckets[b].data);
+    }
+    free(h);
+}
+
+void radix_reset(RadixHeap *h) {
+    for (int b = 0; b < RADIX_BUCKETS; b++) {
+        h->buckets[b].size = 0;
+    }
+    h->last = 0;
+    h->size = 0;
+    h->failed = false;
+}
+
+static inline int radix_bucket_index(unsigned key, unsigned last) {
+    unsigned diff = key ^ last;
+    return diff == 0 ? 0 : 32 - __builtin_clz(diff);
+}
+
+static bool radix_bucket_push(RadixBucket *bucket, RadixEntry entry) {
+    if (bucket->size == bucket->capacity) {
+        int new_capacity = bucket->capacity ? bucket->capacity * 2 : 16;
+        RadixEntry *data = (RadixEntry*)realloc(bucket->data, (size_t)new_capacity * sizeof(RadixEntry));
+        if (!data) {
+            perror("Error reallocating radix heap");
+            return false;
+        }
+        bucket->data = data;
+        bucket->capacity = new_capacity;
+    }
+    bucket->data[bucket->size++] = entry;
+    return true;
+}
+
+bool radix_push(RadixHeap *h, int node, unsigned key) {
+    RadixEntry entry = {key, node};
+    if (!radix_bucket_push(&h->buckets[radix_bucket_index(key, h->last)], entry)) {
+        return false;
+    }
+    h->size++;
+    INSTR_COUNT(INSTR_QUEUE_PUSH, 1);
+    return true;
+}
+
+bool radix_pop(RadixHeap *h, int *node, unsigned *key) {
+    if (h->size == 0) {
+        return false;
+    }
+    if (h->buckets[0].size == 0) {
+        // Find the first non-empty bucket, move last to its minimum key and
+        // redistribute its entries; they all land in strictly lower buckets
+        int b = 1;
+        while (h->buckets[b].size == 0) {
+            b++;
+        }
+        RadixBucket *bucket = &h->buckets[b];
+        unsigned min_key = bucket->data[0].key;
+        for (int i = 1; i < bucket->size; i++) {
+            if (bucket->data[i].key < min_key) {
+                min_key = bucket->data[i].key;
+            }
+        }
+        h->last = min_key;
+        int count = bucket->size;
+        bucket->size = 0;
+        for (int i = 0; i < count; i++) {
+            RadixEntry entry = bucket->data[i];
+            if (!radix_bucket_push(&h->buckets[radix_bucket_index(entry.key, h->last)], entry)) {
+                h->failed = true;
+                return false;
+            }
+        }
+    }
+    RadixBucket *bucket = &h->buckets[0];
+    RadixEntry entry = bucket->data[--bucket->size];
+    h->size--;
+    INSTR_COUNT(INSTR_QUEUE_POP, 1);
+    *node = entry.node;
+    *key = entry.key;
+    return true;
+}
+
+bool node_list_push(NodeList *list, int node) {
+    if (list->size == list->capacity) {
+        int new_capacity = list->capacity ? list->capacity * 2 : 64;
+        int *data = (int*)realloc(list->data, (size_t)new_capacity * sizeof(int));
+        if (!data) {
+            perror("Error reallocating bucket");
+            return false;
+        }
+        list->data = data;
+        list->capacity = new_capacity;
+    }
+    list->data[list->size++] = node;
+    return true;
+}
+
+bool bucket_push(BucketSet *set, int bin, int node) {
+    if (bin >= set->num_bins) {
+        int new_num_bins = set->num_bins ? set->num_bins : 16;
+        while (new_num_bins <= bin) {
+            new_num_bins *= 2;
+        }
+        NodeList *bins = (NodeList*)realloc(set->bins, (size_t)new_num_bins * sizeof(NodeList));
+        if (!bins) {
+            perror("Error reallocating buckets");
+            return false;
+        }
+        memset(bins + set->num_bins, 0, (size_t)(new_num_bins - set->num_bins) * sizeof(NodeList));
+        set->bins = bins;
+        set->num_bins = new_num_bins;
+    }
+    if (!node_list_push(&set->bins[bin], node)) {
+        return false;
+    }
+    INSTR_COUNT(INSTR_QUEUE_PUSH, 1);
+    return true;
+}
+
+int bucket_next_nonempty(const BucketSet *set, int after) {
+    for (int b = after + 1; b < set->num_bins; b++) {
+        if (set->bins[b].size > 0) {
+            return b;
+        }
+    }
+    return INT_MAX;
+}
+
+void bucket_set_free(BucketSet *set) {
+    for (int b = 0; b < set->num_bins; b++) {
+        free(set->bins[b].data);
+    }
+    free(set->bins);
+    set->bins = NULL;
+    set->num_bins = 0;
+}
@@ -0,0 +1,123 @@
+#ifndef PQUEUE_H
+#define PQUEUE_H
+
+#include <stdbool.h>
+
+// Indexed 4-ary min-heap over node ids 0 .. capacity-1 with decrease-key.
+// pos[node] is the node's slot in heap[], or -1 when it is not queued.
+typedef struct {
+    int *heap;
+    int *pos;
+    int *key;
+    int size;
+    int capacity;
+} IndexedHeap;
+
+IndexedHeap* heap_create(int capacity);
+void heap_free(IndexedHeap *h);
+
+// Insert node with the given key, or lower its key if already queued.
+// Returns true if the heap changed.
+bool heap_push_or_decrease(IndexedHeap *h, int node, int key);
+
+// Remove and return the node with the smallest key (-1 if empty).
+int heap_pop(IndexedHeap *h);
+// Remove every queued node
+void heap_clear(IndexedHeap *h);
+
+static inline bool heap_empty(const IndexedHeap *h) {
+    return h->size == 0;
+}
+
+// Smallest key in a non-empty heap
+static inline int heap_top_key(const IndexedHeap *h) {
+    return h->key[h->heap[0]];
+}
+
+// Dial's bucket queue: a circular array of max_weight + 1 buckets holding
+// doubly-linked node lists. Valid when every key pushed is within
+// max_weight of the last popped key, i.e. for Dijkstra on integer weights.
+typedef struct {
+    int *head;      // first node of each bucket, -1 if empty
+    int *next;
+    int *prev;      // -2 when the node is not queued
+    int *key;
+    int num_buckets;
+    int cursor;     // key of the bucket currently being drained
+    int size;
+} DialQueue;
+
+DialQueue* dial_create(int capacity, int max_weight);
+void dial_free(DialQueue *q);
+bool dial_push_or_decrease(DialQueue *q, int node, int key);
+int dial_pop(DialQueue *q);
+// Remove every queued node and rewind to key 0 for a new run
+void dial_clear(DialQueue *q);
+
+static inline bool dial_empty(const DialQueue *q) {
+    return q->size == 0;
+}
+
+// Radix heap for monotone integer keys. Entries live in 33 buckets keyed by
+// the highest bit in which they differ from the last popped key, so each
+// entry is moved at most 32 times. Decrease-key is handled lazily: callers
+// push a new entry and skip stale ones on pop.
+#define RADIX_BUCKETS 33
+
+typedef struct {
+    unsigned key;
+    int node;
+} RadixEntry;
+
+typedef struct {
+    RadixEntry *data;
+    int size;
+    int capacity;
+} RadixBucket;
+
+typedef struct {
+    RadixBucket buckets[RADIX_BUCKETS];
+    unsigned last;
+    int size;
+    bool failed;        // a redistribution could not grow a bucket; entries were lost
+} RadixHeap;
+
+RadixHeap* radix_create(void);
+void radix_free(RadixHeap *h);
+// Returns false, with an error message and the heap unchanged, if the
+// key's bucket cannot grow
+bool radix_push(RadixHeap *h, int node, unsigned key);
+// Remove the entry with the smallest key; returns false if empty or, with
+// failed set, if moving entries to lower buckets ran out of memory
+bool radix_pop(RadixHeap *h, int *node, unsigned *key);
+// Drop any remaining entries and rewind to key 0, keeping the bucket storage
+void radix_reset(RadixHeap *h);
+
+static inline bool radix_empty(const RadixHeap *h) {
+    return h->size == 0;
+}
+
+// Growable list of node ids
+typedef struct {
+    int *data;
+    int size;
+    int capacity;
+} NodeList;
+
+// Pushes return false, with an error message and the list unchanged, if it
+// cannot grow
+bool node_list_push(NodeList *list, int node);
+
+// Bucket array indexed by bucket number (distance / delta) for delta-stepping.
+// Buckets are unordered node lists; stale entries are skipped by the caller.
+typedef struct {
+    NodeList *bins;
+    int num_bins;
+} BucketSet;
+
+bool bucket_push(BucketSet *set, int bin, int node);
+// Lowest non-empty bucket after the given one, or INT_MAX if none
+int bucket_next_nonempty(const BucketSet *set, int after);
+void bucket_set_free(BucketSet *set);
+
+#endif
@@ -0,0 +1,200 @@
+#ifndef SSSP_H
+#define SSSP_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "graph.h"
+#include "output.h"
+
+// Largest edge weight for which ENGINE_AUTO picks Dial's buckets over the radix heap
+#define DIAL_MAX_WEIGHT 1024
+
+// Sequential single-source shortest path engines
+typedef enum {
+    ENGINE_AUTO,    // Dial for max_weight <= DIAL_MAX_WEIGHT, radix heap otherwise
+    ENGINE_SCAN,    // O(V^2) linear min-scan, the reference implementation
+    ENGINE_HEAP,    // O((V+E) log V) indexed 4-ary heap with decrease-key
+    ENGINE_DIAL,    // O(E + V * max_weight) circular bucket queue
+    ENGINE_RADIX    // O(E + V log max_weight) radix heap
+} SequentialEngine;
+
+// One-shot full searches: each returns 0, or -1 (distances left unset) if
+// its queue could not be allocated or grown
+
+// Sequential Dijkstra's algorithm with a linear scan for the next node
+int dijkstra_sequential(const Graph *graph, int source, int *distances);
+
+// Sequential Dijkstra's algorithm with an indexed heap
+int dijkstra_heap(const Graph *graph, int source, int *distances);
+
+// Sequential Dijkstra's algorithm with Dial's circular buckets (non-negative integer weights)
+int dijkstra_dial(const Graph *graph, int source, int *distances);
+
+// Sequential Dijkstra's algorithm with a radix heap (non-negative integer weights)
+int dijkstra_radix(const Graph *graph, int source, int *distances);
+
+// Map "auto" / "scan" / "heap" / "dial" / "radix" to an engine; returns false for unknown names
+bool parse_sequential_engine(const char *name, SequentialEngine *engine);
+// Replace ENGINE_AUTO with the concrete engine chosen for this graph
+SequentialEngine resolve_sequential_engine(SequentialEngine engine, const Graph *graph);
+const char* sequential_engine_name(SequentialEngine engine);
+// Whether engine can run on graph: Dial's buckets are only allocated for
+// max_weight <= DIAL_MAX_WEIGHT. check_sequential_engine also reports why not.
+bool sequential_engine_supported(SequentialEngine engine, const Graph *graph);
+bool check_sequential_engine(SequentialEngine engine, const Graph *graph);
+int run_sequential_engine(SequentialEngine engine, const Graph *graph, int source, int *distances);
+
+// Reusable buffers (visited flags and queue) for running many sequential
+// queries on one graph without reallocating; one per worker thread
+typedef struct SsspWorkspace SsspWorkspace;
+
+SsspWorkspace* sssp_workspace_create(const Graph *graph, SequentialEngine engine);
+// Searches return 0, or -1 (distances incomplete) if the radix heap could
+// not grow
+int sssp_workspace_run(SsspWorkspace *ws, int source, int *distances);
+// Search that stops once target is settled (target < 0 for no target) or
+// the next node would be farther than limit (INF for no limit). Settled
+// nodes get exact distances; the rest keep an upper bound or INF.
+int sssp_workspace_search(SsspWorkspace *ws, int source, int target, int limit, int *distances);
+// Nodes settled by the last search, in the order they were settled
+const int* sssp_workspace_settled(const SsspWorkspace *ws, int *count);
+void sssp_workspace_free(SsspWorkspace *ws);
+
+// Point-to-point queries (sssp_p2p.c). Both return the source-target
+// distance (INF if unreachable, -1 if their state could not be allocated or grown)
+// and, if num_settled is non-NULL, the number of nodes settled on the way.
+// Single search with the given engine, stopping once target is settled
+int dijkstra_point_to_point(SequentialEngine engine, const Graph *graph, int source, int target, int *num_settled);
+// Bidirectional Dijkstra: forward and backward heap searches that stop once
+// the two frontier keys sum to at least the best meeting path
+int dijkstra_bidirectional(const Graph *graph, int source, int target, int *num_settled);
+
+// Reusable state for repeated bidirectional queries; each query resets
+// only the nodes it touched
+typedef struct BidirectionalWorkspace BidirectionalWorkspace;
+
+BidirectionalWorkspace* bidirectional_workspace_create(const Graph *graph);
+int bidirectional_query(BidirectionalWorkspace *ws, int source, int target, int *num_settled);
+void bidirectional_workspace_free(BidirectionalWorkspace *ws);
+
+// ALT (sssp_alt.c): A* with landmark lower bounds. Landmarks are chosen
+// farthest-first (each maximizes its distance to the ones before it) or
+// with the avoid heuristic, in rounds of num_threads (<= 0: all threads)
+// whose full searches run in parallel with the given sequential engine.
+typedef enum {
+    LANDMARKS_FARTHEST,
+    LANDMARKS_AVOID
+} LandmarkSelection;
+
+bool parse_landmark_selection(const char *name, LandmarkSelection *selection);
+const char* landmark_selection_name(LandmarkSelection selection);
+// Returns NULL on allocation failure; may hold fewer than num_landmarks
+// landmarks if the graph has fewer distinct candidates
+LandmarkTable* compute_landmarks(const Graph *graph, int num_landmarks, LandmarkSelection selection,
+                                 SequentialEngine engine, int num_threads);
+
+// A* point-to-point queries on a graph and its landmark tables
+typedef struct AltWorkspace AltWorkspace;
+
+AltWorkspace* alt_workspace_create(const Graph *graph, const LandmarkTable *table);
+int alt_query(AltWorkspace *ws, int source, int target, int *num_settled);
+void alt_workspace_free(AltWorkspace *ws);
+
+// Contraction hierarchies (sssp_ch.c). contract_graph orders the nodes by
+// edge difference and contracts independent sets of them in parallel on
+// num_threads threads (<= 0: all threads). Contraction stops early, leaving
+// the rest as the hierarchy's core, once the remaining graph averages more
+// than core_degree edges per node (<= 0: contract every node); graphs
+// without a hierarchy, such as random ones, otherwise grow dense cores of
+// shortcuts. Returns NULL on allocation failure.
+typedef struct {
+    int num_rounds;             // independent sets contracted
+    int core_nodes;             // nodes left uncontracted
+    long long num_shortcuts;
+    long long witness_settled;  // nodes settled by all witness searches
+} ContractionStats;
+
+#define CH_DEFAULT_CORE_DEGREE 16
+
+ContractionHierarchy* contract_graph(const Graph *graph, int core_degree, int num_threads, ContractionStats *stats);
+
+// Point-to-point queries on a hierarchy: a bidirectional search that only
+// climbs to the core, then a bidirectional search inside the core. Same
+// contract as bidirectional_query.
+typedef struct ChWorkspace ChWorkspace;
+
+ChWorkspace* ch_workspace_create(const ContractionHierarchy *ch);
+int ch_query(ChWorkspace *ws, int source, int target, int *num_settled);
+void ch_workspace_free(ChWorkspace *ws);
+
+// Lockstep multi-source engine (sssp_multi.c): computes up to
+// MULTI_SOURCE_LANES sources in one pass over the adjacency, each edge
+// relaxing all lanes with one vector min. distances[k] receives the
+// num_nodes distances from sources[k]; sources beyond the lane count are
+// ignored. Nodes are scanned in buckets of width delta (<= 0 selects
+// default_delta(graph)). Returns 0, or -1 on allocation failure.
+#define MULTI_SOURCE_LANES 16
+
+int dijkstra_multi_source(const Graph *graph, const int *sources, int count, int **distances, int delta);
+
+// Batch queries (sssp_batch.c): many sources against one loaded graph.
+// Read whitespace-separated source ids from filename ('#' starts a comment).
+// Returns a malloc'd array and its length in *count, or NULL on error.
+int* read_source_list(const char *filename, int *count);
+// Expand an inclusive "first:last" range; NULL if the range is malformed
+int* parse_source_range(const char *range, int *count);
+// Report the first source outside [0, num_nodes) and return false
+bool check_sources(const int *sources, int count, int num_nodes);
+
+// Answer one sequential query per source on num_threads workers, each with
+// its own workspace and distance array reused across its queries. Results
+// are written to out as each query finishes (so in completion order): one
+// "Shortest distances from node <s>:" block per source for OUTPUT_TEXT, one
+// summary line for OUTPUT_SUMMARY, nothing for OUTPUT_QUIET (binary dumps
+// hold a single source and are not supported). Sources and results use
+// input ids on reordered graphs. If summaries is non-NULL, summaries[q]
+// receives the summary of source q's distances. Returns the elapsed wall
+// time in seconds, or a negative value on allocation failure.
+double run_sssp_batch(const Graph *graph, SequentialEngine engine, const int *sources, int count,
+                      int num_threads, FILE *out, OutputFormat format, DistanceSummary *summaries);
+
+// Shared-memory parallel engines (OpenMP)
+typedef enum {
+    PARALLEL_ENGINE_DIJKSTRA,   // one node settled per iteration, parallel min-scan
+    PARALLEL_ENGINE_PERSISTENT, // same, in one parallel region with atomic-min relaxation
+    PARALLEL_ENGINE_DELTA       // delta-stepping, a whole bucket settled per phase
+} ParallelEngine;
+
+// As for the sequential engines, each returns 0, or -1 (distances left
+// unset) if its solver state could not be allocated
+
+// Parallel Dijkstra's algorithm using a reduction for the min-scan
+int dijkstra_parallel(const Graph *graph, int source, int *distances, int num_threads);
+
+// Parallel Dijkstra's algorithm with per-thread min candidates
+int dijkstra_parallel_optimized(const Graph *graph, int source, int *distances, int num_threads);
+
+// Parallel Dijkstra's algorithm in a single persistent parallel region
+int dijkstra_parallel_persistent(const Graph *graph, int source, int *distances, int num_threads);
+
+// Delta-stepping SSSP; delta <= 0 selects default_delta(graph)
+int dijkstra_delta_stepping(const Graph *graph, int source, int *distances, int num_threads, int delta);
+int default_delta(const Graph *graph);
+
+// Map "dijkstra" / "persistent" / "delta" to an engine; returns false for unknown names
+bool parse_parallel_engine(const char *name, ParallelEngine *engine);
+const char* parallel_engine_name(ParallelEngine engine);
+int run_parallel_engine(ParallelEngine engine, const Graph *graph, int source, int *distances, int num_threads, int delta);
+
+// Lock-free atomic min on an int; returns true if value replaced the old one
+static inline bool atomic_min_int(int *addr, int value) {
+    int old = __atomic_load_n(addr, __ATOMIC_RELAXED);
+    while (value < old) {
+        if (__atomic_compare_exchange_n(addr, &old, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif
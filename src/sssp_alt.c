@@ -0,0 +1,498 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "sssp.h"
+#include "pqueue.h"
+
+// ALT: A* search with landmarks and the triangle inequality. For a landmark
+// l and nodes v, t of an undirected graph, |d(l, t) - d(l, v)| <= d(v, t),
+// so the maximum over all landmarks is a consistent lower bound on the
+// remaining distance. Preprocessing picks the landmarks and stores one full
+// distance array per landmark (computed with the sequential engines).
+
+// Lower bound on d(a, b) from the landmark rows of a and b; INF when some
+// landmark reaches exactly one of them (different components)
+static inline int landmark_bound(const int *row_a, const int *row_b, int num_landmarks) {
+    int bound = 0;
+    for (int l = 0; l < num_landmarks; l++) {
+        int a = row_a[l];
+        int b = row_b[l];
+        if (a == INF || b == INF) {
+            if (a != b) {
+                return INF;
+            }
+            continue;
+        }
+        int diff = (a > b) ? a - b : b - a;
+        if (diff > bound) {
+            bound = diff;
+        }
+    }
+    return bound;
+}
+
+bool parse_landmark_selection(const char *name, LandmarkSelection *selection) {
+    if (strcmp(name, "farthest") == 0) {
+        *selection = LANDMARKS_FARTHEST;
+    } else if (strcmp(name, "avoid") == 0) {
+        *selection = LANDMARKS_AVOID;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* landmark_selection_name(LandmarkSelection selection) {
+    return (selection == LANDMARKS_AVOID) ? "avoid" : "farthest";
+}
+
+// Per-thread buffers for preprocessing
+typedef struct {
+    SsspWorkspace *ws;
+    int *dist;
+    int *parent;        // shortest-path tree of the avoid root
+    int *order_pos;     // position of each node in settle order
+    long long *size;    // avoid subtree weights, -1 if the subtree holds a landmark
+    int *child_start;
+    int *children;
+    bool failed;        // a search ran out of memory
+} PrepThread;
+
+typedef struct {
+    const Graph *graph;
+    LandmarkTable *table;
+    int chosen;         // landmarks with a finished column
+    int *min_dist;      // distance to the nearest chosen landmark (INF if none reaches)
+    bool *is_landmark;
+} PrepState;
+
+static void free_prep_thread(PrepThread *t) {
+    sssp_workspace_free(t->ws);
+    free(t->dist);
+    free(t->parent);
+    free(t->order_pos);
+    free(t->size);
+    free(t->child_start);
+    free(t->children);
+}
+
+static bool prep_failed(const PrepThread *threads, int num_threads) {
+    for (int i = 0; i < num_threads; i++) {
+        if (threads[i].failed) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool alloc_prep_thread(PrepThread *t, const Graph *graph, SequentialEngine engine, bool avoid) {
+    size_t n = (size_t)graph->num_nodes;
+    memset(t, 0, sizeof(*t));
+    t->ws = sssp_workspace_create(graph, engine);
+    t->dist = (int*)malloc(n * sizeof(int));
+    bool ok = t->ws && t->dist;
+    if (avoid) {
+        t->parent = (int*)malloc(n * sizeof(int));
+        t->order_pos = (int*)malloc(n * sizeof(int));
+        t->size = (long long*)malloc(n * sizeof(long long));
+        t->child_start = (int*)malloc((n + 1) * sizeof(int));
+        t->children = (int*)malloc(n * sizeof(int));
+        ok = ok && t->parent && t->order_pos && t->size && t->child_start && t->children;
+    }
+    return ok;
+}
+
+// Node with the largest finite distance in dist (lowest id on ties), -1 if none but source
+static int farthest_node(const int *dist, int n, const bool *is_landmark) {
+    int best = -1;
+    for (int v = 0; v < n; v++) {
+        if (dist[v] != INF && !is_landmark[v] && (best < 0 || dist[v] > dist[best])) {
+            best = v;
+        }
+    }
+    return best;
+}
+
+// Farthest-first: pick count landmarks at once. Each pick maximizes the
+// distance to the chosen landmarks, with distances to the earlier picks of
+// this round (whose columns do not exist yet) estimated by landmark bounds
+static int pick_farthest(PrepState *state, PrepThread *t, int count, int *picks) {
+    const Graph *graph = state->graph;
+    const LandmarkTable *table = state->table;
+    int n = graph->num_nodes;
+
+    if (state->chosen == 0) {
+        // Seed: farthest node from node 0
+        if (sssp_workspace_run(t->ws, 0, t->dist) != 0) {
+            t->failed = true;
+            return 0;
+        }
+        int seed = farthest_node(t->dist, n, state->is_landmark);
+        picks[0] = (seed >= 0) ? seed : 0;
+        return 1;
+    }
+
+    // score[v] = estimated distance to the nearest landmark or pick; unreachable
+    // (INF) nodes come first so every component gets a landmark
+    int *score = t->dist;
+    memcpy(score, state->min_dist, (size_t)n * sizeof(int));
+    int num_picks = 0;
+    while (num_picks < count) {
+        int best = -1;
+        for (int v = 0; v < n; v++) {
+            if (!state->is_landmark[v] && score[v] > 0 && (best < 0 || score[v] > score[best])) {
+                best = v;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        picks[num_picks++] = best;
+        const int *best_row = table->dist + (size_t)best * table->num_landmarks;
+        score[best] = 0;
+        for (int v = 0; v < n; v++) {
+            int bound = landmark_bound(table->dist + (size_t)v * table->num_landmarks, best_row, state->chosen);
+            if (bound < score[v]) {
+                score[v] = bound;
+            }
+        }
+    }
+    return num_picks;
+}
+
+// Avoid (Goldberg & Werneck): grow a shortest-path tree from root, weight
+// each node by how poorly the current landmarks bound its distance to the
+// root, and descend from the root along the heaviest subtrees that contain
+// no landmark; the leaf reached becomes the landmark. Returns -1 if every
+// subtree already holds a landmark or the search failed.
+static int pick_avoid(const PrepState *state, PrepThread *t, int root) {
+    const Graph *graph = state->graph;
+    const LandmarkTable *table = state->table;
+    int n = graph->num_nodes;
+    int L = table->num_landmarks;
+
+    if (sssp_workspace_run(t->ws, root, t->dist) != 0) {
+        t->failed = true;
+        return -1;
+    }
+    int count;
+    const int *order = sssp_workspace_settled(t->ws, &count);
+    for (int i = 0; i < count; i++) {
+        t->order_pos[order[i]] = i;
+    }
+
+    // Parent: a neighbor settled earlier on a shortest path
+    const int *root_row = table->dist + (size_t)root * L;
+    for (int i = 0; i < count; i++) {
+        int v = order[i];
+        t->parent[v] = -1;
+        if (v != root) {
+            for (int e = graph->offsets[v]; e < graph->offsets[v + 1]; e++) {
+                int u = graph->dest[e];
+                if (t->dist[u] != INF && t->order_pos[u] < i && t->dist[u] + graph->weight[e] == t->dist[v]) {
+                    t->parent[v] = u;
+                    break;
+                }
+            }
+        }
+        int bound = landmark_bound(table->dist + (size_t)v * L, root_row, state->chosen);
+        t->size[v] = state->is_landmark[v] ? -1 : (long long)t->dist[v] - (bound == INF ? 0 : bound);
+    }
+
+    // Subtree sums in reverse settle order; a landmark anywhere below zeroes the subtree
+    for (int i = count - 1; i > 0; i--) {
+        int v = order[i];
+        int p = t->parent[v];
+        if (t->size[v] < 0) {
+            t->size[p] = -1;
+        } else if (t->size[p] >= 0) {
+            t->size[p] += t->size[v];
+        }
+    }
+
+    // Children lists by counting sort on the parent
+    memset(t->child_start, 0, (size_t)(n + 1) * sizeof(int));
+    for (int i = 1; i < count; i++) {
+        t->child_start[t->parent[order[i]] + 1]++;
+    }
+    for (int v = 0; v < n; v++) {
+        t->child_start[v + 1] += t->child_start[v];
+    }
+    for (int i = 1; i < count; i++) {
+        int p = t->parent[order[i]];
+        t->children[t->child_start[p]++] = order[i];
+    }
+    for (int v = n; v > 0; v--) {
+        t->child_start[v] = t->child_start[v - 1];
+    }
+    t->child_start[0] = 0;
+
+    if (t->size[root] <= 0) {
+        return -1;
+    }
+    int node = root;
+    for (;;) {
+        int best = -1;
+        for (int c = t->child_start[node]; c < t->child_start[node + 1]; c++) {
+            int child = t->children[c];
+            if (t->size[child] > 0 && (best < 0 || t->size[child] > t->size[best])) {
+                best = child;
+            }
+        }
+        if (best < 0) {
+            return node;
+        }
+        node = best;
+    }
+}
+
+// Fill the table column of landmark l from its distance array
+static void store_column(PrepState *state, int l, const int *dist) {
+    LandmarkTable *table = state->table;
+    for (int v = 0; v < table->num_nodes; v++) {
+        table->dist[(size_t)v * table->num_landmarks + l] = dist[v];
+    }
+}
+
+LandmarkTable* compute_landmarks(const Graph *graph, int num_landmarks, LandmarkSelection selection,
+                                 SequentialEngine engine, int num_threads) {
+    if (!check_sequential_engine(engine, graph)) {
+        return NULL;
+    }
+    int n = graph->num_nodes;
+    if (num_landmarks > n) {
+        num_landmarks = n;
+    }
+    if (num_threads <= 0) {
+        num_threads = omp_get_max_threads();
+    }
+    bool avoid = (selection == LANDMARKS_AVOID);
+
+    LandmarkTable *table = (LandmarkTable*)calloc(1, sizeof(LandmarkTable));
+    PrepThread *threads = (PrepThread*)calloc(num_threads, sizeof(PrepThread));
+    PrepState state = {graph, table, 0, NULL, NULL};
+    state.min_dist = (int*)malloc((size_t)n * sizeof(int));
+    state.is_landmark = (bool*)calloc(n, sizeof(bool));
+    int *picks = (int*)malloc((size_t)num_threads * sizeof(int));
+    bool ok = table && threads && state.min_dist && state.is_landmark && picks;
+    if (ok) {
+        table->num_landmarks = num_landmarks;
+        table->num_nodes = n;
+        table->landmarks = (int*)malloc((size_t)num_landmarks * sizeof(int));
+        table->dist = (int*)malloc((size_t)n * num_landmarks * sizeof(int));
+        ok = table->landmarks && table->dist;
+    }
+    for (int i = 0; ok && i < num_threads; i++) {
+        ok = alloc_prep_thread(&threads[i], graph, engine, avoid);
+    }
+    if (!ok) {
+        perror("Error allocating landmark tables");
+    }
+
+    for (int v = 0; ok && v < n; v++) {
+        state.min_dist[v] = INF;
+    }
+
+    // Rounds of up to num_threads landmarks: pick them, then run their
+    // searches in parallel, one landmark per thread
+    while (ok && state.chosen < num_landmarks) {
+        int round = num_landmarks - state.chosen;
+        if (round > num_threads) {
+            round = num_threads;
+        }
+        int num_picks;
+        if (avoid) {
+            #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 1)
+            for (int i = 0; i < round; i++) {
+                // Pseudo-random root, different for every landmark slot
+                unsigned seed = (unsigned)(state.chosen + i + 1) * 2654435761u;
+                picks[i] = pick_avoid(&state, &threads[omp_get_thread_num()], (int)(seed % (unsigned)n));
+            }
+            // Drop duplicates and failed picks; fall back to farthest-first if none remain
+            num_picks = 0;
+            for (int i = 0; i < round; i++) {
+                bool duplicate = picks[i] < 0;
+                for (int j = 0; j < num_picks && !duplicate; j++) {
+                    duplicate = picks[j] == picks[i];
+                }
+                if (!duplicate) {
+                    picks[num_picks++] = picks[i];
+                }
+            }
+            if (num_picks == 0) {
+                num_picks = pick_farthest(&state, &threads[0], 1, picks);
+            }
+        } else {
+            num_picks = pick_farthest(&state, &threads[0], round, picks);
+        }
+        if (num_picks == 0) {
+            ok = !prep_failed(threads, num_threads);
+            break;      // every node is already a landmark
+        }
+
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 1)
+        for (int i = 0; i < num_picks; i++) {
+            PrepThread *t = &threads[omp_get_thread_num()];
+            if (sssp_workspace_run(t->ws, picks[i], t->dist) != 0) {
+                t->failed = true;
+            } else {
+                store_column(&state, state.chosen + i, t->dist);
+            }
+        }
+        if (prep_failed(threads, num_threads)) {
+            ok = false;
+            break;
+        }
+
+        for (int i = 0; i < num_picks; i++) {
+            int l = state.chosen + i;
+            table->landmarks[l] = picks[i];
+            state.is_landmark[picks[i]] = true;
+        }
+        int first = state.chosen;
+        state.chosen += num_picks;
+        #pragma omp parallel for num_threads(num_threads) schedule(static)
+        for (int v = 0; v < n; v++) {
+            const int *row = table->dist + (size_t)v * num_landmarks;
+            for (int l = first; l < state.chosen; l++) {
+                if (row[l] < state.min_dist[v]) {
+                    state.min_dist[v] = row[l];
+                }
+            }
+        }
+    }
+
+    if (ok && state.chosen < num_landmarks) {
+        // Fewer distinct landmarks than requested: compact the rows
+        for (int v = 0; v < n; v++) {
+            memmove(table->dist + (size_t)v * state.chosen, table->dist + (size_t)v * num_landmarks,
+                    (size_t)state.chosen * sizeof(int));
+        }
+        table->num_landmarks = state.chosen;
+    }
+
+    for (int i = 0; threads && i < num_threads; i++) {
+        free_prep_thread(&threads[i]);
+    }
+    free(threads);
+    free(picks);
+    free(state.min_dist);
+    free(state.is_landmark);
+    if (!ok) {
+        free_landmarks(table);
+        return NULL;
+    }
+    return table;
+}
+
+// A* query state; like the bidirectional workspace, only touched nodes are reset
+struct AltWorkspace {
+    const Graph *graph;
+    const LandmarkTable *table;
+    int *dist;
+    int *bound;         // cached lower bound to the current target, -1 if not computed
+    bool *settled;
+    int *touched;
+    int num_touched;
+    IndexedHeap *heap;
+};
+
+AltWorkspace* alt_workspace_create(const Graph *graph, const LandmarkTable *table) {
+    int n = graph->num_nodes;
+    AltWorkspace *ws = (AltWorkspace*)calloc(1, sizeof(AltWorkspace));
+    if (!ws) {
+        perror("Error allocating A* search");
+        return NULL;
+    }
+    ws->graph = graph;
+    ws->table = table;
+    ws->dist = (int*)malloc((size_t)n * sizeof(int));
+    ws->bound = (int*)malloc((size_t)n * sizeof(int));
+    ws->settled = (bool*)calloc(n, sizeof(bool));
+    ws->touched = (int*)malloc((size_t)n * sizeof(int));
+    ws->heap = heap_create(n);
+    if (!ws->dist || !ws->bound || !ws->settled || !ws->touched || !ws->heap) {
+        perror("Error allocating A* search");
+        alt_workspace_free(ws);
+        return NULL;
+    }
+    for (int v = 0; v < n; v++) {
+        ws->dist[v] = INF;
+        ws->bound[v] = -1;
+    }
+    return ws;
+}
+
+void alt_workspace_free(AltWorkspace *ws) {
+    if (!ws) {
+        return;
+    }
+    free(ws->dist);
+    free(ws->bound);
+    free(ws->settled);
+    free(ws->touched);
+    heap_free(ws->heap);
+    free(ws);
+}
+
+int alt_query(AltWorkspace *ws, int source, int target, int *num_settled) {
+    const Graph *graph = ws->graph;
+    const LandmarkTable *table = ws->table;
+    int L = table->num_landmarks;
+    const int *target_row = table->dist + (size_t)target * L;
+    int settled_count = 0;
+    int result = INF;
+
+    ws->dist[source] = 0;
+    ws->bound[source] = landmark_bound(table->dist + (size_t)source * L, target_row, L);
+    ws->touched[ws->num_touched++] = source;
+    if (ws->bound[source] != INF) {
+        heap_push_or_decrease(ws->heap, source, ws->bound[source]);
+    }
+
+    // Keys are dist + bound; the bound is consistent, so a popped node is final
+    while (!heap_empty(ws->heap)) {
+        int node = heap_pop(ws->heap);
+        ws->settled[node] = true;
+        settled_count++;
+        if (node == target) {
+            result = ws->dist[node];
+            break;
+        }
+        int base_dist = ws->dist[node];
+        for (int i = graph->offsets[node]; i < graph->offsets[node + 1]; i++) {
+            int neighbor = graph->dest[i];
+            if (ws->settled[neighbor]) {
+                continue;
+            }
+            int new_dist = base_dist + graph->weight[i];
+            if (new_dist >= ws->dist[neighbor]) {
+                continue;
+            }
+            if (ws->bound[neighbor] < 0) {
+                ws->bound[neighbor] = landmark_bound(table->dist + (size_t)neighbor * L, target_row, L);
+                ws->touched[ws->num_touched++] = neighbor;
+            }
+            if (ws->bound[neighbor] == INF) {
+                continue;       // cannot reach the target
+            }
+            ws->dist[neighbor] = new_dist;
+            heap_push_or_decrease(ws->heap, neighbor, new_dist + ws->bound[neighbor]);
+        }
+    }
+
+    for (int i = 0; i < ws->num_touched; i++) {
+        int node = ws->touched[i];
+        ws->dist[node] = INF;
+        ws->bound[node] = -1;
+        ws->settled[node] = false;
+    }
+    ws->num_touched = 0;
+    heap_clear(ws->heap);
+
+    if (num_settled) {
+        *num_settled = settled_count;
+    }
+    return result;
+}
@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <omp.h>
+#include "sssp.h"
+
+static bool append_source(int **sources, int *count, int *capacity, long value) {
+    if (*count == *capacity) {
+        int new_capacity = *capacity ? *capacity * 2 : 1024;
+        int *grown = (int*)realloc(*sources, (size_t)new_capacity * sizeof(int));
+        if (!grown) {
+            perror("Error allocating source list");
+            return false;
+        }
+        *sources = grown;
+        *capacity = new_capacity;
+    }
+    (*sources)[(*count)++] = (int)value;
+    return true;
+}
+
+int* read_source_list(const char *filename, int *count) {
+    FILE *file = fopen(filename, "r");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot open source list '%s'\n", filename);
+        return NULL;
+    }
+
+    int *sources = NULL;
+    int capacity = 0;
+    *count = 0;
+    char line[4096];
+    int line_number = 0;
+    while (fgets(line, sizeof(line), file)) {
+        line_number++;
+        char *comment = strchr(line, '#');
+        if (comment) {
+            *comment = '\0';
+        }
+        char *p = line;
+        while (*p) {
+            while (isspace((unsigned char)*p)) {
+                p++;
+            }
+            if (!*p) {
+                break;
+            }
+            char *end;
+            errno = 0;
+            long value = strtol(p, &end, 10);
+            if (end == p || errno != 0 || value < 0 || value > INT_MAX ||
+                (*end && !isspace((unsigned char)*end))) {
+                fprintf(stderr, "Error: Invalid source id on line %d of '%s'\n", line_number, filename);
+                free(sources);
+                fclose(file);
+                return NULL;
+            }
+            if (!append_source(&sources, count, &capacity, value)) {
+                free(sources);
+                fclose(file);
+                return NULL;
+            }
+            p = end;
+        }
+    }
+    fclose(file);
+
+    if (*count == 0) {
+        fprintf(stderr, "Error: Source list '%s' is empty\n", filename);
+        free(sources);
+        return NULL;
+    }
+    return sources;
+}
+
+int* parse_source_range(const char *range, int *count) {
+    char *end;
+    long first = strtol(range, &end, 10);
+    if (end == range || *end != ':') {
+        fprintf(stderr, "Error: Source range must be <first>:<last>, got '%s'\n", range);
+        return NULL;
+    }
+    const char *rest = end + 1;
+    long last = strtol(rest, &end, 10);
+    if (end == rest || *end != '\0' || first < 0 || last < first || last > INT_MAX) {
+        fprintf(stderr, "Error: Source range must be <first>:<last>, got '%s'\n", range);
+        return NULL;
+    }
+
+    *count = (int)(last - first + 1);
+    int *sources = (int*)malloc((size_t)*count * sizeof(int));
+    if (!sources) {
+        perror("Error allocating source list");
+        return NULL;
+    }
+    for (int i = 0; i < *count; i++) {
+        sources[i] = (int)(first + i);
+    }
+    return sources;
+}
+
+bool check_sources(const int *sources, int count, int num_nodes) {
+    for (int i = 0; i < count; i++) {
+        if (sources[i] < 0 || sources[i] >= num_nodes) {
+            fprintf(stderr, "Error: Source node %d must be between 0 and %d\n", sources[i], num_nodes - 1);
+            return false;
+        }
+    }
+    return true;
+}
+
+double run_sssp_batch(const Graph *graph, SequentialEngine engine, const int *sources, int count,
+                      int num_threads, FILE *out, OutputFormat format, DistanceSummary *summaries) {
+    if (!check_sequential_engine(engine, graph)) {
+        return -1;
+    }
+    bool failed = false;
+    double start = omp_get_wtime();
+
+    #pragma omp parallel num_threads(num_threads)
+    {
+        SsspWorkspace *ws = sssp_workspace_create(graph, engine);
+        int *distances = (int*)malloc((size_t)graph->num_nodes * sizeof(int));
+        char *buffer = NULL;
+        if (format == OUTPUT_TEXT) {
+            buffer = (char*)malloc((size_t)graph->num_nodes * OUTPUT_LINE_MAX + 64);
+        }
+        // Reordered graphs: results are reported by input id
+        int *input_order = NULL;
+        bool reported = format != OUTPUT_QUIET || summaries;
+        if (graph->original_id && reported) {
+            input_order = (int*)malloc((size_t)graph->num_nodes * sizeof(int));
+        }
+        bool ok = ws && distances && (buffer || format != OUTPUT_TEXT) &&
+                  (input_order || !graph->original_id || !reported);
+        if (!ok) {
+            #pragma omp atomic write
+            failed = true;
+        }
+
+        // Every thread takes part in the loop so the implicit barrier is
+        // reached; threads without buffers skip their queries
+        #pragma omp for schedule(dynamic, 1)
+        for (int q = 0; q < count; q++) {
+            if (!ok) {
+                continue;
+            }
+            if (sssp_workspace_run(ws, graph_node(graph, sources[q]), distances) != 0) {
+                #pragma omp atomic write
+                failed = true;
+                ok = false;
+                continue;
+            }
+            const int *result = distances;
+            if (input_order) {
+                for (int v = 0; v < graph->num_nodes; v++) {
+                    input_order[graph->original_id[v]] = distances[v];
+                }
+                result = input_order;
+            }
+            DistanceSummary summary;
+            if (format == OUTPUT_SUMMARY || summaries) {
+                summary = summarize_distances(result, graph->num_nodes, 1);
+                if (summaries) {
+                    summaries[q] = summary;
+                }
+            }
+            if (format == OUTPUT_TEXT) {
+                char *p = buffer + sprintf(buffer, "Shortest distances from node %d:\n", sources[q]);
+                p += format_distance_lines(p, result, 0, graph->num_nodes);
+                *p++ = '\n';
+                #pragma omp critical(batch_output)
+                fwrite(buffer, 1, (size_t)(p - buffer), out);
+            } else if (format == OUTPUT_SUMMARY) {
+                #pragma omp critical(batch_output)
+                print_distance_summary(out, sources[q], &summary, graph->num_nodes);
+            }
+        }
+
+        free(buffer);
+        free(input_order);
+        free(distances);
+        sssp_workspace_free(ws);
+    }
+
+    double elapsed = omp_get_wtime() - start;
+    if (failed) {
+        fprintf(stderr, "Error: Batch queries ran out of memory\n");
+        return -1.0;
+    }
+    return elapsed;
+}
@@ -0,0 +1,627 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "sssp.h"
+#include "pqueue.h"
+
+// Contraction hierarchies. Nodes are contracted in rounds: each round takes
+// the nodes whose priority is lower than that of every remaining neighbor
+// (an independent set) and contracts them in parallel. Contracting v removes
+// it from the remaining graph and adds a shortcut u - w of length
+// d(u, v) + d(v, w) for each neighbor pair unless a witness search finds a
+// path at least as short that avoids v. Witness searches also avoid the
+// other nodes of the round, so two nodes of one round never rely on each
+// other as witnesses. A node's priority is its edge difference (shortcuts
+// added minus edges removed) plus its number of contracted neighbors, which
+// spreads contraction evenly over the graph.
+//
+// The edges a node still has when it is contracted all lead to nodes
+// contracted later, i.e. higher in the hierarchy. Collected per node they
+// form the upward graph, and a shortest path always climbs up from both
+// ends to a single highest node, so a query is a bidirectional search that
+// only follows upward edges.
+
+// Witness searches give up after settling this many nodes; a failed search
+// only costs an unnecessary shortcut. Priority estimates, which are redone
+// whenever a neighbor is contracted, use the smaller limit.
+#define WITNESS_SETTLE_LIMIT 128
+#define PRIORITY_SETTLE_LIMIT 32
+
+typedef struct {
+    int *to;
+    int *weight;
+    int size;
+    int capacity;
+} Adjacency;
+
+typedef struct {
+    int *data;      // (u, w, length) triples
+    int size;
+    int capacity;
+} ShortcutList;
+
+// Per-thread state for witness searches on the remaining graph
+typedef struct {
+    int *dist;
+    int *touched;
+    int num_touched;
+    bool *is_target;
+    IndexedHeap *heap;
+    long long settled;
+    ShortcutList shortcuts;
+    bool failed;            // a shortcut could not be recorded
+} WitnessSearch;
+
+typedef struct {
+    int num_nodes;
+    Adjacency *adj;         // remaining graph; frozen (= upward edges) once a node is contracted
+    int *round_of;          // round a node was contracted in, -1 while it remains
+    int *deleted;           // contracted neighbors
+    int *priority;
+} Contraction;
+
+static bool adjacency_push(Adjacency *a, int to, int weight) {
+    if (a->size == a->capacity) {
+        int capacity = a->capacity ? a->capacity * 2 : 4;
+        int *new_to = (int*)realloc(a->to, (size_t)capacity * sizeof(int));
+        if (!new_to) {
+            return false;
+        }
+        a->to = new_to;
+        int *new_weight = (int*)realloc(a->weight, (size_t)capacity * sizeof(int));
+        if (!new_weight) {
+            return false;
+        }
+        a->weight = new_weight;
+        a->capacity = capacity;
+    }
+    a->to[a->size] = to;
+    a->weight[a->size] = weight;
+    a->size++;
+    return true;
+}
+
+// Add the edge or shorten an existing parallel one
+static bool adjacency_add_or_lower(Adjacency *a, int to, int weight) {
+    for (int i = 0; i < a->size; i++) {
+        if (a->to[i] == to) {
+            if (weight < a->weight[i]) {
+                a->weight[i] = weight;
+            }
+            return true;
+        }
+    }
+    return adjacency_push(a, to, weight);
+}
+
+static void adjacency_remove(Adjacency *a, int to) {
+    for (int i = 0; i < a->size; i++) {
+        if (a->to[i] == to) {
+            a->size--;
+            a->to[i] = a->to[a->size];
+            a->weight[i] = a->weight[a->size];
+            return;
+        }
+    }
+}
+
+static bool shortcut_push(ShortcutList *list, int u, int w, int length) {
+    if (list->size + 3 > list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 96;
+        int *data = (int*)realloc(list->data, (size_t)capacity * sizeof(int));
+        if (!data) {
+            return false;
+        }
+        list->data = data;
+        list->capacity = capacity;
+    }
+    list->data[list->size++] = u;
+    list->data[list->size++] = w;
+    list->data[list->size++] = length;
+    return true;
+}
+
+// Dijkstra from source on the remaining graph, skipping every node
+// contracted in round (and skip itself), until all num_targets flagged
+// targets are settled, the next node is farther than limit or
+// settle_limit nodes are settled
+static void witness_search(const Contraction *c, WitnessSearch *ws, int source, int skip, int round,
+                           int num_targets, int limit, int settle_limit) {
+    ws->dist[source] = 0;
+    ws->touched[ws->num_touched++] = source;
+    heap_push_or_decrease(ws->heap, source, 0);
+    int settled = 0;
+    while (num_targets > 0 && !heap_empty(ws->heap) && heap_top_key(ws->heap) <= limit &&
+           settled < settle_limit) {
+        int node = heap_pop(ws->heap);
+        settled++;
+        if (ws->is_target[node]) {
+            num_targets--;
+        }
+        const Adjacency *a = &c->adj[node];
+        for (int i = 0; i < a->size; i++) {
+            int next = a->to[i];
+            if (next == skip || c->round_of[next] == round) {
+                continue;
+            }
+            int new_dist = ws->dist[node] + a->weight[i];
+            if (new_dist <= limit && new_dist < ws->dist[next]) {
+                if (ws->dist[next] == INF) {
+                    ws->touched[ws->num_touched++] = next;
+                }
+                ws->dist[next] = new_dist;
+                heap_push_or_decrease(ws->heap, next, new_dist);
+            }
+        }
+    }
+    ws->settled += settled;
+}
+
+static void witness_reset(WitnessSearch *ws) {
+    for (int i = 0; i < ws->num_touched; i++) {
+        ws->dist[ws->touched[i]] = INF;
+    }
+    ws->num_touched = 0;
+    heap_clear(ws->heap);
+}
+
+// Contract v on paper: returns the number of shortcuts needed, appending
+// them to ws->shortcuts when record is set. Each neighbor pair is checked
+// once, from the neighbor that comes first in v's list.
+static int simulate_contraction(const Contraction *c, WitnessSearch *ws, int v, int round, bool record) {
+    const Adjacency *a = &c->adj[v];
+    int shortcuts = 0;
+    for (int i = 0; i + 1 < a->size; i++) {
+        int u = a->to[i];
+        int max_rest = 0;
+        for (int j = i + 1; j < a->size; j++) {
+            if (a->weight[j] > max_rest) {
+                max_rest = a->weight[j];
+            }
+            ws->is_target[a->to[j]] = true;
+        }
+        witness_search(c, ws, u, v, round, a->size - i - 1, a->weight[i] + max_rest,
+                       record ? WITNESS_SETTLE_LIMIT : PRIORITY_SETTLE_LIMIT);
+        for (int j = i + 1; j < a->size; j++) {
+            ws->is_target[a->to[j]] = false;
+            int via = a->weight[i] + a->weight[j];
+            if (ws->dist[a->to[j]] > via) {
+                shortcuts++;
+                if (record && !shortcut_push(&ws->shortcuts, u, a->to[j], via)) {
+                    ws->failed = true;
+                }
+            }
+        }
+        witness_reset(ws);
+    }
+    return shortcuts;
+}
+
+static int compute_priority(const Contraction *c, WitnessSearch *ws, int v) {
+    // round -2 matches no node, so only v itself is skipped
+    int shortcuts = simulate_contraction(c, ws, v, -2, false);
+    return shortcuts - c->adj[v].size + c->deleted[v];
+}
+
+// Strict order on (priority, hashed id) so ties between neighbors break consistently
+static inline bool lower_priority(const Contraction *c, int a, int b) {
+    if (c->priority[a] != c->priority[b]) {
+        return c->priority[a] < c->priority[b];
+    }
+    unsigned ha = (unsigned)a * 2654435761u;
+    unsigned hb = (unsigned)b * 2654435761u;
+    return ha != hb ? ha < hb : a < b;
+}
+
+// Copy graph into per-node lists, dropping self-loops and keeping the
+// lightest of parallel edges
+static bool load_remaining_graph(Contraction *c, const Graph *graph) {
+    int n = graph->num_nodes;
+    int *slot = (int*)malloc((size_t)n * sizeof(int));
+    if (!slot) {
+        return false;
+    }
+    for (int i = 0; i < n; i++) {
+        slot[i] = -1;
+    }
+    bool ok = true;
+    for (int u = 0; u < n && ok; u++) {
+        Adjacency *a = &c->adj[u];
+        for (int i = graph->offsets[u]; i < graph->offsets[u + 1] && ok; i++) {
+            int v = graph->dest[i];
+            if (v == u) {
+                continue;
+            }
+            if (slot[v] >= 0) {
+                if (graph->weight[i] < a->weight[slot[v]]) {
+                    a->weight[slot[v]] = graph->weight[i];
+                }
+            } else {
+                slot[v] = a->size;
+                ok = adjacency_push(a, v, graph->weight[i]);
+            }
+        }
+        for (int i = 0; i < a->size; i++) {
+            slot[a->to[i]] = -1;
+        }
+    }
+    free(slot);
+    return ok;
+}
+
+static void free_contraction(Contraction *c, WitnessSearch *searches, int num_threads) {
+    if (c->adj) {
+        for (int v = 0; v < c->num_nodes; v++) {
+            free(c->adj[v].to);
+            free(c->adj[v].weight);
+        }
+    }
+    free(c->adj);
+    free(c->round_of);
+    free(c->deleted);
+    free(c->priority);
+    if (searches) {
+        for (int t = 0; t < num_threads; t++) {
+            free(searches[t].dist);
+            free(searches[t].touched);
+            free(searches[t].is_target);
+            heap_free(searches[t].heap);
+            free(searches[t].shortcuts.data);
+        }
+        free(searches);
+    }
+}
+
+// Gather the frozen lists of the contracted nodes (and the core's remaining
+// lists) into the upward graph, and the contraction rounds into levels
+static ContractionHierarchy* build_hierarchy(const Contraction *c, const Graph *graph) {
+    int n = c->num_nodes;
+    ContractionHierarchy *ch = (ContractionHierarchy*)calloc(1, sizeof(ContractionHierarchy));
+    Graph *up = (Graph*)calloc(1, sizeof(Graph));
+    if (ch) {
+        ch->up = up;
+        ch->level = (int*)malloc((size_t)n * sizeof(int));
+    }
+    if (up) {
+        up->num_nodes = n;
+        up->num_edges = graph->num_edges;
+        // The hierarchy shares the graph's numbering, which its file records
+        up->order = graph->order;
+        up->offsets = (int*)malloc(((size_t)n + 1) * sizeof(int));
+    }
+    if (!ch || !up || !ch->level || !up->offsets) {
+        free_graph(up);
+        if (ch) {
+            ch->up = NULL;
+        }
+        free_hierarchy(ch);
+        return NULL;
+    }
+    up->offsets[0] = 0;
+    for (int v = 0; v < n; v++) {
+        up->offsets[v + 1] = up->offsets[v] + c->adj[v].size;
+        ch->level[v] = c->round_of[v] >= 0 ? c->round_of[v] : CH_CORE_LEVEL;
+    }
+    size_t entries = (size_t)up->offsets[n];
+    up->dest = (int*)malloc((entries > 0 ? entries : 1) * sizeof(int));
+    up->weight = (int*)malloc((entries > 0 ? entries : 1) * sizeof(int));
+    if (!up->dest || !up->weight) {
+        free_hierarchy(ch);
+        return NULL;
+    }
+    for (int v = 0; v < n; v++) {
+        const Adjacency *a = &c->adj[v];
+        memcpy(up->dest + up->offsets[v], a->to, (size_t)a->size * sizeof(int));
+        memcpy(up->weight + up->offsets[v], a->weight, (size_t)a->size * sizeof(int));
+        for (int i = 0; i < a->size; i++) {
+            if (a->weight[i] > up->max_weight) {
+                up->max_weight = a->weight[i];
+            }
+        }
+    }
+    return ch;
+}
+
+// Apply the shortcuts recorded by every thread in one round
+static bool add_shortcuts(Contraction *c, WitnessSearch *searches, int num_threads, long long *num_shortcuts) {
+    bool ok = true;
+    for (int t = 0; t < num_threads; t++) {
+        ShortcutList *list = &searches[t].shortcuts;
+        ok = ok && !searches[t].failed;
+        for (int k = 0; ok && k < list->size; k += 3) {
+            int u = list->data[k];
+            int w = list->data[k + 1];
+            int length = list->data[k + 2];
+            ok = adjacency_add_or_lower(&c->adj[u], w, length) && adjacency_add_or_lower(&c->adj[w], u, length);
+        }
+        *num_shortcuts += list->size / 3;
+        list->size = 0;
+    }
+    return ok;
+}
+
+ContractionHierarchy* contract_graph(const Graph *graph, int core_degree, int num_threads, ContractionStats *stats) {
+    int n = graph->num_nodes;
+    if (num_threads <= 0) {
+        num_threads = omp_get_max_threads();
+    }
+    Contraction c;
+    c.num_nodes = n;
+    c.adj = (Adjacency*)calloc(n, sizeof(Adjacency));
+    c.round_of = (int*)malloc((size_t)n * sizeof(int));
+    c.deleted = (int*)calloc(n, sizeof(int));
+    c.priority = (int*)malloc((size_t)n * sizeof(int));
+    WitnessSearch *searches = (WitnessSearch*)calloc(num_threads, sizeof(WitnessSearch));
+    int *remaining = (int*)malloc((size_t)n * sizeof(int));
+    int *selected = (int*)malloc((size_t)n * sizeof(int));
+    bool *dirty = (bool*)calloc(n, sizeof(bool));
+    bool ok = c.adj && c.round_of && c.deleted && c.priority && searches && remaining && selected && dirty;
+    for (int t = 0; ok && t < num_threads; t++) {
+        searches[t].dist = (int*)malloc((size_t)n * sizeof(int));
+        searches[t].touched = (int*)malloc((size_t)n * sizeof(int));
+        searches[t].is_target = (bool*)calloc(n, sizeof(bool));
+        searches[t].heap = heap_create(n);
+        ok = searches[t].dist && searches[t].touched && searches[t].is_target && searches[t].heap;
+        for (int i = 0; ok && i < n; i++) {
+            searches[t].dist[i] = INF;
+        }
+    }
+    ok = ok && load_remaining_graph(&c, graph);
+
+    int num_remaining = n;
+    int round = 0;
+    long long num_shortcuts = 0;
+    if (ok) {
+        for (int v = 0; v < n; v++) {
+            c.round_of[v] = -1;
+            remaining[v] = v;
+        }
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 64)
+        for (int v = 0; v < n; v++) {
+            c.priority[v] = compute_priority(&c, &searches[omp_get_thread_num()], v);
+        }
+    }
+
+    // Contract until nothing remains or the remaining graph has become
+    // denser than core_degree edges per node
+    long long remaining_entries = graph->offsets[n];
+    while (ok && num_remaining > 0 &&
+           (core_degree <= 0 || remaining_entries <= (long long)core_degree * num_remaining)) {
+        // Independent set: nodes ranked below all of their remaining neighbors
+        int num_selected = 0;
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 256)
+        for (int i = 0; i < num_remaining; i++) {
+            int v = remaining[i];
+            const Adjacency *a = &c.adj[v];
+            bool local_min = true;
+            for (int k = 0; k < a->size && local_min; k++) {
+                local_min = lower_priority(&c, v, a->to[k]);
+            }
+            if (local_min) {
+                int slot;
+                #pragma omp atomic capture
+                slot = num_selected++;
+                selected[slot] = v;
+            }
+        }
+        for (int i = 0; i < num_selected; i++) {
+            c.round_of[selected[i]] = round;
+        }
+
+        // Witness searches for the whole set run in parallel on the unchanged graph
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 16)
+        for (int i = 0; i < num_selected; i++) {
+            simulate_contraction(&c, &searches[omp_get_thread_num()], selected[i], round, true);
+        }
+
+        // Detach the contracted nodes; their own lists stay as upward edges
+        for (int i = 0; i < num_selected; i++) {
+            int v = selected[i];
+            const Adjacency *a = &c.adj[v];
+            for (int k = 0; k < a->size; k++) {
+                int u = a->to[k];
+                adjacency_remove(&c.adj[u], v);
+                c.deleted[u]++;
+                dirty[u] = true;
+            }
+        }
+        ok = add_shortcuts(&c, searches, num_threads, &num_shortcuts);
+
+        // Drop the contracted nodes and refresh the priorities of their neighbors
+        int kept = 0;
+        remaining_entries = 0;
+        for (int i = 0; i < num_remaining; i++) {
+            int v = remaining[i];
+            if (c.round_of[v] < 0) {
+                remaining[kept++] = v;
+                remaining_entries += c.adj[v].size;
+            }
+        }
+        num_remaining = kept;
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 64)
+        for (int i = 0; i < num_remaining; i++) {
+            int v = remaining[i];
+            if (dirty[v]) {
+                dirty[v] = false;
+                c.priority[v] = compute_priority(&c, &searches[omp_get_thread_num()], v);
+            }
+        }
+        round++;
+    }
+
+    ContractionHierarchy *ch = ok ? build_hierarchy(&c, graph) : NULL;
+    if (!ch) {
+        perror("Error allocating contraction hierarchy");
+    } else if (stats) {
+        stats->num_rounds = round;
+        stats->core_nodes = num_remaining;
+        stats->num_shortcuts = num_shortcuts;
+        stats->witness_settled = 0;
+        for (int t = 0; t < num_threads; t++) {
+            stats->witness_settled += searches[t].settled;
+        }
+    }
+    free_contraction(&c, searches, num_threads);
+    free(remaining);
+    free(selected);
+    free(dirty);
+    return ch;
+}
+
+// Query in two phases. First, Dijkstra on the upward edges from both ends;
+// a side stops once its smallest key reaches the best meeting distance mu.
+// Stall on demand: the upward edges of a node are also its edges from
+// higher neighbors, so a node reachable more cheaply through an already
+// reached higher neighbor is not on a shortest up path and is not expanded.
+// Core nodes reached in the first phase wait in separate heaps. Second, a
+// bidirectional Dijkstra inside the core (whose edges are symmetric) starts
+// from those entry points and stops once the two core frontier keys sum to
+// at least mu, as in bidirectional_query.
+
+typedef struct {
+    int *dist;
+    IndexedHeap *heap;      // nodes below the core
+    IndexedHeap *core_heap;
+} UpwardSide;
+
+struct ChWorkspace {
+    const ContractionHierarchy *ch;
+    UpwardSide side[2];     // 0: from source, 1: from target
+    int *touched;
+    int num_touched;
+    bool *is_touched;
+};
+
+ChWorkspace* ch_workspace_create(const ContractionHierarchy *ch) {
+    int n = ch->up->num_nodes;
+    ChWorkspace *ws = (ChWorkspace*)calloc(1, sizeof(ChWorkspace));
+    if (!ws) {
+        perror("Error allocating hierarchy search");
+        return NULL;
+    }
+    ws->ch = ch;
+    bool ok = true;
+    for (int s = 0; s < 2; s++) {
+        ws->side[s].dist = (int*)malloc((size_t)n * sizeof(int));
+        ws->side[s].heap = heap_create(n);
+        ws->side[s].core_heap = heap_create(n);
+        ok = ok && ws->side[s].dist && ws->side[s].heap && ws->side[s].core_heap;
+    }
+    ws->touched = (int*)malloc((size_t)n * sizeof(int));
+    ws->is_touched = (bool*)calloc(n, sizeof(bool));
+    if (!ok || !ws->touched || !ws->is_touched) {
+        perror("Error allocating hierarchy search");
+        ch_workspace_free(ws);
+        return NULL;
+    }
+    for (int s = 0; s < 2; s++) {
+        for (int i = 0; i < n; i++) {
+            ws->side[s].dist[i] = INF;
+        }
+    }
+    return ws;
+}
+
+void ch_workspace_free(ChWorkspace *ws) {
+    if (!ws) {
+        return;
+    }
+    for (int s = 0; s < 2; s++) {
+        free(ws->side[s].dist);
+        heap_free(ws->side[s].heap);
+        heap_free(ws->side[s].core_heap);
+    }
+    free(ws->touched);
+    free(ws->is_touched);
+    free(ws);
+}
+
+// Lower the distance of node on side s and queue it in the heap of its level;
+// returns the best meeting distance through node
+static inline int ch_reach(ChWorkspace *ws, int s, int node, int dist, int mu) {
+    UpwardSide *self = &ws->side[s];
+    self->dist[node] = dist;
+    if (!ws->is_touched[node]) {
+        ws->is_touched[node] = true;
+        ws->touched[ws->num_touched++] = node;
+    }
+    bool core = ws->ch->level[node] == CH_CORE_LEVEL;
+    heap_push_or_decrease(core ? self->core_heap : self->heap, node, dist);
+    int other = ws->side[1 - s].dist[node];
+    return (other != INF && (long long)dist + other < mu) ? dist + other : mu;
+}
+
+int ch_query(ChWorkspace *ws, int source, int target, int *num_settled) {
+    const Graph *up = ws->ch->up;
+    UpwardSide *side = ws->side;
+    int settled_count = 0;
+    int mu = INF;
+
+    mu = ch_reach(ws, 0, source, 0, mu);
+    mu = ch_reach(ws, 1, target, 0, mu);
+
+    for (;;) {
+        bool live0 = !heap_empty(side[0].heap) && heap_top_key(side[0].heap) < mu;
+        bool live1 = !heap_empty(side[1].heap) && heap_top_key(side[1].heap) < mu;
+        if (!live0 && !live1) {
+            break;
+        }
+        int s = (live0 && (!live1 || heap_top_key(side[0].heap) <= heap_top_key(side[1].heap))) ? 0 : 1;
+        UpwardSide *self = &side[s];
+        int node = heap_pop(self->heap);
+        int base_dist = self->dist[node];
+        settled_count++;
+
+        bool stalled = false;
+        for (int i = up->offsets[node]; i < up->offsets[node + 1] && !stalled; i++) {
+            int higher = self->dist[up->dest[i]];
+            stalled = higher != INF && (long long)higher + up->weight[i] < base_dist;
+        }
+        if (stalled) {
+            continue;
+        }
+        for (int i = up->offsets[node]; i < up->offsets[node + 1]; i++) {
+            int new_dist = base_dist + up->weight[i];
+            if (new_dist < self->dist[up->dest[i]]) {
+                mu = ch_reach(ws, s, up->dest[i], new_dist, mu);
+            }
+        }
+    }
+
+    while (!heap_empty(side[0].core_heap) && !heap_empty(side[1].core_heap)) {
+        int top0 = heap_top_key(side[0].core_heap);
+        int top1 = heap_top_key(side[1].core_heap);
+        if ((long long)top0 + top1 >= mu) {
+            break;
+        }
+        int s = (top0 <= top1) ? 0 : 1;
+        UpwardSide *self = &side[s];
+        int node = heap_pop(self->core_heap);
+        int base_dist = self->dist[node];
+        settled_count++;
+        for (int i = up->offsets[node]; i < up->offsets[node + 1]; i++) {
+            int new_dist = base_dist + up->weight[i];
+            if (new_dist < self->dist[up->dest[i]]) {
+                mu = ch_reach(ws, s, up->dest[i], new_dist, mu);
+            }
+        }
+    }
+
+    for (int i = 0; i < ws->num_touched; i++) {
+        int node = ws->touched[i];
+        side[0].dist[node] = INF;
+        side[1].dist[node] = INF;
+        ws->is_touched[node] = false;
+    }
+    ws->num_touched = 0;
+    for (int s = 0; s < 2; s++) {
+        heap_clear(side[s].heap);
+        heap_clear(side[s].core_heap);
+    }
+
+    if (num_settled) {
+        *num_settled = settled_count;
+    }
+    return mu;
+}
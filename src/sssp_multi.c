@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "sssp.h"
+#include "pqueue.h"
+
+// Lockstep multi-source engine. Distances are stored node-major as
+// dist[node * MULTI_SOURCE_LANES + lane], so relaxing one edge is a single
+// element-wise min over a contiguous lane vector. The lane loops have a
+// fixed trip count and no branches, so the compiler turns them into packed
+// unsigned adds and mins (two AVX2 or one AVX-512 op for 16 lanes when
+// built with ARCH_FLAGS=-march=native).
+//
+// The search is label-correcting with delta-stepping order: a node is
+// rescanned whenever any lane improves, and queued nodes are processed
+// bucket by bucket (bucket = smallest improved lane distance / delta), so
+// lanes whose wavefronts are close together share scans. Unused lanes stay at INF.
+
+#define LANES MULTI_SOURCE_LANES
+
+// Relax edge (u -> v, w) in every lane. Returns the smallest new distance
+// among the lanes of v that improved, or UINT_MAX if none did. Arithmetic is
+// unsigned so INF + w stays above every finite distance.
+static inline unsigned relax_lanes(const int *restrict du, int *restrict dv, int w) {
+    unsigned improved_min = UINT_MAX;
+    #pragma omp simd reduction(min:improved_min)
+    for (int k = 0; k < LANES; k++) {
+        unsigned candidate = (unsigned)du[k] + (unsigned)w;
+        unsigned old = (unsigned)dv[k];
+        bool better = candidate < old;
+        dv[k] = (int)(better ? candidate : old);
+        unsigned key = better ? candidate : UINT_MAX;
+        improved_min = key < improved_min ? key : improved_min;
+    }
+    return improved_min;
+}
+
+int dijkstra_multi_source(const Graph *graph, const int *sources, int count, int **distances, int delta) {
+    int n = graph->num_nodes;
+    if (count > LANES) {
+        count = LANES;
+    }
+    if (delta <= 0) {
+        delta = default_delta(graph);
+    }
+    int *dist = (int*)malloc((size_t)n * LANES * sizeof(int));
+    int *queued_bin = (int*)malloc((size_t)n * sizeof(int));
+    BucketSet buckets = {NULL, 0};
+    bool ok = true;
+    if (!dist || !queued_bin) {
+        perror("Error allocating multi-source buffers");
+        free(dist);
+        free(queued_bin);
+        return -1;
+    }
+
+    for (size_t i = 0; i < (size_t)n * LANES; i++) {
+        dist[i] = INF;
+    }
+    for (int v = 0; v < n; v++) {
+        queued_bin[v] = INT_MAX;
+    }
+    for (int k = 0; ok && k < count; k++) {
+        int s = sources[k];
+        dist[(size_t)s * LANES + k] = 0;
+        if (queued_bin[s] != 0) {
+            queued_bin[s] = 0;
+            ok = bucket_push(&buckets, 0, s);
+        }
+    }
+
+    // A node is queued in the bucket of the smallest lane distance that
+    // changed since it was last scanned; queued_bin[] is that bucket, so
+    // entries left behind by an earlier, higher bucket are skipped
+    for (int bin = 0; ok && bin < buckets.num_bins; bin = bucket_next_nonempty(&buckets, bin)) {
+        // The bucket may grow (and the bin array move) while it is scanned
+        for (int idx = 0; ok && idx < buckets.bins[bin].size; idx++) {
+            int u = buckets.bins[bin].data[idx];
+            if (queued_bin[u] != bin) {
+                continue;
+            }
+            queued_bin[u] = INT_MAX;
+            int du[LANES];
+            memcpy(du, dist + (size_t)u * LANES, sizeof(du));
+            for (int i = graph->offsets[u]; i < graph->offsets[u + 1]; i++) {
+                int v = graph->dest[i];
+                unsigned key = relax_lanes(du, dist + (size_t)v * LANES, graph->weight[i]);
+                if (key != UINT_MAX) {
+                    int target = (int)(key / (unsigned)delta);
+                    if (target < bin) {
+                        target = bin;
+                    }
+                    if (target < queued_bin[v]) {
+                        queued_bin[v] = target;
+                        if (!bucket_push(&buckets, target, v)) {
+                            ok = false;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+        buckets.bins[bin].size = 0;
+    }
+
+    // Transpose back to one array per source
+    for (int k = 0; ok && k < count; k++) {
+        int *out = distances[k];
+        for (int v = 0; v < n; v++) {
+            out[v] = dist[(size_t)v * LANES + k];
+        }
+    }
+
+    free(dist);
+    free(queued_bin);
+    bucket_set_free(&buckets);
+    return ok ? 0 : -1;
+}
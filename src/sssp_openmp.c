@@ -0,0 +1,501 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "sssp.h"
+#include "pqueue.h"
+#include "instrument.h"
+
+// Barrier whose wait is charged to the sync phase
+static inline void phase_barrier(void) {
+    INSTR_PHASE_BEGIN(wait_start);
+    #pragma omp barrier
+    INSTR_PHASE_END(INSTR_SYNC, wait_start);
+}
+
+// Parallel Dijkstra's algorithm using OpenMP
+int dijkstra_parallel(const Graph *graph, int source, int *distances, int num_threads) {
+    bool *visited = (bool*)malloc(graph->num_nodes * sizeof(bool));
+    if (!visited) {
+        perror("Error allocating solver state");
+        return -1;
+    }
+    
+    // The scans use the same static schedule, so each thread first touches
+    // (and on NUMA systems places) the part of both arrays it scans
+    #pragma omp parallel for num_threads(num_threads) schedule(static)
+    for (int i = 0; i < graph->num_nodes; i++) {
+        distances[i] = INF;
+        visited[i] = false;
+    }
+    distances[source] = 0;
+    
+    for (int count = 0; count < graph->num_nodes; count++) {
+        int min_dist = INF;
+        int min_node = -1;
+        
+        // The fork/join engines are timed by the calling thread, so each
+        // phase includes its parallel region's fork and join
+        INSTR_PHASE_BEGIN(select_start);
+        #pragma omp parallel for num_threads(num_threads) schedule(static) reduction(min:min_dist)
+        for (int v = 0; v < graph->num_nodes; v++) {
+            if (!visited[v] && distances[v] < min_dist) {
+                min_dist = distances[v];
+            }
+        }
+        
+        if (min_dist == INF) {
+            break;
+        }
+        
+        for (int v = 0; v < graph->num_nodes; v++) {
+            if (!visited[v] && distances[v] == min_dist) {
+                min_node = v;
+                break;
+            }
+        }
+        INSTR_PHASE_END(INSTR_SELECT, select_start);
+        
+        if (min_node == -1) {
+            break;
+        }
+        
+        visited[min_node] = true;
+        
+        int edge_begin = graph->offsets[min_node];
+        int edge_end = graph->offsets[min_node + 1];
+        INSTR_COUNT(INSTR_SETTLED, 1);
+        INSTR_COUNT(INSTR_EDGES, edge_end - edge_begin);
+        INSTR_PHASE_BEGIN(relax_start);
+        #pragma omp parallel for num_threads(num_threads)
+        for (int i = edge_begin; i < edge_end; i++) {
+            int neighbor = graph->dest[i];
+            int weight = graph->weight[i];
+            
+            if (!visited[neighbor] && distances[min_node] != INF) {
+                int new_dist = distances[min_node] + weight;
+                #pragma omp critical
+                {
+                    if (new_dist < distances[neighbor]) {
+                        distances[neighbor] = new_dist;
+                        INSTR_COUNT(INSTR_DECREASES, 1);
+                    }
+                }
+            }
+        }
+        INSTR_PHASE_END(INSTR_RELAX, relax_start);
+    }
+    
+    free(visited);
+    return 0;
+}
+
+int dijkstra_parallel_optimized(const Graph *graph, int source, int *distances, int num_threads) {
+    bool *visited = (bool*)malloc(graph->num_nodes * sizeof(bool));
+    if (!visited) {
+        perror("Error allocating solver state");
+        return -1;
+    }
+    
+    // The scans use the same static schedule, so each thread first touches
+    // (and on NUMA systems places) the part of both arrays it scans
+    #pragma omp parallel for num_threads(num_threads) schedule(static)
+    for (int i = 0; i < graph->num_nodes; i++) {
+        distances[i] = INF;
+        visited[i] = false;
+    }
+    distances[source] = 0;
+    
+    for (int count = 0; count < graph->num_nodes; count++) {
+        int min_dist = INF;
+        int min_node = -1;
+        
+        INSTR_PHASE_BEGIN(select_start);
+        #pragma omp parallel num_threads(num_threads)
+        {
+            int local_min_dist = INF;
+            int local_min_node = -1;
+            
+            #pragma omp for schedule(static) nowait
+            for (int v = 0; v < graph->num_nodes; v++) {
+                if (!visited[v] && distances[v] < local_min_dist) {
+                    local_min_dist = distances[v];
+                    local_min_node = v;
+                }
+            }
+            
+            #pragma omp critical
+            {
+                if (local_min_dist < min_dist) {
+                    min_dist = local_min_dist;
+                    min_node = local_min_node;
+                }
+            }
+        }
+        INSTR_PHASE_END(INSTR_SELECT, select_start);
+        
+        if (min_dist == INF || min_node == -1) {
+            break;
+        }
+        
+        visited[min_node] = true;
+        
+        int edge_begin = graph->offsets[min_node];
+        int edge_end = graph->offsets[min_node + 1];
+        int base_dist = distances[min_node];
+        INSTR_COUNT(INSTR_SETTLED, 1);
+        INSTR_COUNT(INSTR_EDGES, edge_end - edge_begin);
+        
+        INSTR_PHASE_BEGIN(relax_start);
+        if (edge_end > edge_begin) {
+            #pragma omp parallel for num_threads(num_threads)
+            for (int i = edge_begin; i < edge_end; i++) {
+                int neighbor = graph->dest[i];
+                int weight = graph->weight[i];
+                
+                if (neighbor >= 0 && neighbor < graph->num_nodes && !visited[neighbor] && base_dist != INF) {
+                    int new_dist = base_dist + weight;
+                    #pragma omp critical
+                    {
+                        if (new_dist < distances[neighbor]) {
+                            distances[neighbor] = new_dist;
+                            INSTR_COUNT(INSTR_DECREASES, 1);
+                        }
+                    }
+                }
+            }
+        }
+        INSTR_PHASE_END(INSTR_RELAX, relax_start);
+    }
+    
+    free(visited);
+    return 0;
+}
+
+// Per-thread min-scan candidate, padded to its own cache line
+typedef struct {
+    int dist;
+    int node;
+    char pad[56];
+} MinCandidate;
+
+// Parallel Dijkstra's algorithm inside one persistent parallel region.
+// Each iteration costs two barriers instead of two fork/joins: one after the
+// threads publish their scan candidates (every thread then reduces them
+// itself) and one at the end of the relaxation loop. Relaxation uses a
+// lock-free atomic min instead of a global critical section.
+int dijkstra_parallel_persistent(const Graph *graph, int source, int *distances, int num_threads) {
+    int num_nodes = graph->num_nodes;
+    bool *visited = (bool*)malloc(num_nodes * sizeof(bool));
+    MinCandidate *candidates = (MinCandidate*)aligned_alloc(64, (size_t)num_threads * sizeof(MinCandidate));
+    if (!visited || !candidates) {
+        perror("Error allocating solver state");
+        free(visited);
+        free(candidates);
+        return -1;
+    }
+    
+    #pragma omp parallel num_threads(num_threads)
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        
+        // Same static schedule as the scan below, for NUMA first-touch placement
+        #pragma omp for schedule(static)
+        for (int i = 0; i < num_nodes; i++) {
+            distances[i] = INF;
+            visited[i] = false;
+        }
+        #pragma omp single
+        distances[source] = 0;
+        
+        for (int count = 0; count < num_nodes; count++) {
+            int local_min_dist = INF;
+            int local_min_node = -1;
+            
+            INSTR_PHASE_BEGIN(scan_start);
+            #pragma omp for schedule(static) nowait
+            for (int v = 0; v < num_nodes; v++) {
+                if (!visited[v] && distances[v] < local_min_dist) {
+                    local_min_dist = distances[v];
+                    local_min_node = v;
+                }
+            }
+            candidates[tid].dist = local_min_dist;
+            candidates[tid].node = local_min_node;
+            INSTR_PHASE_END(INSTR_SELECT, scan_start);
+            phase_barrier();
+            
+            // Every thread reduces the candidates, so all agree without another barrier
+            INSTR_PHASE_BEGIN(reduce_start);
+            int min_dist = INF;
+            int min_node = -1;
+            for (int t = 0; t < nthreads; t++) {
+                if (candidates[t].dist < min_dist ||
+                    (candidates[t].dist == min_dist && candidates[t].node < min_node)) {
+                    min_dist = candidates[t].dist;
+                    min_node = candidates[t].node;
+                }
+            }
+            INSTR_PHASE_END(INSTR_SELECT, reduce_start);
+            if (min_dist == INF || min_node == -1) {
+                break;
+            }
+            
+            #pragma omp single nowait
+            {
+                visited[min_node] = true;
+                INSTR_COUNT(INSTR_SETTLED, 1);
+            }
+            
+            INSTR_PHASE_BEGIN(relax_start);
+            #pragma omp for schedule(static) nowait
+            for (int i = graph->offsets[min_node]; i < graph->offsets[min_node + 1]; i++) {
+                int neighbor = graph->dest[i];
+                INSTR_COUNT(INSTR_EDGES, 1);
+                if (neighbor != min_node && !visited[neighbor]) {
+                    if (atomic_min_int(&distances[neighbor], min_dist + graph->weight[i])) {
+                        INSTR_COUNT(INSTR_DECREASES, 1);
+                    }
+                }
+            }
+            INSTR_PHASE_END(INSTR_RELAX, relax_start);
+            // Also keeps candidates stable until every thread has finished reading them
+            phase_barrier();
+        }
+    }
+    
+    free(candidates);
+    free(visited);
+    return 0;
+}
+
+// Concatenate every thread's copy of bucket bin into the shared frontier.
+// Must be called by all threads of the enclosing parallel region;
+// thread_sizes holds num_threads + 1 entries with thread_sizes[0] == 0.
+// Returns false on every thread, leaving the frontier empty, if it could not
+// grow.
+static bool gather_bucket(BucketSet *local, int bin, NodeList *frontier, int *thread_sizes) {
+    int tid = omp_get_thread_num();
+    int nthreads = omp_get_num_threads();
+    int local_size = (bin < local->num_bins) ? local->bins[bin].size : 0;
+    thread_sizes[tid + 1] = local_size;
+    phase_barrier();
+    #pragma omp single
+    {
+        for (int t = 0; t < nthreads; t++) {
+            thread_sizes[t + 1] += thread_sizes[t];
+        }
+        frontier->size = thread_sizes[nthreads];
+        if (frontier->size > frontier->capacity) {
+            free(frontier->data);
+            frontier->data = (int*)malloc((size_t)frontier->size * sizeof(int));
+            frontier->capacity = frontier->data ? frontier->size : 0;
+            if (!frontier->data) {
+                perror("Error allocating frontier");
+                frontier->size = 0;
+            }
+        }
+    }
+    bool ok = frontier->size == thread_sizes[nthreads];
+    if (ok && local_size > 0) {
+        memcpy(frontier->data + thread_sizes[tid], local->bins[bin].data, (size_t)local_size * sizeof(int));
+        local->bins[bin].size = 0;
+    }
+    phase_barrier();
+    return ok;
+}
+
+int default_delta(const Graph *graph) {
+    int num_entries = graph->offsets[graph->num_nodes];
+    if (num_entries == 0) {
+        return 1;
+    }
+    int max_weight = (graph->max_weight > 0) ? graph->max_weight : 1;
+    // Meyer & Sanders: delta ~ max_weight / average degree keeps light-edge
+    // re-relaxations bounded while still settling many nodes per bucket
+    int avg_degree = num_entries / graph->num_nodes;
+    int delta = (avg_degree > 0) ? max_weight / avg_degree : max_weight;
+    return (delta > 0) ? delta : 1;
+}
+
+// Delta-stepping: nodes are grouped into buckets of width delta and all nodes
+// in the lowest non-empty bucket are relaxed in parallel. Light edges
+// (weight <= delta) are relaxed repeatedly until the bucket stops refilling,
+// then heavy edges of every node settled in that bucket are relaxed once.
+int dijkstra_delta_stepping(const Graph *graph, int source, int *distances, int num_threads, int delta) {
+    int num_nodes = graph->num_nodes;
+    if (delta <= 0) {
+        delta = default_delta(graph);
+    }
+    
+    // Last bucket each node was settled in, so it is queued for the heavy phase once
+    int *settled_bin = (int*)malloc((size_t)num_nodes * sizeof(int));
+    NodeList frontier_buf = {NULL, 0, 0};
+    int *thread_sizes = (int*)calloc((size_t)num_threads + 1, sizeof(int));
+    if (!settled_bin || !thread_sizes) {
+        perror("Error allocating solver state");
+        free(settled_bin);
+        free(thread_sizes);
+        return -1;
+    }
+    int next_bin = INT_MAX;
+    // Set by any thread whose bucket or list could not grow; read only
+    // after a barrier, so every thread leaves the bucket loop together
+    bool failed = false;
+    
+    #pragma omp parallel for num_threads(num_threads) schedule(static)
+    for (int i = 0; i < num_nodes; i++) {
+        distances[i] = INF;
+        settled_bin[i] = -1;
+    }
+    distances[source] = 0;
+    if (!node_list_push(&frontier_buf, source)) {
+        free(thread_sizes);
+        free(settled_bin);
+        return -1;
+    }
+    
+    #pragma omp parallel num_threads(num_threads)
+    {
+        BucketSet local = {NULL, 0};
+        NodeList settled = {NULL, 0, 0};
+        int bin = 0;
+        
+        while (bin != INT_MAX) {
+            // Light phase: drain the current bucket until no thread refills it
+            for (;;) {
+                INSTR_PHASE_BEGIN(light_start);
+                #pragma omp for schedule(dynamic, 64) nowait
+                for (int f = 0; f < frontier_buf.size; f++) {
+                    int node = frontier_buf.data[f];
+                    int dist = __atomic_load_n(&distances[node], __ATOMIC_RELAXED);
+                    INSTR_COUNT(INSTR_QUEUE_POP, 1);
+                    if (dist / delta != bin) {
+                        continue;    // stale entry, node moved to a lower bucket
+                    }
+                    if (__atomic_exchange_n(&settled_bin[node], bin, __ATOMIC_RELAXED) != bin &&
+                        !node_list_push(&settled, node)) {
+                        __atomic_store_n(&failed, true, __ATOMIC_RELAXED);
+                    }
+                    INSTR_COUNT(INSTR_SETTLED, 1);
+                    INSTR_COUNT(INSTR_EDGES, graph->offsets[node + 1] - graph->offsets[node]);
+                    for (int i = graph->offsets[node]; i < graph->offsets[node + 1]; i++) {
+                        int weight = graph->weight[i];
+                        if (weight > delta) {
+                            continue;
+                        }
+                        int new_dist = dist + weight;
+                        int neighbor = graph->dest[i];
+                        if (atomic_min_int(&distances[neighbor], new_dist)) {
+                            if (!bucket_push(&local, new_dist / delta, neighbor)) {
+                                __atomic_store_n(&failed, true, __ATOMIC_RELAXED);
+                            }
+                            INSTR_COUNT(INSTR_DECREASES, 1);
+                        }
+                    }
+                }
+                INSTR_PHASE_END(INSTR_RELAX, light_start);
+                phase_barrier();
+                
+                if (!gather_bucket(&local, bin, &frontier_buf, thread_sizes)) {
+                    __atomic_store_n(&failed, true, __ATOMIC_RELAXED);
+                }
+                if (frontier_buf.size == 0) {
+                    break;
+                }
+            }
+            
+            // Heavy phase: distances in this bucket are final, relax heavy edges once
+            INSTR_PHASE_BEGIN(heavy_start);
+            for (int s = 0; s < settled.size; s++) {
+                int node = settled.data[s];
+                int dist = __atomic_load_n(&distances[node], __ATOMIC_RELAXED);
+                INSTR_COUNT(INSTR_EDGES, graph->offsets[node + 1] - graph->offsets[node]);
+                for (int i = graph->offsets[node]; i < graph->offsets[node + 1]; i++) {
+                    int weight = graph->weight[i];
+                    if (weight <= delta) {
+                        continue;
+                    }
+                    int new_dist = dist + weight;
+                    int neighbor = graph->dest[i];
+                    if (atomic_min_int(&distances[neighbor], new_dist)) {
+                        if (!bucket_push(&local, new_dist / delta, neighbor)) {
+                            __atomic_store_n(&failed, true, __ATOMIC_RELAXED);
+                        }
+                        INSTR_COUNT(INSTR_DECREASES, 1);
+                    }
+                }
+            }
+            settled.size = 0;
+            INSTR_PHASE_END(INSTR_RELAX, heavy_start);
+            
+            // Pick the lowest non-empty bucket across all threads
+            INSTR_PHASE_BEGIN(select_start);
+            #pragma omp single
+            next_bin = INT_MAX;
+            int local_next = bucket_next_nonempty(&local, bin);
+            #pragma omp critical
+            {
+                if (local_next < next_bin) {
+                    next_bin = local_next;
+                }
+            }
+            INSTR_PHASE_END(INSTR_SELECT, select_start);
+            phase_barrier();
+            bin = __atomic_load_n(&failed, __ATOMIC_RELAXED) ? INT_MAX : next_bin;
+            if (bin == INT_MAX) {
+                break;
+            }
+            
+            if (!gather_bucket(&local, bin, &frontier_buf, thread_sizes)) {
+                __atomic_store_n(&failed, true, __ATOMIC_RELAXED);
+            }
+        }
+        
+        bucket_set_free(&local);
+        free(settled.data);
+    }
+    
+    free(frontier_buf.data);
+    free(thread_sizes);
+    free(settled_bin);
+    return failed ? -1 : 0;
+}
+
+bool parse_parallel_engine(const char *name, ParallelEngine *engine) {
+    if (strcmp(name, "dijkstra") == 0) {
+        *engine = PARALLEL_ENGINE_DIJKSTRA;
+    } else if (strcmp(name, "persistent") == 0) {
+        *engine = PARALLEL_ENGINE_PERSISTENT;
+    } else if (strcmp(name, "delta") == 0) {
+        *engine = PARALLEL_ENGINE_DELTA;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* parallel_engine_name(ParallelEngine engine) {
+    switch (engine) {
+        case PARALLEL_ENGINE_PERSISTENT:
+            return "persistent";
+        case PARALLEL_ENGINE_DELTA:
+            return "delta";
+        case PARALLEL_ENGINE_DIJKSTRA:
+        default:
+            return "dijkstra";
+    }
+}
+
+int run_parallel_engine(ParallelEngine engine, const Graph *graph, int source, int *distances, int num_threads, int delta) {
+    switch (engine) {
+        case PARALLEL_ENGINE_PERSISTENT:
+            return dijkstra_parallel_persistent(graph, source, distances, num_threads);
+        case PARALLEL_ENGINE_DELTA:
+            return dijkstra_delta_stepping(graph, source, distances, num_threads, delta);
+        case PARALLEL_ENGINE_DIJKSTRA:
+        default:
+            return dijkstra_parallel_optimized(graph, source, distances, num_threads);
+    }
+}
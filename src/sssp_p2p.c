@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "sssp.h"
+#include "pqueue.h"
+
+// Point-to-point queries. dijkstra_point_to_point runs one engine search
+// that stops once the target is settled. Bidirectional Dijkstra: the graph is
+// undirected, so the backward search from the target runs on the same CSR.
+// Both searches keep their own distances, settled flags and heap; mu is the
+// shortest source-target path seen so far through an edge joining the two
+// search trees. The search stops once top_forward + top_backward >= mu,
+// since no unseen path can be shorter.
+//
+// Distance arrays start at INF and only the nodes a query touches are reset
+// afterwards, so a query costs time proportional to the explored region.
+
+typedef struct {
+    int *dist;
+    bool *settled;
+    IndexedHeap *heap;
+} SearchSide;
+
+struct BidirectionalWorkspace {
+    const Graph *graph;
+    SearchSide side[2];     // 0: forward from source, 1: backward from target
+    int *touched;           // nodes with a finite distance on either side
+    int num_touched;
+    bool *is_touched;
+};
+
+BidirectionalWorkspace* bidirectional_workspace_create(const Graph *graph) {
+    int n = graph->num_nodes;
+    BidirectionalWorkspace *ws = (BidirectionalWorkspace*)calloc(1, sizeof(BidirectionalWorkspace));
+    if (!ws) {
+        perror("Error allocating bidirectional search");
+        return NULL;
+    }
+    ws->graph = graph;
+    bool ok = true;
+    for (int s = 0; s < 2; s++) {
+        ws->side[s].dist = (int*)malloc((size_t)n * sizeof(int));
+        ws->side[s].settled = (bool*)calloc(n, sizeof(bool));
+        ws->side[s].heap = heap_create(n);
+        ok = ok && ws->side[s].dist && ws->side[s].settled && ws->side[s].heap;
+    }
+    ws->touched = (int*)malloc((size_t)n * sizeof(int));
+    ws->is_touched = (bool*)calloc(n, sizeof(bool));
+    if (!ok || !ws->touched || !ws->is_touched) {
+        perror("Error allocating bidirectional search");
+        bidirectional_workspace_free(ws);
+        return NULL;
+    }
+    for (int s = 0; s < 2; s++) {
+        for (int i = 0; i < n; i++) {
+            ws->side[s].dist[i] = INF;
+        }
+    }
+    return ws;
+}
+
+void bidirectional_workspace_free(BidirectionalWorkspace *ws) {
+    if (!ws) {
+        return;
+    }
+    for (int s = 0; s < 2; s++) {
+        free(ws->side[s].dist);
+        free(ws->side[s].settled);
+        heap_free(ws->side[s].heap);
+    }
+    free(ws->touched);
+    free(ws->is_touched);
+    free(ws);
+}
+
+static inline void touch(BidirectionalWorkspace *ws, int node) {
+    if (!ws->is_touched[node]) {
+        ws->is_touched[node] = true;
+        ws->touched[ws->num_touched++] = node;
+    }
+}
+
+int bidirectional_query(BidirectionalWorkspace *ws, int source, int target, int *num_settled) {
+    const Graph *graph = ws->graph;
+    SearchSide *side = ws->side;
+    int settled_count = 0;
+    int mu = INF;
+
+    side[0].dist[source] = 0;
+    side[1].dist[target] = 0;
+    touch(ws, source);
+    touch(ws, target);
+    heap_push_or_decrease(side[0].heap, source, 0);
+    heap_push_or_decrease(side[1].heap, target, 0);
+    if (source == target) {
+        mu = 0;
+    }
+
+    while (!heap_empty(side[0].heap) && !heap_empty(side[1].heap)) {
+        int top0 = heap_top_key(side[0].heap);
+        int top1 = heap_top_key(side[1].heap);
+        if ((long long)top0 + top1 >= mu) {
+            break;
+        }
+        // Expand the side with the smaller frontier key
+        int s = (top0 <= top1) ? 0 : 1;
+        SearchSide *self = &side[s];
+        const SearchSide *other = &side[1 - s];
+        int node = heap_pop(self->heap);
+        self->settled[node] = true;
+        settled_count++;
+        int base_dist = self->dist[node];
+
+        for (int i = graph->offsets[node]; i < graph->offsets[node + 1]; i++) {
+            int neighbor = graph->dest[i];
+            int new_dist = base_dist + graph->weight[i];
+            if (!self->settled[neighbor] && new_dist < self->dist[neighbor]) {
+                self->dist[neighbor] = new_dist;
+                touch(ws, neighbor);
+                heap_push_or_decrease(self->heap, neighbor, new_dist);
+            }
+            if (other->dist[neighbor] != INF && (long long)new_dist + other->dist[neighbor] < mu) {
+                mu = new_dist + other->dist[neighbor];
+            }
+        }
+    }
+
+    // Reset the touched region for the next query
+    for (int i = 0; i < ws->num_touched; i++) {
+        int node = ws->touched[i];
+        for (int s = 0; s < 2; s++) {
+            side[s].dist[node] = INF;
+            side[s].settled[node] = false;
+        }
+        ws->is_touched[node] = false;
+    }
+    ws->num_touched = 0;
+    heap_clear(side[0].heap);
+    heap_clear(side[1].heap);
+
+    if (num_settled) {
+        *num_settled = settled_count;
+    }
+    return mu;
+}
+
+int dijkstra_point_to_point(SequentialEngine engine, const Graph *graph, int source, int target, int *num_settled) {
+    SsspWorkspace *ws = sssp_workspace_create(graph, engine);
+    int *distances = ws ? (int*)malloc((size_t)graph->num_nodes * sizeof(int)) : NULL;
+    if (ws && !distances) {
+        perror("Error allocating distances");
+    }
+    int distance = -1;
+    if (ws && distances && sssp_workspace_search(ws, source, target, INF, distances) == 0) {
+        distance = distances[target];
+        if (num_settled) {
+            sssp_workspace_settled(ws, num_settled);
+        }
+    }
+    free(distances);
+    sssp_workspace_free(ws);
+    return distance;
+}
+
+int dijkstra_bidirectional(const Graph *graph, int source, int target, int *num_settled) {
+    BidirectionalWorkspace *ws = bidirectional_workspace_create(graph);
+    if (!ws) {
+        return -1;
+    }
+    int distance = bidirectional_query(ws, source, target, num_settled);
+    bidirectional_workspace_free(ws);
+    return distance;
+}
@@ -0,0 +1,389 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sssp.h"
+#include "pqueue.h"
+#include "instrument.h"
+
+// Per-query buffers; only the queue the engine needs is allocated. Every
+// engine runs on a workspace so batch workers and the query server can
+// reuse one across queries: visited[] is all false and the queue empty
+// between searches, and settled[] lists the nodes the last search settled.
+struct SsspWorkspace {
+    const Graph *graph;
+    SequentialEngine engine;
+    bool *visited;
+    int *settled;
+    int num_settled;
+    IndexedHeap *heap;
+    DialQueue *dial;
+    RadixHeap *radix;
+};
+
+// A search stops once target is settled (target < 0: never) or the next
+// node to settle is farther than limit; nodes not settled keep tentative
+// distances (an upper bound, or INF). The queue engines only count events;
+// per-node timers would cost as much as the work they measure.
+static inline void settle(SsspWorkspace *ws, int node) {
+    ws->visited[node] = true;
+    ws->settled[ws->num_settled++] = node;
+    INSTR_COUNT(INSTR_SETTLED, 1);
+    INSTR_COUNT(INSTR_EDGES, ws->graph->offsets[node + 1] - ws->graph->offsets[node]);
+}
+
+// Dijkstra's algorithm with a linear scan for the next node
+static void scan_search(SsspWorkspace *ws, int source, int target, int limit, int *distances) {
+    const Graph *graph = ws->graph;
+    bool *visited = ws->visited;
+    
+    for (int i = 0; i < graph->num_nodes; i++) {
+        distances[i] = INF;
+    }
+    distances[source] = 0;
+    
+    for (int count = 0; count < graph->num_nodes; count++) {
+        int min_dist = INF;
+        int min_node = -1;
+        
+        INSTR_PHASE_BEGIN(select_start);
+        for (int v = 0; v < graph->num_nodes; v++) {
+            if (!visited[v] && distances[v] < min_dist) {
+                min_dist = distances[v];
+                min_node = v;
+            }
+        }
+        INSTR_PHASE_END(INSTR_SELECT, select_start);
+        
+        if (min_node == -1 || min_dist > limit) {
+            break;
+        }
+        
+        settle(ws, min_node);
+        if (min_node == target) {
+            break;
+        }
+        
+        INSTR_PHASE_BEGIN(relax_start);
+        for (int i = graph->offsets[min_node]; i < graph->offsets[min_node + 1]; i++) {
+            int neighbor = graph->dest[i];
+            int weight = graph->weight[i];
+            
+            if (!visited[neighbor] && distances[min_node] != INF) {
+                int new_dist = distances[min_node] + weight;
+                if (new_dist < distances[neighbor]) {
+                    distances[neighbor] = new_dist;
+                    INSTR_COUNT(INSTR_DECREASES, 1);
+                }
+            }
+        }
+        INSTR_PHASE_END(INSTR_RELAX, relax_start);
+    }
+}
+
+static void heap_search(SsspWorkspace *ws, int source, int target, int limit, int *distances) {
+    const Graph *graph = ws->graph;
+    bool *visited = ws->visited;
+    IndexedHeap *queue = ws->heap;
+    
+    for (int i = 0; i < graph->num_nodes; i++) {
+        distances[i] = INF;
+    }
+    distances[source] = 0;
+    heap_push_or_decrease(queue, source, 0);
+    
+    while (!heap_empty(queue)) {
+        int node = heap_pop(queue);
+        int base_dist = distances[node];
+        if (base_dist > limit) {
+            break;
+        }
+        settle(ws, node);
+        if (node == target) {
+            break;
+        }
+        
+        for (int i = graph->offsets[node]; i < graph->offsets[node + 1]; i++) {
+            int neighbor = graph->dest[i];
+            if (visited[neighbor]) {
+                continue;
+            }
+            int new_dist = base_dist + graph->weight[i];
+            if (new_dist < distances[neighbor]) {
+                distances[neighbor] = new_dist;
+                heap_push_or_decrease(queue, neighbor, new_dist);
+                INSTR_COUNT(INSTR_DECREASES, 1);
+            }
+        }
+    }
+    heap_clear(queue);
+}
+
+// Dial's bucket queue; every extract-min is amortized O(1) when max_weight is small
+static void dial_search(SsspWorkspace *ws, int source, int target, int limit, int *distances) {
+    const Graph *graph = ws->graph;
+    bool *visited = ws->visited;
+    DialQueue *queue = ws->dial;
+    
+    for (int i = 0; i < graph->num_nodes; i++) {
+        distances[i] = INF;
+    }
+    distances[source] = 0;
+    dial_push_or_decrease(queue, source, 0);
+    
+    while (!dial_empty(queue)) {
+        int node = dial_pop(queue);
+        int base_dist = distances[node];
+        if (base_dist > limit) {
+            break;
+        }
+        settle(ws, node);
+        if (node == target) {
+            break;
+        }
+        
+        for (int i = graph->offsets[node]; i < graph->offsets[node + 1]; i++) {
+            int neighbor = graph->dest[i];
+            if (visited[neighbor]) {
+                continue;
+            }
+            int new_dist = base_dist + graph->weight[i];
+            if (new_dist < distances[neighbor]) {
+                distances[neighbor] = new_dist;
+                dial_push_or_decrease(queue, neighbor, new_dist);
+                INSTR_COUNT(INSTR_DECREASES, 1);
+            }
+        }
+    }
+    dial_clear(queue);
+}
+
+// Radix heap with lazy deletion; false if a bucket could not grow
+static bool radix_search(SsspWorkspace *ws, int source, int target, int limit, int *distances) {
+    const Graph *graph = ws->graph;
+    bool *visited = ws->visited;
+    RadixHeap *queue = ws->radix;
+    
+    for (int i = 0; i < graph->num_nodes; i++) {
+        distances[i] = INF;
+    }
+    distances[source] = 0;
+    bool ok = radix_push(queue, source, 0);
+    
+    int node;
+    unsigned key;
+    while (ok && radix_pop(queue, &node, &key)) {
+        if (visited[node] || key != (unsigned)distances[node]) {
+            continue;    // stale entry superseded by a later decrease
+        }
+        int base_dist = distances[node];
+        if (base_dist > limit) {
+            break;
+        }
+        settle(ws, node);
+        if (node == target) {
+            break;
+        }
+        
+        for (int i = graph->offsets[node]; i < graph->offsets[node + 1]; i++) {
+            int neighbor = graph->dest[i];
+            if (visited[neighbor]) {
+                continue;
+            }
+            int new_dist = base_dist + graph->weight[i];
+            if (new_dist < distances[neighbor]) {
+                distances[neighbor] = new_dist;
+                if (!radix_push(queue, neighbor, (unsigned)new_dist)) {
+                    ok = false;
+                    break;
+                }
+                INSTR_COUNT(INSTR_DECREASES, 1);
+            }
+        }
+    }
+    ok = ok && !queue->failed;
+    radix_reset(queue);
+    return ok;
+}
+
+bool sequential_engine_supported(SequentialEngine engine, const Graph *graph) {
+    // Dial needs max_weight + 1 bucket heads; past the auto threshold that
+    // quickly becomes gigabytes, so only the radix heap takes such graphs
+    return resolve_sequential_engine(engine, graph) != ENGINE_DIAL || graph->max_weight <= DIAL_MAX_WEIGHT;
+}
+
+bool check_sequential_engine(SequentialEngine engine, const Graph *graph) {
+    if (!sequential_engine_supported(engine, graph)) {
+        fprintf(stderr, "Error: The dial engine needs edge weights <= %d (graph has %d); use radix or auto\n",
+                DIAL_MAX_WEIGHT, graph->max_weight);
+        return false;
+    }
+    return true;
+}
+
+SsspWorkspace* sssp_workspace_create(const Graph *graph, SequentialEngine engine) {
+    if (!check_sequential_engine(engine, graph)) {
+        return NULL;
+    }
+    SsspWorkspace *ws = (SsspWorkspace*)calloc(1, sizeof(SsspWorkspace));
+    if (!ws) {
+        perror("Error allocating query workspace");
+        return NULL;
+    }
+    ws->graph = graph;
+    ws->engine = resolve_sequential_engine(engine, graph);
+    ws->visited = (bool*)calloc(graph->num_nodes, sizeof(bool));
+    ws->settled = (int*)malloc((size_t)graph->num_nodes * sizeof(int));
+    bool ok = ws->visited && ws->settled;
+    switch (ws->engine) {
+        case ENGINE_HEAP:
+            ok = ok && (ws->heap = heap_create(graph->num_nodes)) != NULL;
+            break;
+        case ENGINE_DIAL:
+            ok = ok && (ws->dial = dial_create(graph->num_nodes, graph->max_weight)) != NULL;
+            break;
+        case ENGINE_RADIX:
+            ok = ok && (ws->radix = radix_create()) != NULL;
+            break;
+        default:
+            break;
+    }
+    if (!ok) {
+        perror("Error allocating query workspace");
+        sssp_workspace_free(ws);
+        return NULL;
+    }
+    return ws;
+}
+
+int sssp_workspace_search(SsspWorkspace *ws, int source, int target, int limit, int *distances) {
+    // Reset only what the previous search touched
+    for (int i = 0; i < ws->num_settled; i++) {
+        ws->visited[ws->settled[i]] = false;
+    }
+    ws->num_settled = 0;
+    
+    switch (ws->engine) {
+        case ENGINE_HEAP:
+            heap_search(ws, source, target, limit, distances);
+            break;
+        case ENGINE_DIAL:
+            dial_search(ws, source, target, limit, distances);
+            break;
+        case ENGINE_RADIX:
+            if (!radix_search(ws, source, target, limit, distances)) {
+                return -1;
+            }
+            break;
+        case ENGINE_SCAN:
+        default:
+            scan_search(ws, source, target, limit, distances);
+            break;
+    }
+    return 0;
+}
+
+int sssp_workspace_run(SsspWorkspace *ws, int source, int *distances) {
+    return sssp_workspace_search(ws, source, -1, INF, distances);
+}
+
+const int* sssp_workspace_settled(const SsspWorkspace *ws, int *count) {
+    *count = ws->num_settled;
+    return ws->settled;
+}
+
+void sssp_workspace_free(SsspWorkspace *ws) {
+    if (!ws) {
+        return;
+    }
+    free(ws->visited);
+    free(ws->settled);
+    heap_free(ws->heap);
+    dial_free(ws->dial);
+    radix_free(ws->radix);
+    free(ws);
+}
+
+// One-shot entry points: a workspace for a single full search
+static int run_once(SequentialEngine engine, const Graph *graph, int source, int *distances) {
+    SsspWorkspace *ws = sssp_workspace_create(graph, engine);
+    if (!ws) {
+        return -1;
+    }
+    int status = sssp_workspace_run(ws, source, distances);
+    sssp_workspace_free(ws);
+    return status;
+}
+
+// Sequential Dijkstra's algorithm with a linear scan for the next node
+int dijkstra_sequential(const Graph *graph, int source, int *distances) {
+    return run_once(ENGINE_SCAN, graph, source, distances);
+}
+
+// Sequential Dijkstra's algorithm using an indexed 4-ary heap
+int dijkstra_heap(const Graph *graph, int source, int *distances) {
+    return run_once(ENGINE_HEAP, graph, source, distances);
+}
+
+// Sequential Dijkstra's algorithm using Dial's bucket queue
+int dijkstra_dial(const Graph *graph, int source, int *distances) {
+    return run_once(ENGINE_DIAL, graph, source, distances);
+}
+
+// Sequential Dijkstra's algorithm using a radix heap with lazy deletion
+int dijkstra_radix(const Graph *graph, int source, int *distances) {
+    return run_once(ENGINE_RADIX, graph, source, distances);
+}
+
+bool parse_sequential_engine(const char *name, SequentialEngine *engine) {
+    if (strcmp(name, "auto") == 0) {
+        *engine = ENGINE_AUTO;
+    } else if (strcmp(name, "scan") == 0) {
+        *engine = ENGINE_SCAN;
+    } else if (strcmp(name, "heap") == 0) {
+        *engine = ENGINE_HEAP;
+    } else if (strcmp(name, "dial") == 0) {
+        *engine = ENGINE_DIAL;
+    } else if (strcmp(name, "radix") == 0) {
+        *engine = ENGINE_RADIX;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+SequentialEngine resolve_sequential_engine(SequentialEngine engine, const Graph *graph) {
+    if (engine != ENGINE_AUTO) {
+        return engine;
+    }
+    return (graph->max_weight <= DIAL_MAX_WEIGHT) ? ENGINE_DIAL : ENGINE_RADIX;
+}
+
+const char* sequential_engine_name(SequentialEngine engine) {
+    switch (engine) {
+        case ENGINE_AUTO:
+            return "auto";
+        case ENGINE_HEAP:
+            return "heap";
+        case ENGINE_DIAL:
+            return "dial";
+        case ENGINE_RADIX:
+            return "radix";
+        case ENGINE_SCAN:
+        default:
+            return "scan";
+    }
+}
+
+int run_sequential_engine(SequentialEngine engine, const Graph *graph, int source, int *distances) {
+    switch (resolve_sequential_engine(engine, graph)) {
+        case ENGINE_HEAP:
+            return dijkstra_heap(graph, source, distances);
+        case ENGINE_DIAL:
+            return dijkstra_dial(graph, source, distances);
+        case ENGINE_RADIX:
+            return dijkstra_radix(graph, source, distances);
+        case ENGINE_SCAN:
+        default:
+            return dijkstra_sequential(graph, source, distances);
+    }
+}